@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <chrono>
+#include <cstdlib>
+#include <egt/ui>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+/*
+ * Report the average time to dispatch an event to the handlers of a widget,
+ * to invoke a signal, and from an input device to the handler of a widget.
+ *
+ * The widget has handlers for many events other than the one dispatched, like
+ * a widget handling clicks and keys receiving a storm of pointer moves, and a
+ * few handlers for all events.
+ *
+ * Pointer moves from the input device go down 5 levels of frames, each with 50
+ * buttons, to a button at the bottom.
+ *
+ * Run with EGT_BACKEND=memory to benchmark without a display.
+ */
+using Clock = std::chrono::steady_clock;
+
+static double elapsed(const Clock::time_point& start)
+{
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+class BenchInput : public egt::Input
+{
+public:
+    void inject(egt::Event& event)
+    {
+        dispatch(event);
+    }
+};
+
+static egt::Frame* build(egt::Frame& parent, size_t levels,
+                         std::vector<std::shared_ptr<egt::Widget>>& widgets)
+{
+    // a grid of buttons over the top left of the frame
+    for (auto i = 0; i < 50; i++)
+    {
+        auto button = std::make_shared<egt::Button>("",
+                      egt::Rect(i % 10 * 5, i / 10 * 5, 5, 5));
+        parent.add(button);
+        widgets.push_back(button);
+    }
+
+    if (!levels)
+        return &parent;
+
+    auto frame = std::make_shared<egt::Frame>(egt::Rect(50, 50, 300, 300));
+    parent.add(frame);
+    widgets.push_back(frame);
+    return build(*frame, levels - 1, widgets);
+}
+
+int main(int argc, char** argv)
+{
+    egt::Application app(argc, argv);
+
+    auto count = 1000000;
+    if (argc > 1)
+        count = std::max(1, std::atoi(argv[1]));
+
+    egt::Button button("Button");
+
+    size_t calls = 0;
+    const egt::EventId others[] =
+    {
+        egt::EventId::pointer_click,
+        egt::EventId::pointer_dblclick,
+        egt::EventId::pointer_hold,
+        egt::EventId::keyboard_down,
+        egt::EventId::keyboard_up,
+    };
+    for (auto i = 0; i < 20; i++)
+    {
+        button.on_event([&calls](egt::Event&)
+        {
+            calls++;
+        }, {others[i % 5]});
+    }
+
+    for (auto i = 0; i < 2; i++)
+    {
+        button.on_event([&calls](egt::Event&)
+        {
+            calls++;
+        });
+    }
+
+    egt::Event event(egt::EventId::raw_pointer_move);
+    auto start = Clock::now();
+    for (auto i = 0; i < count; i++)
+        button.invoke_handlers(event);
+    const auto event_time = elapsed(start) / count;
+
+    egt::Signal<int> signal;
+    int sum = 0;
+    for (auto i = 0; i < 4; i++)
+    {
+        signal.on_event([&sum](int value)
+        {
+            sum += value;
+        });
+    }
+
+    start = Clock::now();
+    for (auto i = 0; i < count; i++)
+        signal.invoke(i);
+    const auto signal_time = elapsed(start) / count;
+
+    egt::TopWindow window;
+    window.show();
+    std::vector<std::shared_ptr<egt::Widget>> widgets;
+    auto bottom = build(window, 4, widgets);
+    auto target = std::make_shared<egt::Button>("", egt::Rect(50, 50, 100, 100));
+    bottom->add(target);
+
+    Clock::time_point handled;
+    target->on_event([&handled](egt::Event&)
+    {
+        handled = Clock::now();
+    }, {egt::EventId::raw_pointer_move});
+
+    // the target has its top left corner at 250, 250 on the display
+    BenchInput input;
+    double latency = 0;
+    for (auto i = 0; i < count; i++)
+    {
+        const egt::DisplayPoint point(260 + i % 50, 260 + i % 30);
+        egt::Event move(egt::EventId::raw_pointer_move, egt::Pointer(point));
+        start = Clock::now();
+        input.inject(move);
+        latency += std::chrono::duration<double, std::nano>(handled - start).count();
+    }
+    const auto input_time = latency / count;
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "event " << event_time << " ns"
+              << "  signal " << signal_time << " ns"
+              << "  input " << input_time << " ns"
+              << "  calls " << calls
+              << std::endl;
+
+    return 0;
+}
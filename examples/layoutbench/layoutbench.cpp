@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <chrono>
+#include <cstdlib>
+#include <egt/ui>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Build a deep nest of sizers and report the time to build it, the average
+ * time to lay it out again, and the average time to walk through it.
+ *
+ * The nest has 5 levels of sizers, alternately horizontal and vertical, with
+ * 300 labels as leaves.
+ *
+ * Run with EGT_BACKEND=memory to benchmark without a display.
+ */
+using Clock = std::chrono::steady_clock;
+
+static double elapsed(const Clock::time_point& start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+static void build(egt::Frame& parent, const std::vector<int>& fanout, size_t level,
+                  std::vector<std::shared_ptr<egt::Widget>>& widgets)
+{
+    for (auto i = 0; i < fanout[level]; i++)
+    {
+        if (level + 1 == fanout.size())
+        {
+            auto label = std::make_shared<egt::Label>("Label " + std::to_string(widgets.size()));
+            parent.add(label);
+            widgets.push_back(label);
+        }
+        else
+        {
+            auto sizer = std::make_shared<egt::BoxSizer>(level % 2 ?
+                         egt::Orientation::vertical :
+                         egt::Orientation::horizontal);
+            parent.add(sizer);
+            widgets.push_back(sizer);
+            build(*sizer, fanout, level + 1, widgets);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    egt::Application app(argc, argv);
+
+    auto count = 100;
+    if (argc > 1)
+        count = std::max(1, std::atoi(argv[1]));
+
+    egt::TopWindow window;
+    window.show();
+
+    // 3 x 4 x 5 x 5 = 300 labels under 5 levels of sizers
+    const std::vector<int> fanout = {1, 3, 4, 5, 5};
+    std::vector<std::shared_ptr<egt::Widget>> widgets;
+
+    auto start = Clock::now();
+    egt::BoxSizer root(egt::Orientation::vertical);
+    window.add(root);
+    build(root, fanout, 1, widgets);
+    app.layout_now();
+    const auto build_time = elapsed(start);
+
+    start = Clock::now();
+    for (auto i = 0; i < count; i++)
+        root.layout();
+    const auto layout_time = elapsed(start) / count;
+
+    start = Clock::now();
+    for (auto i = 0; i < count; i++)
+    {
+        root.walk([](egt::Widget*, int)
+        {
+            return true;
+        });
+    }
+    const auto walk_time = elapsed(start) / count;
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "widgets " << widgets.size()
+              << "  build " << build_time << " us"
+              << "  layout " << layout_time << " us"
+              << "  walk " << walk_time << " us"
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <egt/ui>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+/*
+ * Report the size of common widgets, and the heap they use once created and
+ * added to a frame.
+ *
+ * The heap is counted by replacing the global operator new and delete, so
+ * allocations made inside the library are counted too.
+ *
+ * Run with EGT_BACKEND=memory to benchmark without a display.
+ */
+static std::atomic<size_t> heap_bytes{0};
+static std::atomic<size_t> heap_blocks{0};
+
+// keep the size of each block in front of it, with the alignment of new
+static constexpr size_t HEADER = alignof(std::max_align_t);
+
+void* operator new(size_t size)
+{
+    auto p = static_cast<unsigned char*>(std::malloc(size + HEADER));
+    if (!p)
+        throw std::bad_alloc();
+    *reinterpret_cast<size_t*>(p) = size;
+    heap_bytes += size;
+    heap_blocks++;
+    return p + HEADER;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (!ptr)
+        return;
+    auto p = static_cast<unsigned char*>(ptr) - HEADER;
+    heap_bytes -= *reinterpret_cast<size_t*>(p);
+    heap_blocks--;
+    std::free(p);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+template<class T, class... Args>
+static void report(egt::Frame& parent, const char* name, size_t count, Args&& ... args)
+{
+    std::vector<std::shared_ptr<T>> widgets;
+    widgets.reserve(count);
+
+    const auto bytes = heap_bytes.load();
+    const auto blocks = heap_blocks.load();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        auto widget = std::make_shared<T>(std::forward<Args>(args)...);
+        parent.add(widget);
+        widgets.push_back(widget);
+    }
+
+    const auto used = static_cast<double>(heap_bytes.load() - bytes) / count;
+    const auto allocations = static_cast<double>(heap_blocks.load() - blocks) / count;
+
+    std::cout << std::left << std::setw(12) << name << std::right
+              << "  sizeof " << std::setw(5) << sizeof(T)
+              << "  heap " << std::setw(7) << used
+              << "  blocks " << std::setw(5) << allocations
+              << std::endl;
+
+    parent.remove_all();
+}
+
+int main(int argc, char** argv)
+{
+    egt::Application app(argc, argv);
+
+    size_t count = 1000;
+    if (argc > 1)
+        count = std::max(1, std::atoi(argv[1]));
+
+    egt::TopWindow window;
+    egt::Frame frame;
+    window.add(frame);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "per widget, " << count << " widgets of each type" << std::endl;
+
+    report<egt::Frame>(frame, "Frame", count);
+    report<egt::BoxSizer>(frame, "BoxSizer", count);
+    report<egt::Label>(frame, "Label", count, "Label");
+    report<egt::Button>(frame, "Button", count, "Button");
+    report<egt::CheckBox>(frame, "CheckBox", count, "CheckBox");
+    report<egt::Slider>(frame, "Slider", count);
+    report<egt::TextBox>(frame, "TextBox", count, "TextBox");
+
+    return 0;
+}
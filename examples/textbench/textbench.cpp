@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <chrono>
+#include <cstdlib>
+#include <egt/ui>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/*
+ * Draw widgets into an offscreen surface with each text renderer and report
+ * the average time per draw.
+ *
+ * Label and Button paint a mask of their text rendered by the first draw, so
+ * they show the cost of painting that mask. TextBox draws its glyphs every
+ * time.
+ *
+ * Run with EGT_BACKEND=memory to benchmark without a display.
+ */
+static double bench(egt::Widget& widget, egt::detail::TextRenderer renderer, int count)
+{
+    egt::detail::text_renderer(renderer);
+
+    egt::Surface surface(widget.size(), egt::PixelFormat::argb8888);
+    egt::Painter painter(surface);
+    const egt::Rect rect(egt::Point(), widget.size());
+
+    // warm up the glyph run cache and the atlas
+    widget.draw(painter, rect);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < count; i++)
+        widget.draw(painter, rect);
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::micro>(end - start).count() / count;
+}
+
+static void report(const std::string& name, egt::Widget& widget, int count)
+{
+    const auto cairo = bench(widget, egt::detail::TextRenderer::cairo, count);
+    const auto atlas = bench(widget, egt::detail::TextRenderer::glyph_atlas, count);
+
+    std::cout << std::left << std::setw(8) << name
+              << std::right << std::fixed << std::setprecision(1)
+              << " cairo " << std::setw(8) << cairo << " us"
+              << "  atlas " << std::setw(8) << atlas << " us"
+              << "  speedup " << std::setprecision(2) << cairo / atlas << "x"
+              << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    egt::Application app(argc, argv);
+
+    auto count = 1000;
+    if (argc > 1)
+        count = std::max(1, std::atoi(argv[1]));
+
+    egt::Label label("Temperature: 21.5 C", egt::Rect(0, 0, 200, 40));
+    egt::Button button("Start", egt::Rect(0, 0, 120, 50));
+    egt::Label heading("Settings", egt::Rect(0, 0, 300, 60));
+    heading.font(egt::Font(36, egt::Font::Weight::bold));
+    egt::TextBox textbox("Temperature: 21.5 C", egt::Rect(0, 0, 200, 40));
+
+    report("Label", label, count);
+    report("Button", button, count);
+    report("Heading", heading, count);
+    report("TextBox", textbox, count);
+
+    return 0;
+}
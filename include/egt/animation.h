@@ -34,6 +34,8 @@ using EasingScalar = float;
  * Animation related classes.
  */
 
+class Widget;
+
 /// Animation callback type.
 using AnimationCallback = std::function<void (EasingScalar value)>;
 
@@ -43,6 +45,30 @@ using EasingFunc = std::function<EasingScalar(EasingScalar percent)>;
 namespace detail
 {
 
+class AnimationClock;
+
+/**
+ * Forget a widget as the target of any AutoAnimation.
+ *
+ * This is called when the widget is destroyed.
+ */
+EGT_API void forget_animation_target(const Widget* widget);
+
+/**
+ * Tell the animation clock a widget is damaged.
+ *
+ * An AutoAnimation with no target that damages a widget while it steps gets
+ * that widget as its target.
+ */
+EGT_API void animation_damaged(const Widget* widget);
+
+/**
+ * Release the timer of the animation clock.
+ *
+ * This is called when the Application is destroyed.
+ */
+EGT_API void animation_clock_cleanup();
+
 /**
  * Interpolate function used internally.
  *
@@ -493,11 +519,12 @@ protected:
 };
 
 /**
- * Animation object with built in timer.
+ * Animation object run by the animation clock.
  *
  * An Animation usually involves setting up a timer to run the animation
- * at a periodic interval. This wraps an animation around a built in
- * timer to run the animation.
+ * at a periodic interval. Instead, all the running instances of this class
+ * are run together by a single clock, just before the event loop draws a
+ * frame, with the same time, so all their changes are drawn in the same frame.
  *
  * @ingroup animation
  */
@@ -527,25 +554,63 @@ public:
                            const EasingFunc& func = easing_linear,
                            const AnimationCallback& callback = nullptr);
 
+    AutoAnimation(const AutoAnimation&) = delete;
+    AutoAnimation& operator=(const AutoAnimation&) = delete;
+    AutoAnimation(AutoAnimation&&) = delete;
+    AutoAnimation& operator=(AutoAnimation&&) = delete;
+
     void start() override;
     void stop() override;
     void resume() override;
 
     /**
-     * Change the interval of the internal timer.
+     * Change the interval between two steps of the animation.
      *
-     * The internal timer defaults to an interval of 30ms.  See
-     * @ref Timer::change_duration() for more information on the ramifications
-     * of making this change on a running timer.
+     * The default is 30ms.
      */
-    void interval(std::chrono::milliseconds duration);
-
-protected:
+    void interval(std::chrono::milliseconds duration) { m_interval = duration; }
 
     /**
-     * Periodic timer used to run the animation.
+     * Set the widget the animation is for.
+     *
+     * The animation pauses while the widget, or any of its parents, is
+     * hidden, and continues from where it was when the widget is shown again.
+     *
+     * Until a target is set, the first widget the animation damages when it
+     * steps becomes its target. Setting nullptr prevents that.
+     *
+     * @param[in] widget The widget, or nullptr for none.
      */
-    PeriodicTimer m_timer;
+    void target(const Widget* widget);
+
+    /// Get the widget the animation is for, or nullptr.
+    EGT_NODISCARD const Widget* target() const { return m_target; }
+
+    ~AutoAnimation() noexcept override;
+
+protected:
+
+    /// Interval between two steps.
+    std::chrono::milliseconds m_interval{30};
+
+    /// Time of the last step.
+    std::chrono::time_point<std::chrono::steady_clock> m_last_step;
+
+    /// Widget the animation is for.
+    const Widget* m_target{nullptr};
+
+    /// Is the target the first widget the animation damages?
+    bool m_auto_target{true};
+
+    /// Is the animation paused because its target is hidden?
+    bool m_paused{false};
+
+private:
+
+    /// Step the animation for a frame of the animation clock.
+    void frame(const std::chrono::time_point<std::chrono::steady_clock>& now);
+
+    friend class detail::AnimationClock;
 };
 
 /**
@@ -147,6 +147,16 @@ public:
      */
     void paint_to_file(const std::string& filename = {});
 
+    /**
+     * Perform the requested layouts right away.
+     *
+     * Adding, removing, moving, or resizing widgets only requests a layout,
+     * which the event loop performs once just before drawing. Call this to get
+     * the final geometry of widgets before that, for example right after
+     * building a page.
+     */
+    void layout_now();
+
     /**
      * Dump the widget hierarchy and properties to the specified std::ostream.
      *
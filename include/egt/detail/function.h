@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef EGT_DETAIL_FUNCTION_H
+#define EGT_DETAIL_FUNCTION_H
+
+/**
+ * @file
+ * @brief Function wrapper with inline storage.
+ */
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+template<class Signature, size_t Capacity = 32>
+class InplaceFunction;
+
+/**
+ * Function wrapper like std::function, that stores small callables inside
+ * itself.
+ *
+ * Callables up to Capacity bytes, like lambdas capturing a few pointers or a
+ * std::function, are stored without allocating. Larger ones are stored on the
+ * heap, like std::function does.
+ */
+template<class R, class... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity>
+{
+public:
+
+    InplaceFunction() noexcept = default;
+
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    InplaceFunction(std::nullptr_t) noexcept
+    {}
+
+    /**
+     * @param[in] f Callable object, function pointer, or std::function.
+     */
+    template<class F, class T = typename std::decay<F>::type,
+             class = typename std::enable_if<!std::is_same<T, InplaceFunction>::value &&
+                                             std::is_invocable_r<R, T&, Args...>::value>::type>
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    InplaceFunction(F&& f)
+    {
+        if (empty(f))
+            return;
+
+        m_operations = &Operations::template get<T>();
+        if constexpr (Operations::template local<T>())
+            new (&m_storage) T(std::forward<F>(f));
+        else
+            *reinterpret_cast<T**>(&m_storage) = new T(std::forward<F>(f));
+    }
+
+    InplaceFunction(const InplaceFunction& rhs)
+        : m_operations(rhs.m_operations)
+    {
+        if (m_operations)
+            m_operations->copy(&m_storage, &rhs.m_storage);
+    }
+
+    InplaceFunction(InplaceFunction&& rhs) noexcept
+        : m_operations(rhs.m_operations)
+    {
+        if (m_operations)
+        {
+            m_operations->move(&m_storage, &rhs.m_storage);
+            rhs.m_operations = nullptr;
+        }
+    }
+
+    InplaceFunction& operator=(const InplaceFunction& rhs)
+    {
+        if (this != &rhs)
+        {
+            InplaceFunction copy(rhs);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(InplaceFunction&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            reset();
+            m_operations = rhs.m_operations;
+            if (m_operations)
+            {
+                m_operations->move(&m_storage, &rhs.m_storage);
+                rhs.m_operations = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(std::nullptr_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    ~InplaceFunction() noexcept
+    {
+        reset();
+    }
+
+    /// Check if there is a callable.
+    explicit operator bool() const noexcept
+    {
+        return m_operations != nullptr;
+    }
+
+    /**
+     * Call the callable.
+     *
+     * @throws std::bad_function_call if there is no callable.
+     */
+    R operator()(Args... args) const
+    {
+        if (!m_operations)
+            throw std::bad_function_call();
+
+        return m_operations->invoke(&m_storage, std::forward<Args>(args)...);
+    }
+
+private:
+
+    using Storage = typename std::aligned_storage<Capacity, alignof(std::max_align_t)>::type;
+
+    /**
+     * Type erased operations on the stored callable.
+     *
+     * There is one instance for each type of callable.
+     */
+    struct Operations
+    {
+        R(*invoke)(void* storage, Args&& ... args);
+        void (*copy)(void* storage, const void* from);
+        void (*move)(void* storage, void* from) noexcept;
+        void (*destroy)(void* storage) noexcept;
+
+        /// Check if a callable of type T is stored inline.
+        template<class T>
+        static constexpr bool local()
+        {
+            return sizeof(T) <= sizeof(Storage) &&
+                   alignof(Storage) % alignof(T) == 0 &&
+                   std::is_nothrow_move_constructible<T>::value;
+        }
+
+        template<class T>
+        static T& target(void* storage)
+        {
+            if constexpr (local<T>())
+                return *static_cast<T*>(storage);
+            return **static_cast<T**>(storage);
+        }
+
+        template<class T>
+        static const Operations& get()
+        {
+            static const Operations operations =
+            {
+                [](void* storage, Args && ... args) -> R
+                {
+                    // like std::function, discard the result of the callable
+                    if constexpr (std::is_void<R>::value)
+                        target<T>(storage)(std::forward<Args>(args)...);
+                    else
+                        return target<T>(storage)(std::forward<Args>(args)...);
+                },
+                [](void* storage, const void* from)
+                {
+                    auto& source = target<T>(const_cast<void*>(from));
+                    if constexpr (local<T>())
+                        new (storage) T(source);
+                    else
+                        *static_cast<T**>(storage) = new T(source);
+                },
+                [](void* storage, void* from) noexcept
+                {
+                    if constexpr (local<T>())
+                    {
+                        new (storage) T(std::move(*static_cast<T*>(from)));
+                        static_cast<T*>(from)->~T();
+                    }
+                    else
+                    {
+                        *static_cast<T**>(storage) = *static_cast<T**>(from);
+                    }
+                },
+                [](void* storage) noexcept
+                {
+                    if constexpr (local<T>())
+                        static_cast<T*>(storage)->~T();
+                    else
+                        delete *static_cast<T**>(storage);
+                }
+            };
+            return operations;
+        }
+    };
+
+    template<class T>
+    static bool empty(const T&) noexcept { return false; }
+
+    template<class T>
+    static bool empty(T* f) noexcept { return !f; }
+
+    template<class T, class C>
+    static bool empty(T C::* f) noexcept { return !f; }
+
+    template<class Signature>
+    static bool empty(const std::function<Signature>& f) noexcept { return !f; }
+
+    void reset() noexcept
+    {
+        if (m_operations)
+        {
+            m_operations->destroy(&m_storage);
+            m_operations = nullptr;
+        }
+    }
+
+    /// The callable, or a pointer to it when it does not fit.
+    mutable Storage m_storage;
+
+    /// Operations on the callable, nullptr when there is none.
+    const Operations* m_operations{nullptr};
+};
+
+}
+}
+}
+
+#endif
@@ -11,8 +11,11 @@
  * @brief Working with loading images.
  */
 
+#include <cstdint>
 #include <egt/detail/meta.h>
+#include <egt/geometry.h>
 #include <egt/surface.h>
+#include <memory>
 #include <string>
 
 namespace egt
@@ -67,6 +70,103 @@ EGT_API std::string get_mime_type(const std::string& path);
  */
 EGT_API std::string get_mime_type(const void* buffer, size_t length);
 
+class ErawTiledImage;
+
+/**
+ * Image decoded region by region.
+ *
+ * Images in the tiled eraw format are decoded one tile at a time, when a
+ * region crossing the tile is first requested, like the visible part of a
+ * large floor plan while it is panned. Other images are fully decoded when
+ * loaded.
+ *
+ * @code{.cpp}
+ * detail::TiledImage map("file:floorplan.eraw");
+ * ImageLabel label(Image(map.surface()));
+ * ...
+ * // when the part of the map shown changes
+ * if (map.decode(shown))
+ *     label.damage();
+ * @endcode
+ */
+class EGT_API TiledImage
+{
+public:
+
+    /// Compression of the tiles.
+    enum class Compression : uint8_t
+    {
+        none,
+        zlib,
+        lz4,
+    };
+
+    /**
+     * @param[in] uri Resource path of the image.
+     *
+     * @throws std::runtime_error if the image cannot be loaded.
+     */
+    explicit TiledImage(const std::string& uri);
+
+    TiledImage(const TiledImage&) = delete;
+    TiledImage& operator=(const TiledImage&) = delete;
+    TiledImage(TiledImage&&) noexcept;
+    TiledImage& operator=(TiledImage&&) noexcept;
+
+    /// Size of the image.
+    EGT_NODISCARD Size size() const;
+
+    /// Check if the image is decoded on demand.
+    EGT_NODISCARD bool partial() const { return m_eraw != nullptr; }
+
+    /**
+     * Decode the tiles of the image intersecting a region.
+     *
+     * Tiles decoded by a previous call are not decoded again.
+     *
+     * @param[in] region Region of the image.
+     * @return The number of newly decoded tiles.
+     */
+    size_t decode(const Rect& region);
+
+    /**
+     * Surface of the image.
+     *
+     * It has the size of the whole image, with its parts not decoded yet
+     * transparent.
+     */
+    EGT_NODISCARD const std::shared_ptr<Surface>& surface() const { return m_surface; }
+
+    /**
+     * Save a surface in the tiled eraw format.
+     *
+     * @param[in] path Output file.
+     * @param[in] surface Surface in the PixelFormat::argb8888 format.
+     * @param[in] format Pixel format to store, PixelFormat::argb8888 or
+     *            PixelFormat::rgb565.
+     * @param[in] compression Compression of the tiles. Tiles are stored
+     *            uncompressed when the compression is not supported by the
+     *            build or does not make them smaller.
+     * @param[in] tile_size Size of the square tiles.
+     *
+     * @throws std::runtime_error if the surface cannot be saved.
+     */
+    static void save(const std::string& path, const Surface& surface,
+                     PixelFormat format = PixelFormat::argb8888,
+                     Compression compression = Compression::none,
+                     uint32_t tile_size = 64);
+
+    ~TiledImage() noexcept;
+
+private:
+
+    /// The tiled image, when it is decoded on demand.
+    std::unique_ptr<ErawTiledImage> m_eraw;
+
+    /// Surface decoded into.
+    std::shared_ptr<Surface> m_surface;
+};
+
 }
 }
 }
@@ -9,9 +9,11 @@
 #include <egt/detail/meta.h>
 #include <egt/painter.h>
 #include <egt/surface.h>
+#include <list>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 
 namespace egt
 {
@@ -20,6 +22,8 @@ inline namespace v1
 namespace detail
 {
 
+class MipChain;
+
 /**
  * Internal image cache.
  *
@@ -29,6 +33,12 @@ namespace detail
  *
  * This is a trade off in consuming more memory instead of possibly
  * constantly reloading or scaling the same image.
+ *
+ * Approximate scaled requests of raster images do not decode the image again.
+ * The decoded image is kept, within a memory budget, with a chain of halved
+ * copies built on demand, and the scaled image is resampled from the nearest
+ * larger copy. The image is only decoded at the largest size requested so
+ * far, directly at a reduced size for JPEG images.
  */
 class EGT_API ImageCache
 {
@@ -47,8 +57,29 @@ public:
      */
     void clear();
 
+    /**
+     * Set the memory budget, in bytes, of the decoded source images kept to
+     * build scaled images.
+     *
+     * A budget of zero disables keeping source images, and every scaled
+     * request decodes the image again.
+     */
+    void source_budget(size_t bytes);
+
+    /**
+     * Get the memory budget of the decoded source images.
+     */
+    EGT_NODISCARD size_t source_budget() const { return m_source_budget; }
+
 protected:
 
+    std::shared_ptr<Surface> get_scaled(const std::string& uri,
+                                        float hscale, float vscale);
+
+    std::shared_ptr<MipChain> source(const std::string& uri, size_t level);
+
+    void trim_sources();
+
     static Surface resize(const Surface& surface, const Size& size);
 
     static float round(float v, float fraction);
@@ -56,6 +87,11 @@ protected:
     static std::string id(const std::string& name, float hscale, float vscale);
 
     std::map<std::string, std::shared_ptr<Surface>> m_cache;
+
+    /// Decoded source images, most recently used first.
+    std::list<std::pair<std::string, std::shared_ptr<MipChain>>> m_sources;
+
+    size_t m_source_budget{32 * 1024 * 1024};
 };
 
 /**
@@ -11,6 +11,11 @@
  * @brief Range class.
  */
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
 namespace egt
 {
 inline namespace v1
@@ -111,6 +116,172 @@ private:
     typename T::iterator m_end;
 };
 
+
+/**
+ * Range of the elements of a container before, or from, a split index.
+ *
+ * Iterators hold the range and an index instead of a container iterator, so
+ * adding or removing elements never leaves them dangling. The bounds of the
+ * range are read each time they are needed, and an iterator past the end of
+ * the range compares equal to end(), so a loop over the range stops at the
+ * current end even when elements are removed while it runs. An element
+ * inserted or removed before an iterator shifts what the iterator refers to.
+ */
+template<typename T>
+class IndexRange
+{
+    template<bool Const>
+    class Iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = typename T::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::conditional<Const,
+              typename T::const_pointer, typename T::pointer>::type;
+        using reference = typename std::conditional<Const,
+              typename T::const_reference, typename T::reference>::type;
+        using Range = typename std::conditional<Const,
+              const IndexRange, IndexRange>::type;
+
+        Iterator() noexcept = default;
+
+        Iterator(Range* range, size_t index) noexcept
+            : m_range(range),
+              m_index(index)
+        {}
+
+        /// A const iterator can be made from an iterator.
+        template<bool C = Const, typename = typename std::enable_if<C>::type>
+        // NOLINTNEXTLINE(google-explicit-constructor)
+        Iterator(const Iterator<false>& i) noexcept
+            : m_range(i.m_range),
+              m_index(i.m_index)
+        {}
+
+        reference operator*() const { return m_range->at(position()); }
+        pointer operator->() const { return &m_range->at(position()); }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        Iterator& operator++() noexcept { m_index = position() + 1; return *this; }
+        Iterator& operator--() noexcept { m_index = position() - 1; return *this; }
+        Iterator operator++(int) noexcept { auto i = *this; ++*this; return i; }
+        Iterator operator--(int) noexcept { auto i = *this; --*this; return i; }
+
+        Iterator& operator+=(difference_type n) noexcept
+        {
+            m_index = position() + n;
+            return *this;
+        }
+
+        Iterator& operator-=(difference_type n) noexcept { return *this += -n; }
+
+        friend Iterator operator+(Iterator i, difference_type n) noexcept { return i += n; }
+        friend Iterator operator+(difference_type n, Iterator i) noexcept { return i += n; }
+        friend Iterator operator-(Iterator i, difference_type n) noexcept { return i -= n; }
+
+        friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) noexcept
+        {
+            return static_cast<difference_type>(lhs.position()) -
+                   static_cast<difference_type>(rhs.position());
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept
+        {
+            return lhs.position() == rhs.position();
+        }
+
+        friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept { return !(lhs == rhs); }
+        friend bool operator<(const Iterator& lhs, const Iterator& rhs) noexcept { return lhs - rhs < 0; }
+        friend bool operator>(const Iterator& lhs, const Iterator& rhs) noexcept { return rhs < lhs; }
+        friend bool operator<=(const Iterator& lhs, const Iterator& rhs) noexcept { return !(rhs < lhs); }
+        friend bool operator>=(const Iterator& lhs, const Iterator& rhs) noexcept { return !(lhs < rhs); }
+
+    private:
+
+        /// Index in the container, no further than the current end.
+        size_t position() const noexcept
+        {
+            return std::min(m_index, m_range->last());
+        }
+
+        Range* m_range{nullptr};
+        size_t m_index{0};
+
+        friend class Iterator<!Const>;
+    };
+
+public:
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    /**
+     * @param[in] tail Whether the range starts at the split instead of ending
+     *            there.
+     */
+    explicit IndexRange(bool tail = false) noexcept
+        : m_tail(tail)
+    {}
+
+    /**
+     * Set the container and split index of the range.
+     *
+     * Both are referred to, not copied.
+     */
+    void bind(T& container, const size_t& split) noexcept
+    {
+        m_container = &container;
+        m_split = &split;
+    }
+
+    iterator begin() noexcept { return {this, first()}; }
+    const_iterator begin() const noexcept { return {this, first()}; }
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    iterator end() noexcept { return {this, last()}; }
+    const_iterator end() const noexcept { return {this, last()}; }
+    const_iterator cend() const noexcept { return end(); }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    size_t size() const noexcept
+    {
+        return last() - first();
+    }
+
+    bool empty() const noexcept
+    {
+        return !size();
+    }
+
+private:
+
+    size_t first() const noexcept
+    {
+        return m_tail ? *m_split : 0;
+    }
+
+    size_t last() const noexcept
+    {
+        return m_tail ? m_container->size() : *m_split;
+    }
+
+    typename T::reference at(size_t index) { return (*m_container)[index]; }
+    typename T::const_reference at(size_t index) const { return (*m_container)[index]; }
+
+    T* m_container{nullptr};
+    const size_t* m_split{nullptr};
+    bool m_tail{false};
+};
+
 }
 }
 }
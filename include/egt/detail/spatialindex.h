@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef EGT_DETAIL_SPATIALINDEX_H
+#define EGT_DETAIL_SPATIALINDEX_H
+
+/**
+ * @file
+ * @brief Spatial index of widgets.
+ */
+
+#include <cstdint>
+#include <egt/detail/meta.h>
+#include <egt/geometry.h>
+#include <unordered_map>
+#include <vector>
+
+namespace egt
+{
+inline namespace v1
+{
+class Widget;
+
+namespace detail
+{
+
+/**
+ * Uniform grid of the boxes of sibling widgets.
+ *
+ * The grid covers the boxes the widgets had when it was built, with about one
+ * cell per widget, and each cell lists the widgets whose box overlaps it.
+ * Finding the widgets under a point, or in a rectangle, then only takes
+ * looking at the widgets of a few cells instead of all of them.
+ *
+ * Widgets are kept in z-order, bottom first, so queries return them in the
+ * order they are drawn. Moving or resizing a widget only updates the cells of
+ * its old and new box. Adding, removing, or reordering widgets requires
+ * building the index again.
+ *
+ * @note This is used by Widget for the children of frames with at least
+ * threshold() subordinates.
+ */
+class EGT_API SpatialIndex
+{
+public:
+
+    /// Number of subordinates from which a widget indexes its children.
+    static constexpr size_t threshold()
+    {
+        return 64;
+    }
+
+    /**
+     * Build the index.
+     *
+     * @param[in] begin First widget, the bottom one.
+     * @param[in] end End of the widgets.
+     */
+    template<class Iterator>
+    void build(Iterator begin, Iterator end)
+    {
+        clear();
+        for (auto i = begin; i != end; ++i)
+            m_widgets.push_back(i->get());
+        build();
+    }
+
+    /// Drop the widgets, until the index is built again.
+    void clear();
+
+    /// Check if the index is built.
+    EGT_NODISCARD bool valid() const { return m_valid; }
+
+    /// Number of widgets in the index.
+    EGT_NODISCARD size_t size() const { return m_widgets.size(); }
+
+    /**
+     * Update the cells of a widget after its box changed.
+     *
+     * Widgets that are not in the index are ignored.
+     */
+    void update(const Widget& widget);
+
+    /**
+     * Find the top widget whose box contains a point.
+     *
+     * @param[in] point Point in the coordinates of the boxes.
+     * @param[in] accept Only widgets for which this returns true are returned.
+     * @return nullptr if no widget is found.
+     */
+    template<class Predicate>
+    Widget* top(const Point& point, Predicate&& accept) const
+    {
+        if (!m_valid || m_cells.empty())
+            return nullptr;
+
+        const auto& candidates = m_cells[cell(point)];
+
+        // a cell is not sorted, so keep the top most match
+        Widget* result = nullptr;
+        uint32_t position = 0;
+        for (auto i : candidates)
+        {
+            if (result && i < position)
+                continue;
+
+            if (m_boxes[i].intersect(point) && accept(m_widgets[i]))
+            {
+                result = m_widgets[i];
+                position = i;
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * Find the widgets whose box intersects a rectangle.
+     *
+     * @param[in] rect Rectangle in the coordinates of the boxes.
+     * @param[out] widgets The widgets, bottom first.
+     */
+    void query(const Rect& rect, std::vector<Widget*>& widgets) const;
+
+private:
+
+    void build();
+
+    EGT_NODISCARD size_t cell(const Point& point) const;
+
+    void cells(const Rect& rect, int& left, int& top, int& right, int& bottom) const;
+
+    void insert(uint32_t position);
+
+    void erase(uint32_t position);
+
+    /// Widgets, bottom first.
+    std::vector<Widget*> m_widgets;
+    /// Boxes of the widgets, as they are in the cells.
+    std::vector<Rect> m_boxes;
+    /// Position of each widget in m_widgets.
+    std::unordered_map<const Widget*, uint32_t> m_positions;
+    /// Positions of the widgets overlapping each cell, row by row.
+    std::vector<std::vector<uint32_t>> m_cells;
+    /// Scratch positions of query().
+    mutable std::vector<uint32_t> m_found;
+    /// Area covered by the cells.
+    Rect m_bounds;
+    int m_columns{0};
+    int m_rows{0};
+    DefaultDim m_cell_width{1};
+    DefaultDim m_cell_height{1};
+    /// Number of updates that moved a box out of m_bounds.
+    size_t m_outside{0};
+    bool m_valid{false};
+};
+
+}
+}
+}
+
+#endif
@@ -17,6 +17,7 @@
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace egt
@@ -74,6 +75,13 @@ std::string format(T value, int precision = 2)
  */
 EGT_API void tokenize(const std::string& str, char delimiter, std::vector<std::string>& tokens);
 
+/**
+ * Tokenize a std::string_view, without copying the tokens.
+ *
+ * The tokens are views into @p str.
+ */
+EGT_API void tokenize(std::string_view str, char delimiter, std::vector<std::string_view>& tokens);
+
 /**
  * Join each item of a container with the specified delimiter between each item.
  */
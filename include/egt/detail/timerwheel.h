@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef EGT_DETAIL_TIMERWHEEL_H
+#define EGT_DETAIL_TIMERWHEEL_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <egt/asio.hpp>
+#include <egt/detail/function.h>
+#include <egt/detail/meta.h>
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+/**
+ * Hierarchical timer wheel driven by a single asio timer.
+ *
+ * Time is cut in ticks of the resolution of the wheel, and ticks in blocks of
+ * 64 ticks. The timers of the current block are in the slot of the tick
+ * they expire in, in the first level of the wheel. The timers of the next
+ * blocks are in the slot of their block, in the second level, and cascade to
+ * the first level when the wheel reaches their block. All the timers
+ * expiring in the same tick run together, from a single wake up of the asio
+ * timer, which is only armed for the next tick that has timers.
+ *
+ * Timers never run before their deadline. They run at most one tick after it,
+ * plus the latency of the event loop.
+ *
+ * Scheduling and cancelling a timer is O(1): each timer is an intrusive entry
+ * of the list of its slot. Timers further than the second level reaches wait
+ * in its last slot, and are put in the second level again when that slot
+ * cascades. A bitmap of the slots that hold timers, for each level, gives the
+ * next slot to wake up for without walking the slots.
+ */
+class EGT_API TimerWheel
+{
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    /// Function called when a timer expires.
+    using Callback = InplaceFunction<void()>;
+
+    /// Link of a circular list of timers.
+    struct Link
+    {
+        Link* prev{nullptr};
+        Link* next{nullptr};
+    };
+
+    /**
+     * Timer in the wheel.
+     *
+     * The owner of the timer keeps this, and must not move it while it is
+     * scheduled.
+     */
+    class Entry : private Link
+    {
+    public:
+
+        Entry() noexcept = default;
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+        Entry(Entry&&) = delete;
+        Entry& operator=(Entry&&) = delete;
+
+        /// Check if the timer is scheduled.
+        EGT_NODISCARD bool scheduled() const { return m_wheel != nullptr; }
+
+        /// Cancel the timer, if it is scheduled.
+        void cancel();
+
+        /// Called when the timer expires.
+        Callback callback;
+
+        ~Entry() noexcept { cancel(); }
+
+    private:
+
+        /// Tick the timer expires in.
+        uint64_t m_tick{0};
+        /// Wheel of the timer, when it is scheduled.
+        TimerWheel* m_wheel{nullptr};
+        /// Head of the list the timer is in, when it is scheduled.
+        Link* m_head{nullptr};
+
+        friend class TimerWheel;
+    };
+
+    /**
+     * @param[in] io The io_context of the asio timer.
+     * @param[in] resolution Duration of a tick.
+     */
+    TimerWheel(asio::io_context& io, std::chrono::milliseconds resolution);
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+    TimerWheel(TimerWheel&&) = delete;
+    TimerWheel& operator=(TimerWheel&&) = delete;
+
+    /**
+     * Schedule a timer, or schedule it again if it is already scheduled.
+     *
+     * @param[in] entry The timer.
+     * @param[in] duration Duration from now after which the timer expires.
+     */
+    void schedule(Entry& entry, std::chrono::milliseconds duration);
+
+    /// Cancel a scheduled timer.
+    void cancel(Entry& entry);
+
+    /// Duration of a tick.
+    EGT_NODISCARD std::chrono::milliseconds resolution() const { return m_resolution; }
+
+    /// Number of scheduled timers.
+    EGT_NODISCARD size_t size() const { return m_count; }
+
+    ~TimerWheel() noexcept;
+
+private:
+
+    /// Number of slots of each level, one bit of a bitmap word each.
+    static constexpr size_t SLOTS = 64;
+
+    /// Tick of a point in time, rounded down.
+    EGT_NODISCARD uint64_t tick(const Clock::time_point& time) const;
+
+    /// Insert an entry before a link of a list.
+    static void link(Link& next, Entry& entry) noexcept;
+
+    /// Remove an entry from its list.
+    static void unlink(Entry& entry) noexcept;
+
+    /// Insert an entry in the slot of its tick, or of its block.
+    void insert(Entry& entry) noexcept;
+
+    /// Update the bitmaps after timers were removed from a list.
+    void update_slot(const Link& head) noexcept;
+
+    /// Get the next tick of the current block with timers, or UINT64_MAX.
+    EGT_NODISCARD uint64_t next_tick_in_block() const noexcept;
+
+    /// Get the next block with timers in the second level, or UINT64_MAX.
+    EGT_NODISCARD uint64_t next_block() const noexcept;
+
+    /// Get the next tick with timers, or UINT64_MAX if there is none.
+    EGT_NODISCARD uint64_t next_tick() const noexcept;
+
+    /// Move the timers of the ticks before a tick to the expired list, in order.
+    void advance(uint64_t to) noexcept;
+
+    /// Arm the asio timer for a tick.
+    void arm(uint64_t t);
+
+    /// Arm the asio timer for the next tick with timers.
+    void arm();
+
+    /// Called when the asio timer expires.
+    void expire(const asio::error_code& error);
+
+    asio::steady_timer m_timer;
+    std::chrono::milliseconds m_resolution;
+    /// Start of tick 0.
+    Clock::time_point m_start;
+    /// Next tick to process: the timers of all the ticks before have expired.
+    uint64_t m_tick{0};
+    /// Tick the asio timer is armed for, when armed.
+    uint64_t m_armed_tick{0};
+    bool m_armed{false};
+    /// Number of scheduled timers.
+    size_t m_count{0};
+    /// Heads of the circular lists of timers of each tick of the current block.
+    std::array<Link, SLOTS> m_ticks;
+    /// Bitmap of the slots of m_ticks that have timers.
+    uint64_t m_ticks_occupied{0};
+    /// Heads of the circular lists of timers of each next block.
+    std::array<Link, SLOTS> m_blocks;
+    /// Bitmap of the slots of m_blocks that have timers.
+    uint64_t m_blocks_occupied{0};
+    /// Head of the list of timers that expired and have not run yet.
+    Link m_expired;
+};
+
+}
+}
+}
+
+#endif
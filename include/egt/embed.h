@@ -44,4 +44,35 @@
       } resource_initializer ## name;					\
     }}
 
+/**
+ * @def EGT_EMBED_BUNDLE
+ *
+ * Embed a resource bundle into the compilation unit this is called from and
+ * register all of its resources.
+ *
+ * @param name Name of the embedded bundle.  This must be a safe C++ variable
+ * name.
+ * @param path Path of the bundle file to include.
+ *
+ * @b Example:
+ * @code{.cpp}
+ * EGT_EMBED_BUNDLE(my_bundle, "app.eres");
+ *
+ * Image my_image("res:my_image_png");
+ * @endcode
+ *
+ * @see ResourceManager::add_bundle()
+ */
+#define EGT_EMBED_BUNDLE(name, path)					\
+  INCBIN(name, path);							\
+  namespace egt { namespace resources {					\
+      struct resource_initializer ## name {				\
+	resource_initializer ## name() {				\
+	  egt::ResourceManager::instance().add_bundle(			\
+					 resource_ ## name ## _data,	\
+					 resource_ ## name ## _size);	\
+	}								\
+      } resource_initializer ## name;					\
+    }}
+
 #endif
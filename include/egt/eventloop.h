@@ -30,6 +30,7 @@ class Application;
 namespace detail
 {
 class PriorityQueue;
+class TimerWheel;
 }
 
 /**
@@ -111,9 +112,35 @@ public:
      */
     void add_idle_callback(IdleCallback func);
 
+    /**
+     * Frame callback function definition.
+     */
+    using FrameCallback = std::function<void ()>;
+
+    /**
+     * Add a callback to be called once per frame, before the frame is laid
+     * out and drawn.
+     *
+     * A frame is drawn each time the event loop handled events, so a callback
+     * that needs frames at some rate must also wake up the event loop, with a
+     * timer for example.
+     */
+    void add_frame_callback(FrameCallback func);
+
     /// @private
     detail::PriorityQueue& queue();
 
+    /**
+     * Get the timer wheel that drives timers, or nullptr when each timer
+     * uses its own asio timer.
+     *
+     * The timer wheel is enabled with the EGT_TIMER_WHEEL environment
+     * variable.
+     *
+     * @private
+     */
+    detail::TimerWheel* timer_wheel();
+
     ~EventLoop() noexcept;
 
 protected:
@@ -18,6 +18,8 @@
 #include <iosfwd>
 #include <map>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace egt
 {
@@ -201,7 +203,16 @@ public:
     /**
      * Set the slant of the font.
      */
-    void slant(Font::Slant s) { m_slant = s; }
+    void slant(Font::Slant s) { m_slant = s; direct_allocate(); }
+
+    /**
+     * Get the interned id of the font.
+     *
+     * Fonts with the same face, size, weight, and slant share the same small
+     * integer id, which is cheaper to compare and hash than the font itself.
+     * The id is looked up once and kept until the font is modified.
+     */
+    EGT_NODISCARD uint32_t id() const;
 
     /**
      * Get the font extents based on a default context.
@@ -217,16 +228,16 @@ public:
     /**
      * Get the text extents based on a default context.
      *
-     * Internally, calls 'Painter::extents(const std::string&)' on a default
+     * Internally, calls 'Painter::extents(std::string_view)' on a default
      * Painter instance, which has no transformation like rotation or symmetry.
      *
      * If you want to transform the font, then you should call
-     * 'Painter::extents(const std::string&)' instead, on the relevant Painter
+     * 'Painter::extents(std::string_view)' instead, on the relevant Painter
      * instance.
      *
      * @param[in] text The UTF8 encoded text.
      */
-    EGT_NODISCARD Font::TextExtents extents(const std::string& text) const;
+    EGT_NODISCARD Font::TextExtents extents(std::string_view text) const;
 
     /**
      * Get the size of a rectangle containing the text, based on a default
@@ -241,7 +252,7 @@ public:
      * @param[in] text The UTF8 encoded text.
      * @return the minimum size of a rectangle containing the text.
      */
-    EGT_NODISCARD egt::Size text_size(const std::string& text) const;
+    EGT_NODISCARD egt::Size text_size(std::string_view text) const;
 
     /**
      * Generates a FontConfig scaled font instance.
@@ -278,6 +289,21 @@ public:
      */
     static void reset_font_cache();
 
+    /**
+     * Look up fonts in the background, so that using them later does not wait
+     * for Fontconfig.
+     *
+     * This is meant to be called at startup with the fonts the application
+     * uses. Fonts found by Fontconfig are also saved to a cache file, see
+     * the EGT_FONT_CACHE environment variable, so Fontconfig is not needed
+     * at all for them on the next run.
+     *
+     * Fonts loaded from a file or from memory are ignored.
+     *
+     * @param[in] fonts The fonts to look up.
+     */
+    static void preload(const std::vector<Font>& fonts);
+
     /**
      * Basically, this will clear the font cache and shutdown FontConfig which
      * will release all memory allocated by FontConfig.
@@ -313,6 +339,9 @@ protected:
     /// Use default size.
     bool m_use_default_size{true};
 
+    /// Interned id, 0 until looked up.
+    mutable uint32_t m_id{0};
+
 private:
     Font::Size default_font_size();
 };
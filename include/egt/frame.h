@@ -229,6 +229,13 @@ public:
      */
     void remove_all();
 
+    /**
+     * Get the range of child widgets.
+     *
+     * @warning Adding or removing a child, or a component, invalidates
+     * iterators of this range. To change children while walking them, walk
+     * them by index with count_children() and child_at().
+     */
     using Widget::children;
 
     /**
@@ -319,7 +326,7 @@ public:
             return;
 
         Widget::show();
-        layout();
+        request_layout();
     }
 
     /**
@@ -107,7 +107,9 @@ public:
      * @param hscale Horizontal scale of the image, with 1.0 being 100%.
      * @param vscale Vertical scale of the image, with 1.0 being 100%.
      * @param approximate Approximate the scale to increase image cache
-     *            hit efficiency.
+     *            hit efficiency. Approximate scales of raster images are
+     *            resampled from a cached mipmap of the decoded image
+     *            instead of decoding it again.
      * @param is_cached Tell whether the image will be stored in the image cache.
      */
     void scale(float hscale, float vscale, bool approximate = false, bool is_cached = false);
@@ -33,6 +33,10 @@ public:
     void serialize(Serializer& serializer) const;
     bool deserialize(const std::string& name, const std::string& value);
 
+    /// Get the group of a property named by serialize() for an ImageGroup with the suffix.
+    static bool property_group(const std::string& name, const std::string& suffix,
+                               Palette::GroupId& group);
+
 private:
 
     std::unique_ptr<Image>& select(Palette::GroupId group, bool allow_fallback = false);
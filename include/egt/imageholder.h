@@ -66,7 +66,9 @@ public:
                          const AlignFlags& text_align = T::default_text_align()) noexcept
         : T(text, rect, text_align)
     {
-        this->name(type() + std::to_string(this->m_widgetid));
+        // type() is the same for all instances
+        static const auto prefix = type();
+        this->name_prefix(prefix.c_str());
 
         if (text.empty())
         {
@@ -33,7 +33,7 @@ public:
 
     NotebookTab()
     {
-        name("NotebookTab" + std::to_string(m_widgetid));
+        name_prefix("NotebookTab");
 
         // tabs are not transparent by default
         fill_flags(Theme::FillFlag::solid);
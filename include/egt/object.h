@@ -11,12 +11,13 @@
  * @brief Base object definition.
  */
 
+#include <array>
 #include <cstdint>
 #include <egt/detail/cow.h>
+#include <egt/detail/function.h>
 #include <egt/detail/meta.h>
 #include <egt/event.h>
 #include <egt/flagsbase.h>
-#include <functional>
 #include <string>
 #include <vector>
 
@@ -38,8 +39,19 @@ public:
     Object(Object&&) = default;
     Object& operator=(Object&&) = default;
 
-    /// Get the name of the Object.
-    EGT_NODISCARD const std::string& name() const { return m_name; }
+    /**
+     * Get the name of the Object.
+     *
+     * Until a name is set, this is the default name of the Object. The
+     * default name is generated on each call and never stored, so getting
+     * the name does not modify the Object.
+     */
+    EGT_NODISCARD std::string name() const
+    {
+        if (m_name.empty())
+            return default_name();
+        return m_name;
+    }
 
     /**
      * Set the name of the Object.
@@ -51,13 +63,18 @@ public:
      */
     void name(const std::string& name) { m_name = name; }
 
-    /// Event handler callback function.
-    using EventCallback = std::function<void (Event& event)>;
+    /**
+     * Event handler callback function.
+     *
+     * Small callables, like lambdas capturing a few pointers, are stored
+     * without allocating.
+     */
+    using EventCallback = detail::InplaceFunction<void (Event& event)>;
 
     /// Event handler EventId filter.
     using FilterFlags = FlagsBase<EventId>;
 
-    /// Handle type.
+    /// Handle type, wide enough to never wrap.
     using RegisterHandle = uint64_t;
 
     /**
@@ -108,6 +125,9 @@ public:
 
 protected:
 
+    /// Name of the Object when none has been set.
+    EGT_NODISCARD virtual std::string default_name() const { return {}; }
+
     /// Counter used to generate unique handles for each callback registration.
     RegisterHandle m_handle_counter{0};
 
@@ -141,8 +161,50 @@ protected:
     /// Helper type for an array of callbacks.
     using CallbackArray = std::vector<CallbackMeta>;
 
-    /// Array of callbacks.
-    detail::CopyOnWriteAllocate<CallbackArray> m_callbacks;
+    /**
+     * Number of buckets of handlers.
+     *
+     * Each EventId is a single bit. Events with a bit from the last bucket on
+     * share the last bucket.
+     */
+    static constexpr size_t EVENT_BUCKETS = 16;
+
+    /**
+     * Registered callbacks, bucketed by EventId.
+     */
+    struct Handlers
+    {
+        /// Callbacks, in the order they were registered.
+        CallbackArray callbacks;
+        /// Positions in callbacks of the handlers of each bucket, bucket after bucket.
+        std::vector<uint32_t> positions;
+        /// Start of each bucket in positions.
+        std::array<uint32_t, EVENT_BUCKETS + 1> offsets{};
+        /// Callbacks added while handlers are being invoked.
+        CallbackArray pending;
+        /// Number of invoke_handlers() calls in progress.
+        uint32_t dispatching{0};
+        /// Callbacks were removed while handlers were being invoked.
+        bool removed{false};
+
+        /// Fill the buckets again after callbacks changed.
+        void index();
+
+        /**
+         * Apply the changes made while handlers were being invoked.
+         *
+         * Removed callbacks only have their handle cleared while dispatching,
+         * and added callbacks wait in pending, so callbacks never moves under
+         * a running handler.
+         */
+        void settle();
+    };
+
+    /// Bucket of the handlers of an EventId.
+    static size_t bucket(EventId id);
+
+    /// Registered callbacks.
+    detail::CopyOnWriteAllocate<Handlers> m_handlers;
 
     /// A user defined name for the Object.
     std::string m_name;
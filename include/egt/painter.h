@@ -22,6 +22,7 @@
 #include <iosfwd>
 #include <memory>
 #include <string>
+#include <string_view>
 
 namespace egt
 {
@@ -473,9 +474,18 @@ public:
      *
      * @param[in] text The UTF8 encoded text.
      */
-    EGT_NODISCARD Font::TextExtents extents(const std::string& text) const;
+    EGT_NODISCARD Font::TextExtents extents(std::string_view text) const;
 
-    Size text_size(const std::string& text);
+    /**
+     * Get the size of a rectangle containing the text, which may be made of
+     * several lines, based on the current context.
+     *
+     * The text does not need to be null terminated and is measured without
+     * copying it.
+     *
+     * @param[in] text The UTF8 encoded text.
+     */
+    Size text_size(std::string_view text);
 
     void color_at(const Point& point, const Color& color) noexcept;
     Color color_at(const Point& point) noexcept;
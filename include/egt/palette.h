@@ -16,6 +16,7 @@
 #include <egt/fixedvector.h>
 #include <egt/pattern.h>
 #include <egt/serialize.h>
+#include <cstdint>
 #include <initializer_list>
 #include <iosfwd>
 #include <memory>
@@ -277,6 +278,11 @@ public:
         : m_colors(colors)
     {}
 
+    Palette(const Palette&) = default;
+    Palette(Palette&&) noexcept = default;
+    Palette& operator=(const Palette& rhs);
+    Palette& operator=(Palette&& rhs) noexcept;
+
     Palette& operator=(const PatternArray& colors);
 
     /**
@@ -389,6 +395,23 @@ EGT_API void global_palette(std::unique_ptr<Palette>&& palette);
  */
 EGT_API void reset_global_palette();
 
+namespace detail
+{
+
+/**
+ * Get the generation of the palettes.
+ *
+ * The generation changes when any palette or the theme changes. Widgets keep
+ * the colors they resolve until the generation changes, or until they are
+ * moved to another parent.
+ */
+EGT_API uint32_t palette_generation();
+
+/// Change the generation of the palettes.
+EGT_API void palette_changed();
+
+}
+
 }
 }
 
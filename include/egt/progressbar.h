@@ -59,7 +59,7 @@ public:
                              T start = {}, T end = 100, T value = {}) noexcept
         : ValueRangeWidget<T>(rect, start, end, value)
     {
-        this->name("ProgressBar" + std::to_string(this->m_widgetid));
+        this->name_prefix("ProgressBar");
         this->fill_flags(Theme::FillFlag::blend);
         this->border(this->theme().default_border());
     }
@@ -430,7 +430,7 @@ public:
                               T start = 0, T end = 100, T value = 0) noexcept
         : ValueRangeWidget<T>(rect, start, end, value)
     {
-        this->name("SpinProgress" + std::to_string(this->m_widgetid));
+        this->name_prefix("SpinProgress");
         this->fill_flags(Theme::FillFlag::blend);
     }
 
@@ -691,7 +691,7 @@ public:
                             T start = 0, T end = 100, T value = 0) noexcept
         : ValueRangeWidget<T>(rect, start, end, value)
     {
-        this->name("LevelMeter" + std::to_string(this->m_widgetid));
+        this->name_prefix("LevelMeter");
         this->fill_flags(Theme::FillFlag::blend);
         this->padding(2);
     }
@@ -936,7 +936,7 @@ public:
     explicit AnalogMeterType(const Rect& rect = {}) noexcept
         : ValueRangeWidget<T>(rect, 0, 100, 0)
     {
-        this->name("AnalogMeter" + std::to_string(this->m_widgetid));
+        this->name_prefix("AnalogMeter");
         this->fill_flags(Theme::FillFlag::blend);
     }
 
@@ -963,7 +963,7 @@ protected:
     explicit AnalogMeterType(Serializer::Properties& props, bool is_derived) noexcept
         : ValueRangeWidget<T>(props, true)
     {
-        this->name("AnalogMeter" + std::to_string(this->m_widgetid));
+        this->name_prefix("AnalogMeter");
         this->fill_flags(Theme::FillFlag::blend);
 
         if (!is_derived)
@@ -85,7 +85,7 @@ public:
     explicit RadialType(const Rect& rect = {}) noexcept
         : Widget(rect)
     {
-        this->name("Radial" + std::to_string(m_widgetid));
+        this->name_prefix("Radial");
         this->grab_mouse(true);
     }
 
@@ -112,7 +112,7 @@ protected:
     explicit RadialType(Serializer::Properties& props, bool is_derived) noexcept
         : Widget(props, true)
     {
-        this->name("Radial" + std::to_string(m_widgetid));
+        this->name_prefix("Radial");
         this->grab_mouse(true);
 
         if (!is_derived)
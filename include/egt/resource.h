@@ -14,6 +14,8 @@
 #include <cstdint>
 #include <egt/detail/meta.h>
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -58,6 +60,28 @@ public:
      */
     void add(const char* name, const std::vector<unsigned char>& data);
 
+    /**
+     * Register all resources of a resource bundle file.
+     *
+     * The file is mapped in memory, so uncompressed resources are not copied.
+     * Resources registered with add() take precedence over resources of a
+     * bundle with the same name.
+     *
+     * @throws std::runtime_error if the file is not a valid resource bundle.
+     *
+     * @see @ref resources_bundle
+     */
+    void add_bundle(const std::string& filename);
+
+    /**
+     * Register all resources of an in-memory resource bundle.
+     *
+     * @warning This does not copy the data, so it must remain available.
+     *
+     * @throws std::runtime_error if the data is not a valid resource bundle.
+     */
+    void add_bundle(const unsigned char* data, size_t len);
+
     /**
      * Unregister a resource.
      */
@@ -109,15 +133,23 @@ public:
      */
     bool stream_read(const char* name, unsigned char* data, size_t length);
 
+    ~ResourceManager() noexcept;
+
 private:
 
     ResourceManager();
 
     struct ResourceItem;
+    struct Bundle;
 
     using ResourceMap = std::map<std::string, ResourceItem>;
 
+    ResourceItem* find(const char* name);
+    bool in_bundle(const char* name) const;
+
     ResourceMap m_resources;
+    std::vector<std::unique_ptr<Bundle>> m_bundles;
+    std::set<std::string> m_hidden;
 };
 
 }
@@ -105,7 +105,7 @@ public:
     explicit LineWidget(const Rect& rect = {})
         : Widget(rect)
     {
-        name("LineWidget" + std::to_string(m_widgetid));
+        name_prefix("LineWidget");
         fill_flags().clear();
     }
 
@@ -180,7 +180,7 @@ public:
     explicit RectangleWidget(const Rect& rect = {})
         : Widget(rect)
     {
-        name("RectangleWidget" + std::to_string(m_widgetid));
+        name_prefix("RectangleWidget");
         fill_flags(Theme::FillFlag::blend);
     }
 
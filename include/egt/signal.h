@@ -11,10 +11,11 @@
  * @brief Signal definition.
  */
 
+#include <algorithm>
 #include <cstdint>
 #include <egt/detail/cow.h>
+#include <egt/detail/function.h>
 #include <egt/detail/meta.h>
-#include <functional>
 #include <vector>
 
 namespace egt
@@ -37,13 +38,18 @@ public:
 
     /**
      * Event handler callback function.
+     *
+     * Small callables, like lambdas capturing a few pointers, are stored
+     * without allocating.
      */
-    using EventCallback = std::function<void(Args...)>;
+    using EventCallback = detail::InplaceFunction<void(Args...)>;
 
     /**
      * Handle type.
+     *
+     * This is wide enough to never wrap, so handles are unique.
      */
-    using RegisterHandle = uint32_t;
+    using RegisterHandle = uint64_t;
 
     /**
      * Add an event handler to be called when the widget generates an event.
@@ -60,7 +66,6 @@ public:
     {
         if (handler)
         {
-            // TODO: m_handle_counter can wrap, making the handle non-unique
             auto handle = ++m_handle_counter;
             m_callbacks->emplace_back(handler, handle);
             return handle;
@@ -189,9 +194,9 @@ public:
         INVALID_HANDLE = 0,
     };
 
-    using EventCallback = std::function<void(Args...)>;
+    using EventCallback = typename Signal<Args...>::EventCallback;
 
-    using RegisterHandle = uint32_t;
+    using RegisterHandle = typename Signal<Args...>::RegisterHandle;
 
     SignalW(Signal<Args...>* src)
     {
@@ -58,7 +58,7 @@ public:
         : m_orient(orient),
           m_justify(justify)
     {
-        name("BoxSizer" + std::to_string(m_widgetid));
+        name_prefix("BoxSizer");
     }
 
     /**
@@ -105,7 +105,7 @@ public:
     void justify(Justification justify)
     {
         if (detail::change_if_diff<>(m_justify, justify))
-            layout();
+            request_layout();
     }
 
     /**
@@ -119,7 +119,7 @@ public:
     void orient(Orientation orient)
     {
         if (detail::change_if_diff<>(m_orient, orient))
-            layout();
+            request_layout();
     }
 
     void serialize(Serializer& serializer) const override;
@@ -202,7 +202,7 @@ public:
     explicit HorizontalBoxSizer(Justification justify = Justification::middle)
         : BoxSizer(Orientation::horizontal, justify)
     {
-        name("HorizontalBoxSizer" + std::to_string(m_widgetid));
+        name_prefix("HorizontalBoxSizer");
     }
 
     explicit HorizontalBoxSizer(Serializer::Properties& props)
@@ -245,7 +245,7 @@ public:
     explicit VerticalBoxSizer(Justification justify = Justification::middle)
         : BoxSizer(Orientation::vertical, justify)
     {
-        name("VerticalBoxSizer" + std::to_string(m_widgetid));
+        name_prefix("VerticalBoxSizer");
     }
 
     explicit VerticalBoxSizer(Serializer::Properties& props)
@@ -288,7 +288,7 @@ public:
     explicit FlexBoxSizer(Justification justify = Justification::middle)
         : BoxSizer(Orientation::flex, justify)
     {
-        name("FlexBoxSizer" + std::to_string(m_widgetid));
+        name_prefix("FlexBoxSizer");
     }
 
     /**
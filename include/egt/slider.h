@@ -667,7 +667,7 @@ SliderType<T>::SliderType(const Rect& rect, T start, T end, T value,
     : ValueRangeWidget<T>(rect, start, end, value),
       m_orient(orient)
 {
-    this->name("Slider" + std::to_string(this->m_widgetid));
+    this->name_prefix("Slider");
     this->fill_flags(Theme::FillFlag::blend);
     this->grab_mouse(true);
     this->slider_flags().set(SliderFlag::rectangle_handle);
@@ -20,6 +20,7 @@
 #include <egt/timer.h>
 #include <egt/types.h>
 #include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -535,11 +536,94 @@ protected:
     /// Compute damage rectangles for selection updates
     void selection_damage();
 
-    /// Split the text into atomic tokens that fill the TextRects parameter.
-    void tokenize(TextRects& rects);
+    /// A line of the text layout.
+    struct TextLine
+    {
+        /// First TextRect of the line.
+        TextRects::iterator first;
+
+        /// Position of the beginning of the line. This is a UTF-8 offset.
+        size_t pos{0};
+
+        /// Position of the beginning of the line in bytes.
+        size_t offset{0};
+
+        /// Number of UTF-8 characters in the line, including a trailing newline.
+        size_t length{0};
+
+        /// Number of bytes in the line, including a trailing newline.
+        size_t size{0};
+
+        /// Width of the line, not including a trailing newline.
+        DefaultDim width{0};
+
+        /// The line is the first one of a paragraph.
+        bool paragraph{false};
+
+        /// The line ends with a newline.
+        bool newline{false};
+
+        /// Position the TextRects of the line are at, see settle_lines().
+        Point origin;
+    };
+
+    /// Type array used for the lines of the text layout.
+    using TextLines = std::vector<TextLine>;
+
+    /**
+     * Lay out the line of text starting at line.pos.
+     *
+     * Tokens are placed from left to right at point until one does not fit
+     * in max_width, or a newline is reached. The TextRects of the line are
+     * appended to rects.
+     *
+     * @return false if there is no more text to lay out.
+     */
+    bool layout_line(TextLine& line, const Point& point,
+                     DefaultDim max_width, TextRects& rects);
+
+    /// Get the offset of the first line in the text boundaries.
+    EGT_NODISCARD Point layout_offset() const;
+
+    /// Get the position of a line of m_lines.
+    EGT_NODISCARD Point line_origin(size_t index) const;
+
+    /**
+     * Move the TextRects of the lines from first to last, excluded, to the
+     * position of their line.
+     *
+     * Moving the text, or inserting or removing lines before others, only
+     * changes the position of the lines: their TextRects are moved when they
+     * are used.
+     */
+    void settle_lines(size_t first, size_t last);
+
+    /// Add (count = 1) or remove (count = -1) lines from m_line_widths and m_paragraphs.
+    void count_lines(TextLines::const_iterator begin, TextLines::const_iterator end, int count);
+
+    /// Get the width available to a line before it wraps.
+    EGT_NODISCARD DefaultDim wrap_width() const;
+
+    /// Get the height of a line.
+    EGT_NODISCARD DefaultDim line_height() const;
+
+    /// Get the first line ending at or after pos, if any.
+    EGT_NODISCARD TextLines::const_iterator find_line(size_t pos) const;
+
+    /**
+     * Update the layout after removed characters were replaced by inserted
+     * characters at pos.
+     *
+     * Only the lines from the edited paragraph are laid out again, stopping
+     * as soon as the line breaks match the previous layout.
+     */
+    void relayout_text(size_t pos, size_t removed, size_t inserted);
+
+    /// Move the laid out text by delta.
+    void translate_text(const Point& delta);
 
-    /// Compute the text layout from the tokens contained in the TextRects.
-    void compute_layout(TextRects& rects);
+    /// Update the first TextRect of each line after m_rects changed.
+    void index_lines();
 
     /// Merge adjacent TextRect items, when possible.
     void consolidate(TextRects& rects);
@@ -611,8 +695,8 @@ protected:
     /// Damage the differences between two selected texts.
     void tag_text_selection(const TextRects& prev, const TextRects& next);
 
-    /// Tokenize and compute the layout of a text; fill TextRects accordingly.
-    void prepare_text(TextRects& rects);
+    /// Tokenize and compute the layout of a text; fill TextRects and TextLines accordingly.
+    void prepare_text(TextRects& rects, TextLines& lines);
 
     /// Update m_cursor_rect based on the current position of the cursor.
     void get_cursor_rect();
@@ -713,6 +797,18 @@ protected:
     TextRects m_rects;
     Rect m_cursor_rect;
 
+    /// Lines of m_rects.
+    TextLines m_lines;
+
+    /// Position of the first line of m_rects.
+    Point m_layout_origin;
+
+    /// Number of lines of each width in m_lines, to get the widest one.
+    std::map<DefaultDim, size_t> m_line_widths;
+
+    /// Number of lines of m_lines starting a paragraph.
+    size_t m_paragraphs{0};
+
     /**
      * Given text, return the number of UTF8 characters that will fit on a
      * single line inside of the widget.
@@ -810,6 +906,32 @@ private:
 
 namespace detail
 {
+/// Renderers used by draw_text().
+enum class TextRenderer
+{
+    /// Draw glyphs with cairo.
+    cairo,
+    /**
+     * Blend glyphs rasterized once per font into an A8 atlas straight into
+     * the target surface, falling back to cairo for transformed contexts.
+     *
+     * Glyphs are placed on a quarter of a pixel horizontally and on whole
+     * pixels vertically, so text can differ slightly from what cairo draws.
+     */
+    glyph_atlas,
+};
+
+/**
+ * Select the renderer used by draw_text().
+ *
+ * The default is cairo, unless the EGT_GLYPH_ATLAS environment variable is
+ * set.
+ */
+EGT_API void text_renderer(TextRenderer renderer);
+
+/// Get the renderer used by draw_text().
+EGT_API TextRenderer text_renderer();
+
 /// Internal draw text function.
 EGT_API void draw_text(Painter& painter,
                        const Rect& b,
@@ -825,6 +947,25 @@ EGT_API void draw_text(Painter& painter,
                        size_t select_start = 0,
                        size_t select_len = 0);
 
+class TextMask;
+
+/**
+ * Internal draw text function, through a mask of the text.
+ *
+ * The text is rendered once into an A8 mask kept in @p mask, which is then
+ * painted with the color until the text, font, flags, alignment, or size
+ * change. Transformed contexts draw the text directly.
+ */
+EGT_API void draw_text(Painter& painter,
+                       std::unique_ptr<TextMask>& mask,
+                       const Rect& b,
+                       const std::string& text,
+                       const Font& font,
+                       const TextBox::TextFlags& flags,
+                       const AlignFlags& text_align,
+                       Justification justify,
+                       const Pattern& text_color);
+
 /// Internal draw text function with associated image.
 EGT_API void draw_text(Painter& painter,
                        const Rect& b,
@@ -17,12 +17,55 @@
 #include <egt/widget.h>
 #include <memory>
 #include <string>
+#include <string_view>
 
 namespace egt
 {
 inline namespace v1
 {
 
+namespace detail
+{
+class TextMask;
+
+/**
+ * Statistics of the text size cache used by TextWidget.
+ */
+struct TextSizeCacheStats
+{
+    /// Number of measurements found in the cache.
+    size_t hits{0};
+    /// Number of measurements that had to be computed.
+    size_t misses{0};
+    /// Number of entries dropped to stay within the capacity.
+    size_t evictions{0};
+    /// Current number of entries.
+    size_t size{0};
+    /// Maximum number of entries.
+    size_t capacity{0};
+};
+
+/**
+ * Set the maximum number of entries of the text size cache.
+ *
+ * The default capacity is 256 entries, or the value of the
+ * EGT_TEXT_SIZE_CACHE environment variable. A capacity of 0 disables the
+ * cache.
+ */
+EGT_API void text_size_cache_capacity(size_t capacity);
+
+/**
+ * Get the statistics of the text size cache.
+ */
+EGT_API TextSizeCacheStats text_size_cache_stats();
+
+/**
+ * Drop all entries of the text size cache and reset its statistics.
+ */
+EGT_API void text_size_cache_clear();
+
+}
+
 /**
  * A widget with text and text related properties.
  *
@@ -66,6 +109,8 @@ protected:
 
 public:
 
+    ~TextWidget() noexcept override;
+
     /**
      * Set the text.
      *
@@ -107,15 +152,57 @@ public:
     /**
      * Given a Font, text, and a target Size, scale the font size so that
      * the text will will fit and return the new Font.
+     *
+     * The size is reduced in steps of 1 from the size of the font. Instead of
+     * trying every step, the first step is estimated from the size of the
+     * text with the original font and the others are binary searched, which
+     * assumes the text gets smaller with the font. The size found is
+     * remembered for the same font, target, and text length, and tried first
+     * the next time.
+     */
+    static Font scale_font(const Size& target, std::string_view text, const Font& font);
+
+    /**
+     * Shrink the font so that the text fits in the content area.
+     *
+     * When enabled, the text is drawn with scale_font() applied to font() and
+     * the content area. The scaled font is kept until the text, the font, or
+     * the size of the widget changes.
+     *
+     * @param[in] enable Enable or disable shrinking the font.
+     */
+    void auto_fit(bool enable)
+    {
+        if (detail::change_if_diff<>(m_auto_fit, enable))
+            damage();
+    }
+
+    /**
+     * Get the auto fit state.
+     */
+    EGT_NODISCARD bool auto_fit() const { return m_auto_fit; }
+
+    /**
+     * Get the font to draw the text with.
+     *
+     * This is font(), scaled down if auto_fit() is enabled.
      */
-    static Font scale_font(const Size& target, const std::string& text, const Font& font);
+    EGT_NODISCARD const Font& text_font() const;
 
     void serialize(Serializer& serializer) const override;
 
 protected:
 
     /// Get the size of the text.
-    EGT_NODISCARD Size text_size(const std::string& text) const;
+    EGT_NODISCARD Size text_size(std::string_view text) const;
+
+    /**
+     * Get the size of the text of the widget.
+     *
+     * Unlike text_size(), the size is kept by the widget until its text or its
+     * font changes, for min_size_hint() which is called by every layout.
+     */
+    EGT_NODISCARD Size text_size_hint() const;
 
     /// Alignment of the text.
     AlignFlags m_text_align{AlignFlag::center};
@@ -123,6 +210,21 @@ protected:
     /// The text.
     std::string m_text;
 
+    /// Shrink the font so that the text fits.
+    bool m_auto_fit{false};
+
+    /// Font scaled by text_font(), and the hash of what it was scaled for.
+    mutable std::unique_ptr<Font> m_fit_font;
+    mutable size_t m_fit_key{0};
+
+    /// Size found by text_size_hint(), and the hash of what it was found for.
+    mutable Size m_text_size_hint;
+    mutable size_t m_text_size_key{0};
+    mutable bool m_text_size_valid{false};
+
+    /// Text rendered by the last draw, see detail::draw_text().
+    mutable std::unique_ptr<detail::TextMask> m_text_mask;
+
 private:
 
     void deserialize(Serializer::Properties& props);
@@ -15,6 +15,7 @@
 #include <egt/detail/enum.h>
 #include <egt/detail/meta.h>
 #include <egt/detail/range.h>
+#include <egt/detail/spatialindex.h>
 #include <egt/event.h>
 #include <egt/flags.h>
 #include <egt/font.h>
@@ -27,9 +28,11 @@
 #include <egt/signal.h>
 #include <egt/theme.h>
 #include <egt/widgetflags.h>
+#include <forward_list>
 #include <iosfwd>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace egt
 {
@@ -1349,6 +1352,26 @@ public:
      */
     virtual void layout();
 
+    /**
+     * Request a layout of the Widget.
+     *
+     * Unlike layout(), this does not perform the layout right away. Requests
+     * are queued, and every widget with a request is laid out once, parents
+     * first, just before the next draw or by Application::layout_now().
+     */
+    void request_layout();
+
+    /**
+     * Indicate if a layout of the Widget is requested and not done yet.
+     */
+    EGT_NODISCARD bool layout_requested() const
+    {
+        return m_layout_requested;
+    }
+
+    /// @private
+    static void flush_layout_requests();
+
     /**
      * Helper function to draw this widget's box using the appropriate
      * theme.
@@ -1641,7 +1664,9 @@ protected:
      */
     EGT_NODISCARD ChildDrawCallback special_child_draw_callback() const
     {
-        return m_special_child_draw_callback;
+        if (m_extra)
+            return m_extra->special_child_draw_callback;
+        return {};
     }
 
     /**
@@ -1661,7 +1686,7 @@ protected:
      */
     void special_child_draw_callback(ChildDrawCallback func)
     {
-        m_special_child_draw_callback = std::move(func);
+        extra().special_child_draw_callback = std::move(func);
     }
 
     /**
@@ -1675,8 +1700,8 @@ protected:
      */
     void special_child_draw(Painter& painter, Widget* widget)
     {
-        if (m_special_child_draw_callback)
-            m_special_child_draw_callback(painter, widget);
+        if (m_extra && m_extra->special_child_draw_callback)
+            m_extra->special_child_draw_callback(painter, widget);
         else if (parent())
             parent()->special_child_draw(painter, widget);
     }
@@ -1799,13 +1824,31 @@ protected:
      */
     WidgetId m_widgetid{0};
 
+    /**
+     * Set the prefix of the default name of the widget.
+     *
+     * The default name is the prefix followed by the widget id. It is
+     * generated when name() is called and never stored, so widgets nobody
+     * names do not hold a string.
+     *
+     * @param[in] prefix Static string, usually the type of the widget.
+     */
+    void name_prefix(const char* prefix);
+
+    EGT_NODISCARD std::string default_name() const override;
+
+    /**
+     * Prefix of the default name.
+     */
+    const char* m_name_prefix{nullptr};
+
     /**
      * Indicate if our parent is computing the layout.
      */
     EGT_NODISCARD bool parent_in_layout();
 
     /**
-     * Call our parent to do a layout.
+     * Request a layout of our parent.
      */
     void parent_layout();
 
@@ -1819,6 +1862,11 @@ protected:
      */
     bool m_in_layout{false};
 
+    /**
+     * Status for whether this widget is queued for a layout.
+     */
+    bool m_layout_requested{false};
+
     /**
      * Deserialize widget properties that require to call overridden methods.
      *
@@ -1834,67 +1882,134 @@ protected:
     /// @private
     void draw_subordinate(Painter& painter, const Rect& crect, Widget* child);
 
-    /// Used internally for calling the special child draw function.
-    ChildDrawCallback m_special_child_draw_callback;
-
-    /// Helper type for an array of subordinate widgets.
-    using SubordinatesArray = std::list<std::shared_ptr<Widget>>;
+    /**
+     * Helper type for an array of subordinate widgets.
+     *
+     * The array is contiguous, so that traversals do not chase list nodes.
+     * Adding or removing a subordinate invalidates its iterators, so code that
+     * may change the subordinates while walking them uses indexes, or the
+     * children() and components() ranges, which stay valid.
+     */
+    using SubordinatesArray = std::vector<std::shared_ptr<Widget>>;
 
     /// Array of subordinates widgets split in child widgets and component widgets.
     SubordinatesArray m_subordinates;
 
-    /// Return the array of child widgets.
-    EGT_NODISCARD const detail::Range<SubordinatesArray>& children() const
+    /// Helper type for the children() and components() ranges.
+    using SubordinatesRange = detail::IndexRange<SubordinatesArray>;
+
+    /**
+     * Return the array of child widgets.
+     *
+     * Iterators of the range stay valid when subordinates are added or
+     * removed, but then refer to whichever child is at their position.
+     */
+    EGT_NODISCARD const SubordinatesRange& children() const
     {
+        m_children.bind(const_cast<SubordinatesArray&>(m_subordinates), m_components_begin);
         return m_children;
     }
 
     /// Return the array of child widgets.
-    EGT_NODISCARD detail::Range<SubordinatesArray>& children()
+    EGT_NODISCARD SubordinatesRange& children()
     {
+        m_children.bind(m_subordinates, m_components_begin);
         return m_children;
     }
 
-    /// Array of child widgets in the order they were added.
-    detail::Range<SubordinatesArray> m_children;
+    /**
+     * Array of child widgets in the order they were added.
+     *
+     * Bound again on each access, so that it follows the Widget when moved.
+     */
+    mutable SubordinatesRange m_children;
 
     /// Return the array of components widgets.
-    EGT_NODISCARD const detail::Range<SubordinatesArray>& components() const
+    EGT_NODISCARD const SubordinatesRange& components() const
     {
+        m_components.bind(const_cast<SubordinatesArray&>(m_subordinates), m_components_begin);
         return m_components;
     }
 
     /// Return the array of components widgets.
-    EGT_NODISCARD detail::Range<SubordinatesArray>& components()
+    EGT_NODISCARD SubordinatesRange& components()
     {
+        m_components.bind(m_subordinates, m_components_begin);
         return m_components;
     }
 
-    /// Array of component widgets in the order they were added.
-    detail::Range<SubordinatesArray> m_components;
+    /// Array of component widgets in the order they were added, bound like m_children.
+    mutable SubordinatesRange m_components{true};
 
     /**
-     * Update the 'm_children' and 'm_components' members.
+     * Update what depends on the subordinates.
      *
-     * @note Should be called any time 'm_components_begin',
-     * m_subordonates.begin() or m_subordinates.end() have changed.
+     * @note Should be called any time 'm_components_begin' has changed or
+     * subordinates have been added or removed.
      */
     void update_subordinates_ranges()
     {
-        m_children.begin(m_subordinates.begin());
-        m_children.end(m_components_begin);
-        m_components.begin(m_components_begin);
-        m_components.end(m_subordinates.end());
+        invalidate_spatial_index();
     }
 
+    /**
+     * Get the spatial index of the children.
+     *
+     * The index is built the first time it is needed after the children
+     * changed.
+     *
+     * @return nullptr if there are too few subordinates to index them.
+     *
+     * @note All children must have the same point_from_subordinate().
+     */
+    detail::SpatialIndex* spatial_index();
+
+    /**
+     * Have the spatial index of the children built again, and forget the
+     * targets of the last pointer events.
+     *
+     * @note Should be called any time children are added, removed, or
+     * reordered.
+     */
+    void invalidate_spatial_index();
+
+    /**
+     * Update the spatial index of the parent after the box changed, and the
+     * target of the last pointer event in the parent.
+     */
+    void update_parent_spatial_index();
+
+    /**
+     * Get the subordinate that was the target of the last pointer event in
+     * this widget, if it is still the target for a point.
+     *
+     * @param[in] point Point in the coordinates of the box of this widget.
+     * @return nullptr if it is not known.
+     */
+    Widget* cached_target(const Point& point) const;
+
+    /**
+     * Remember the subordinate that is the target of a pointer event.
+     *
+     * It is only remembered when no subordinate above it overlaps it, so it
+     * stays the target for any point in its box until subordinates change.
+     */
+    void cache_target(Widget* target);
+
+    /// Check if any subordinate above a subordinate overlaps it.
+    bool overlapped(const Widget& target);
+
+    /// Spatial index of the children, when there are many of them.
+    std::unique_ptr<detail::SpatialIndex> m_spatial_index;
+
     /// Return either components() or children() depending on widget.component()
-    EGT_NODISCARD detail::Range<SubordinatesArray>& range_from_widget(const Widget& widget)
+    EGT_NODISCARD SubordinatesRange& range_from_widget(const Widget& widget)
     {
         return widget.component() ? components() : children();
     }
 
     /// Return either components() or children() depending on widget.component()
-    EGT_NODISCARD const detail::Range<SubordinatesArray>& range_from_widget(const Widget& widget) const
+    EGT_NODISCARD const SubordinatesRange& range_from_widget(const Widget& widget) const
     {
         return widget.component() ? components() : children();
     }
@@ -1911,12 +2026,13 @@ protected:
     /// Get the component status.
     EGT_NODISCARD bool component() const;
     /**
-     * Iterator for the beginning of components which are positionned after
-     * children in the subordinates array. Components are child widget as well,
-     * but not added through the Frame interface. Components are composition
-     * widgets and users must not be able to add extra ones or to remove them.
+     * Index of the beginning of components which are positionned after
+     * children in the subordinates array, which is also the number of
+     * children. Components are child widget as well, but not added through
+     * the Frame interface. Components are composition widgets and users must
+     * not be able to add extra ones or to remove them.
      */
-    SubordinatesArray::iterator m_components_begin;
+    size_t m_components_begin{0};
 
     /// The damage array for this widget.
     Screen::DamageArray m_damage;
@@ -1937,10 +2053,63 @@ private:
      */
     std::unique_ptr<Palette> m_palette;
 
+    /// Resolve a color through the palettes of the widget, its parents, and the theme.
+    EGT_NODISCARD const Pattern& resolve_color(Palette::ColorId id, Palette::GroupId group) const;
+
+    /**
+     * Colors resolved by color().
+     *
+     * Each entry is a copy of the color resolved for an id in a group, so it
+     * does not point into a palette that may go away, and entries never move
+     * or change once added, so references returned by color() stay valid
+     * while the cache is. The cache is only valid for the palette generation
+     * it was filled with, which changes when any palette or the theme
+     * changes.
+     */
+    struct ColorCache
+    {
+        struct Entry
+        {
+            Palette::ColorId id;
+            Palette::GroupId group;
+            Pattern color;
+        };
+
+        uint32_t generation{0};
+        std::forward_list<Entry> entries;
+    };
+
+    /// Cache of resolved colors, allocated the first time a color is resolved.
+    mutable std::unique_ptr<ColorCache> m_color_cache;
+
+    /**
+     * Drop the colors cached by this widget and its subordinates.
+     *
+     * Used when the palettes they inherit from change, without invalidating
+     * the colors cached by every other widget.
+     */
+    void reset_color_cache();
+
+    /**
+     * State that most widgets never use, kept out of the widget to keep it
+     * small.
+     */
+    struct Extra
+    {
+        /// Optional background images.
+        ImageGroup backgrounds{"bg"};
+
+        /// Used internally for calling the special child draw function.
+        ChildDrawCallback special_child_draw_callback;
+    };
+
+    /// Get the rarely used state, allocating it the first time.
+    Extra& extra();
+
     /**
-     * Optional background images.
+     * Rarely used state, allocated the first time it is needed.
      */
-    ImageGroup m_backgrounds{"bg"};
+    std::unique_ptr<Extra> m_extra;
 
     /**
      * Flags for the widget.
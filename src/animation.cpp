@@ -8,14 +8,218 @@
 #include "egt/app.h"
 #include "egt/detail/math.h"
 #include "egt/widget.h"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <memory>
+#include <vector>
 
 namespace egt
 {
 inline namespace v1
 {
 
+namespace detail
+{
+
+/**
+ * Clock running all the running AutoAnimation instances.
+ *
+ * The animations step from a frame callback of the event loop, which samples
+ * the time once and steps all the animations that are due with it, just
+ * before the frame is drawn, so all their changes are drawn in the same frame.
+ * A single timer wakes up the event loop when the next animation is due, and
+ * is not started while no animation runs. Animations whose target is hidden do
+ * not wake up the event loop.
+ */
+class AnimationClock
+{
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    /// Time of the current frame while animations step, or now.
+    static Clock::time_point now()
+    {
+        if (m_in_frame)
+            return m_frame_time;
+        return Clock::now();
+    }
+
+    /// Start running an animation.
+    static void add(AutoAnimation* animation)
+    {
+        if (std::find(m_animations.begin(), m_animations.end(), animation) != m_animations.end())
+            return;
+
+        m_animations.push_back(animation);
+
+        // animations started while others step are scheduled with them
+        if (!m_in_frame)
+            schedule(Clock::now());
+    }
+
+    /// Stop running an animation.
+    static void remove(AutoAnimation* animation)
+    {
+        auto i = std::find(m_animations.begin(), m_animations.end(), animation);
+        if (i == m_animations.end())
+            return;
+
+        // animations may be stopped while others step
+        if (m_in_frame)
+            *i = nullptr;
+        else
+            m_animations.erase(i);
+
+        if (m_stepping == animation)
+            m_stepping = nullptr;
+
+        if (!m_in_frame && m_animations.empty() && m_timer)
+            m_timer->cancel();
+    }
+
+    /// Clear the target of the animations targeting a widget.
+    static void forget(const Widget* widget)
+    {
+        auto& animations = targeted();
+        animations.erase(std::remove_if(animations.begin(), animations.end(),
+                                        [widget](AutoAnimation * animation)
+        {
+            if (animation->m_target != widget)
+                return false;
+            animation->m_target = nullptr;
+            return true;
+        }), animations.end());
+    }
+
+    /// Make a widget damaged by the stepping animation its target, if it has none.
+    static void damaged(const Widget* widget)
+    {
+        if (m_stepping && m_stepping->m_auto_target && !m_stepping->m_target)
+        {
+            m_stepping->target(widget);
+            m_stepping->m_auto_target = true;
+        }
+    }
+
+    /// Stop using the event loop, before its Application is destroyed.
+    static void cleanup()
+    {
+        m_animations.clear();
+        m_timer.reset();
+        m_hooked = false;
+    }
+
+    /// Animations with a target.
+    static std::vector<AutoAnimation*>& targeted()
+    {
+        static std::vector<AutoAnimation*> animations;
+        return animations;
+    }
+
+private:
+
+    static void frame()
+    {
+        if (m_animations.empty())
+            return;
+
+        m_frame_time = Clock::now();
+        m_in_frame = true;
+
+        // animations may start others, which then step with this frame too
+        for (size_t i = 0; i < m_animations.size(); ++i)
+        {
+            m_stepping = m_animations[i];
+            if (m_stepping)
+                m_stepping->frame(m_frame_time);
+        }
+
+        m_stepping = nullptr;
+        m_in_frame = false;
+
+        m_animations.erase(std::remove(m_animations.begin(), m_animations.end(), nullptr),
+                           m_animations.end());
+
+        schedule(m_frame_time);
+    }
+
+    /// Have the event loop wake up when the next animation is due.
+    static void schedule(const Clock::time_point& now)
+    {
+        if (!m_hooked)
+        {
+            Application::instance().event().add_frame_callback([]() { frame(); });
+            m_hooked = true;
+        }
+
+        auto due = Clock::time_point::max();
+        for (auto animation : m_animations)
+        {
+            if (animation && !animation->m_paused)
+                due = std::min(due, animation->m_last_step + animation->m_interval);
+        }
+
+        if (due == Clock::time_point::max())
+        {
+            if (m_timer)
+                m_timer->cancel();
+            return;
+        }
+
+        if (!m_timer)
+        {
+            m_timer = std::make_unique<Timer>();
+            m_timer->name("animation clock");
+        }
+
+        // restarting a pending timer would wake up the event loop for nothing
+        if (m_timer->running() && m_wakeup <= due)
+            return;
+
+        // round up, so that the animation is due when the timer expires
+        const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::max(due - now, Clock::duration::zero()) +
+                              std::chrono::milliseconds(1) - Clock::duration(1));
+        m_wakeup = now + wait;
+        m_timer->start(wait);
+    }
+
+    static std::vector<AutoAnimation*> m_animations;
+    static std::unique_ptr<Timer> m_timer;
+    static Clock::time_point m_frame_time;
+    static Clock::time_point m_wakeup;
+    static AutoAnimation* m_stepping;
+    static bool m_in_frame;
+    static bool m_hooked;
+};
+
+std::vector<AutoAnimation*> AnimationClock::m_animations;
+std::unique_ptr<Timer> AnimationClock::m_timer;
+AnimationClock::Clock::time_point AnimationClock::m_frame_time;
+AnimationClock::Clock::time_point AnimationClock::m_wakeup;
+AutoAnimation* AnimationClock::m_stepping{nullptr};
+bool AnimationClock::m_in_frame{false};
+bool AnimationClock::m_hooked{false};
+
+void forget_animation_target(const Widget* widget)
+{
+    AnimationClock::forget(widget);
+}
+
+void animation_damaged(const Widget* widget)
+{
+    AnimationClock::damaged(widget);
+}
+
+void animation_clock_cleanup()
+{
+    AnimationClock::cleanup();
+}
+
+}
+
 Animation::Animation(EasingScalar start, EasingScalar end,
                      const AnimationCallback& callback,
                      std::chrono::milliseconds duration,
@@ -31,7 +235,7 @@ Animation::Animation(EasingScalar start, EasingScalar end,
 void Animation::start()
 {
     m_elapsed = 0;
-    m_intermediate_time = std::chrono::steady_clock::now();
+    m_intermediate_time = detail::AnimationClock::now();
     m_running = true;
     m_current = m_start;
     if (m_round)
@@ -45,7 +249,7 @@ bool Animation::next()
     if (!running())
         return false;
 
-    auto now = std::chrono::steady_clock::now();
+    auto now = detail::AnimationClock::now();
     m_elapsed += std::chrono::duration<EasingScalar, std::milli>(now - m_intermediate_time).count();
     m_intermediate_time = now;
 
@@ -94,7 +298,7 @@ void Animation::resume()
     if (running())
         return;
 
-    m_intermediate_time = std::chrono::steady_clock::now();
+    m_intermediate_time = detail::AnimationClock::now();
     m_running = true;
     next();
 }
@@ -103,17 +307,8 @@ AutoAnimation::AutoAnimation(EasingScalar start, EasingScalar end,
                              std::chrono::milliseconds duration,
                              const EasingFunc& func,
                              const AnimationCallback& callback)
-    : Animation(start, end, callback, duration, func),
-      m_timer(std::chrono::milliseconds(30))
-{
-    m_timer.on_timeout([this]()
-    {
-        if (!next())
-        {
-            stop();
-        }
-    });
-}
+    : Animation(start, end, callback, duration, func)
+{}
 
 AutoAnimation::AutoAnimation(std::chrono::milliseconds duration,
                              const EasingFunc& func,
@@ -124,24 +319,70 @@ AutoAnimation::AutoAnimation(std::chrono::milliseconds duration,
 void AutoAnimation::start()
 {
     Animation::start();
-    m_timer.start();
+    m_paused = false;
+    m_last_step = m_intermediate_time;
+    detail::AnimationClock::add(this);
 }
 
 void AutoAnimation::stop()
 {
-    m_timer.cancel();
+    detail::AnimationClock::remove(this);
     Animation::stop();
 }
 
 void AutoAnimation::resume()
 {
     Animation::resume();
-    m_timer.start();
+    if (running())
+        detail::AnimationClock::add(this);
+}
+
+void AutoAnimation::target(const Widget* widget)
+{
+    auto& targeted = detail::AnimationClock::targeted();
+    auto i = std::find(targeted.begin(), targeted.end(), this);
+
+    if (widget && i == targeted.end())
+        targeted.push_back(this);
+    else if (!widget && i != targeted.end())
+        targeted.erase(i);
+
+    m_target = widget;
+    m_auto_target = false;
+}
+
+void AutoAnimation::frame(const std::chrono::time_point<std::chrono::steady_clock>& now)
+{
+    // pause while the target is hidden, without counting the time
+    for (auto widget = m_target; widget; widget = widget->parent())
+    {
+        if (!widget->visible())
+        {
+            m_paused = true;
+            return;
+        }
+    }
+
+    if (m_paused)
+    {
+        m_paused = false;
+        m_intermediate_time = now;
+        m_last_step = now;
+        return;
+    }
+
+    if (now - m_last_step < m_interval)
+        return;
+    m_last_step = now;
+
+    if (!next())
+        stop();
 }
 
-void AutoAnimation::interval(std::chrono::milliseconds duration)
+AutoAnimation::~AutoAnimation() noexcept
 {
-    m_timer.change_duration(duration);
+    detail::AnimationClock::remove(this);
+    target(nullptr);
 }
 
 }
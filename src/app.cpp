@@ -9,6 +9,7 @@
 
 #include "detail/egtlog.h"
 #include "detail/gpu.h"
+#include "egt/animation.h"
 #include "egt/app.h"
 #include "egt/detail/filesystem.h"
 #include "egt/detail/imagecache.h"
@@ -404,6 +405,11 @@ void Application::quit(int exit_value)
     m_event.quit(exit_value);
 }
 
+void Application::layout_now()
+{
+    Widget::flush_layout_requests();
+}
+
 void Application::paint_to_file(const std::string& filename)
 {
     auto name = filename;
@@ -412,6 +418,8 @@ void Application::paint_to_file(const std::string& filename)
         name = "screen.png";
     }
 
+    layout_now();
+
     Surface surface(screen()->size());
     Painter painter(surface);
 
@@ -470,6 +478,9 @@ Application::~Application() noexcept
 {
     Input::global_input().remove_handler(m_handle);
 
+    // the timer of the animation clock uses the event loop of this instance
+    detail::animation_clock_cleanup();
+
     /*
      * Clear the image cache to release all its shared Surfaces, hence giving a
      * chance to release the GPUSurface instances behind, before calling
@@ -81,7 +81,7 @@ Button::Button(const std::string& text,
                const AlignFlags& text_align) noexcept
     : TextWidget(text, rect, text_align)
 {
-    name("Button" + std::to_string(m_widgetid));
+    name_prefix("Button");
 
     fill_flags(Theme::FillFlag::blend);
     border_radius(4.0);
@@ -154,9 +154,10 @@ void Button::default_draw(const Button& widget, Painter& painter, const Rect& /*
     widget.draw_box(painter, Palette::ColorId::button_bg, Palette::ColorId::border);
 
     detail::draw_text(painter,
+                      widget.m_text_mask,
                       widget.content_area(),
                       widget.text(),
-                      widget.font(),
+                      widget.text_font(),
                       TextBox::TextFlags({TextBox::TextFlag::multiline, TextBox::TextFlag::word_wrap}),
                       widget.text_align(),
                       Justification::middle,
@@ -197,7 +198,7 @@ Size Button::min_size_hint() const
 
     if (!m_text.empty())
     {
-        auto s = text_size(m_text);
+        auto s = text_size_hint();
         if (m_text.find('\n') == m_text.npos)
         {
             // add a little bit of fluff for touch
@@ -228,7 +229,7 @@ Switch::Switch(const std::string& text,
                const Rect& rect) noexcept
     : Button(text, rect)
 {
-    name("Switch" + std::to_string(m_widgetid));
+    name_prefix("Switch");
 
     fill_flags().clear();
     padding(5);
@@ -438,7 +439,7 @@ Size Switch::min_size_hint() const
     auto s = Size(1, 1);
     if (!m_text.empty())
     {
-        s = text_size(m_text);
+        s = text_size_hint();
         if (m_switch_align.empty() ||
             m_switch_align.is_set(AlignFlag::left) ||
             m_switch_align.is_set(AlignFlag::right))
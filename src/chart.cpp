@@ -233,7 +233,7 @@ void ChartBase::deserialize(Serializer::Properties& props)
 LineChart::LineChart(const Rect& rect)
     : ChartBase(rect)
 {
-    name("LineChart" + std::to_string(m_widgetid));
+    name_prefix("LineChart");
 
     create_impl();
 }
@@ -329,7 +329,7 @@ LineChart::~LineChart() = default;
 PointChart::PointChart(const Rect& rect)
     : ChartBase(rect)
 {
-    name("PointChart" + std::to_string(m_widgetid));
+    name_prefix("PointChart");
 
     create_impl();
 }
@@ -413,7 +413,7 @@ PointChart::~PointChart() = default;
 BarChart::BarChart(const Rect& rect)
     : ChartBase(rect)
 {
-    name("BarChart" + std::to_string(m_widgetid));
+    name_prefix("BarChart");
 
     create_impl();
 }
@@ -432,7 +432,7 @@ BarChart::BarChart(Serializer::Properties& props, bool is_derived)
 BarChart::BarChart(const Rect& rect, std::unique_ptr<detail::PlPlotImpl>&& impl)
     : ChartBase(rect)
 {
-    name("BarChart" + std::to_string(m_widgetid));
+    name_prefix("BarChart");
 
     m_impl = std::move(impl);
 }
@@ -547,7 +547,7 @@ BarChart::~BarChart() = default;
 HorizontalBarChart::HorizontalBarChart(const Rect& rect)
     : BarChart(rect, std::make_unique<detail::PlPlotHBarChart>(*this))
 {
-    name("HorizontalBarChart" + std::to_string(m_widgetid));
+    name_prefix("HorizontalBarChart");
 }
 
 HorizontalBarChart::HorizontalBarChart(Serializer::Properties& props, bool is_derived)
@@ -563,7 +563,7 @@ PieChart::PieChart(const Rect& rect)
     : Widget(rect),
       m_impl(std::make_unique<detail::PlPlotPieChart>(*this))
 {
-    name("PieChart" + std::to_string(m_widgetid));
+    name_prefix("PieChart");
 }
 
 PieChart::PieChart(Serializer::Properties& props, bool is_derived)
@@ -19,7 +19,7 @@ CheckBox::CheckBox(const std::string& text,
                    const Rect& rect) noexcept
     : Switch(text, rect)
 {
-    name("CheckBox" + std::to_string(m_widgetid));
+    name_prefix("CheckBox");
 }
 
 CheckBox::CheckBox(Frame& parent,
@@ -67,7 +67,7 @@ void CheckBox::draw_switch(Painter& painter, const Rect& handle) const
 ToggleBox::ToggleBox(const Rect& rect) noexcept
     : CheckBox( {}, rect)
 {
-    name("ToggleBox" + std::to_string(m_widgetid));
+    name_prefix("ToggleBox");
 
     fill_flags(Theme::FillFlag::blend);
     border(theme().default_border());
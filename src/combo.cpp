@@ -56,7 +56,7 @@ ComboBoxPopup::ComboBoxPopup(ComboBox& parent)
     : Popup(Size(parent.size().width(), 40)),
       m_parent(parent)
 {
-    name("ComboBoxPopup" + std::to_string(m_widgetid));
+    name_prefix("ComboBoxPopup");
     border(20);
     if (!plane_window())
         fill_flags(Theme::FillFlag::blend);
@@ -164,7 +164,7 @@ ComboBox::ComboBox(const ItemArray& items,
     : Widget(rect),
       m_popup(std::make_shared<detail::ComboBoxPopup>(*this))
 {
-    name("ComboBox" + std::to_string(m_widgetid));
+    name_prefix("ComboBox");
 
     for (auto& i : items)
     {
@@ -0,0 +1,372 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef EGT_SRC_DETAIL_BITMAPFONT_H
+#define EGT_SRC_DETAIL_BITMAPFONT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+/**
+ * EGT bitmap font format.
+ *
+ * Glyphs of one font at one pixel size, rendered ahead of time as 4 or 8 bit
+ * coverage, with their metrics. Drawing them only takes blending the coverage,
+ * without FreeType or Fontconfig.
+ *
+ * The file starts with a header and a table of glyphs sorted by code point,
+ * followed by the coverage of every glyph. Rows of coverage are byte aligned,
+ * and with 4 bits per pixel the first pixel is in the high nibble. Metrics are
+ * 26.6 fixed point pixels, and offsets are relative to the start of the font.
+ */
+class BitmapFont
+{
+public:
+
+    static constexpr uint32_t egt_magic()
+    {
+        return 0x46424745; // "EGBF"
+    }
+
+    static constexpr uint32_t version()
+    {
+        return 1;
+    }
+
+    /// Size of the header in bytes.
+    static constexpr size_t header_size()
+    {
+        return 8 * sizeof(uint32_t);
+    }
+
+    /// Size of one glyph table entry in bytes.
+    static constexpr size_t entry_size()
+    {
+        return 5 * sizeof(uint32_t);
+    }
+
+    /// A glyph, as stored in the glyph table.
+    struct Glyph
+    {
+        /// Unicode code point.
+        uint32_t code_point{0};
+        /// Horizontal advance.
+        int32_t advance{0};
+        /// Offset of the top left corner of the coverage from the origin.
+        int16_t left{0};
+        int16_t top{0};
+        /// Size of the coverage in pixels.
+        uint16_t width{0};
+        uint16_t height{0};
+        /// Offset of the coverage.
+        uint32_t offset{0};
+    };
+
+    /// Font wide metrics.
+    struct Metrics
+    {
+        /// Pixel size the glyphs were rendered at.
+        int32_t size{0};
+        int32_t ascent{0};
+        int32_t descent{0};
+        /// Recommended distance between baselines.
+        int32_t height{0};
+    };
+
+    /// Convert from 26.6 fixed point.
+    static constexpr double from_fixed(int32_t value)
+    {
+        return value / 64.;
+    }
+
+    /// Convert to 26.6 fixed point.
+    static int32_t to_fixed(double value)
+    {
+        return static_cast<int32_t>(value * 64. + (value < 0 ? -0.5 : 0.5));
+    }
+
+    BitmapFont() = default;
+
+    /**
+     * Open a font from a buffer.
+     *
+     * The buffer is not copied and must outlive this object.
+     */
+    bool open(const unsigned char* buf, size_t len)
+    {
+        m_buf = nullptr;
+        m_len = 0;
+        m_count = 0;
+
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        if (!read_at(buf, len, 0, magic) || magic != egt_magic() ||
+            !read_at(buf, len, 4, version) || version != BitmapFont::version())
+            return false;
+
+        if (!read_at(buf, len, 8, m_bpp) ||
+            !read_at(buf, len, 12, m_metrics.size) ||
+            !read_at(buf, len, 16, m_metrics.ascent) ||
+            !read_at(buf, len, 20, m_metrics.descent) ||
+            !read_at(buf, len, 24, m_metrics.height) ||
+            !read_at(buf, len, 28, m_count))
+            return false;
+
+        if ((m_bpp != 4 && m_bpp != 8) || m_metrics.size <= 0 ||
+            header_size() + static_cast<size_t>(m_count) * entry_size() > len)
+            return false;
+
+        m_buf = buf;
+        m_len = len;
+
+        // check the coverage of every glyph is in the buffer once for all
+        for (size_t i = 0; i < m_count; ++i)
+        {
+            const auto g = glyph(i);
+            if (g.offset + static_cast<size_t>(stride(g.width)) * g.height > len)
+            {
+                m_buf = nullptr;
+                m_len = 0;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /// Check if a buffer starts like a bitmap font.
+    static bool is_bitmap_font(const unsigned char* buf, size_t len)
+    {
+        uint32_t magic = 0;
+        return read_at(buf, len, 0, magic) && magic == egt_magic();
+    }
+
+    /// Check if a file starts like a bitmap font.
+    static bool is_bitmap_font(const std::string& path)
+    {
+        unsigned char buf[sizeof(uint32_t)]{};
+        std::ifstream in(path, std::ios::binary);
+        in.read(reinterpret_cast<char*>(buf), sizeof(buf));
+        return in && is_bitmap_font(buf, sizeof(buf));
+    }
+
+    bool valid() const { return m_buf != nullptr; }
+
+    const Metrics& metrics() const { return m_metrics; }
+
+    /// Bits per pixel of the coverage, 4 or 8.
+    uint32_t bpp() const { return m_bpp; }
+
+    /// Number of glyphs.
+    size_t count() const { return m_count; }
+
+    /// Get a glyph by its index in the table.
+    Glyph glyph(size_t index) const
+    {
+        const auto entry = header_size() + index * entry_size();
+
+        Glyph g;
+        uint32_t packed = 0;
+        read_at(m_buf, m_len, entry, g.code_point);
+        read_at(m_buf, m_len, entry + 4, g.advance);
+        read_at(m_buf, m_len, entry + 8, packed);
+        g.left = static_cast<int16_t>(packed & 0xffff);
+        g.top = static_cast<int16_t>(packed >> 16);
+        read_at(m_buf, m_len, entry + 12, packed);
+        g.width = packed & 0xffff;
+        g.height = packed >> 16;
+        read_at(m_buf, m_len, entry + 16, g.offset);
+        return g;
+    }
+
+    /**
+     * Find the index of the glyph of a code point.
+     *
+     * @return count() if the font has no glyph for the code point.
+     */
+    size_t find(uint32_t code_point) const
+    {
+        size_t low = 0;
+        size_t high = m_count;
+        while (low < high)
+        {
+            const auto mid = low + (high - low) / 2;
+            uint32_t cp = 0;
+            read_at(m_buf, m_len, header_size() + mid * entry_size(), cp);
+            if (cp < code_point)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        if (low < m_count)
+        {
+            uint32_t cp = 0;
+            read_at(m_buf, m_len, header_size() + low * entry_size(), cp);
+            if (cp == code_point)
+                return low;
+        }
+
+        return m_count;
+    }
+
+    /**
+     * Expand the coverage of a glyph to 8 bits per pixel.
+     *
+     * @param[in] g The glyph.
+     * @param[out] dst Destination of width x height pixels.
+     * @param[in] dst_stride Stride of the destination in bytes.
+     */
+    void decode(const Glyph& g, unsigned char* dst, size_t dst_stride) const
+    {
+        const auto src_stride = stride(g.width);
+        for (size_t y = 0; y < g.height; ++y)
+        {
+            const auto src = m_buf + g.offset + y * src_stride;
+            auto out = dst + y * dst_stride;
+            if (m_bpp == 8)
+            {
+                std::memcpy(out, src, g.width);
+            }
+            else
+            {
+                for (size_t x = 0; x < g.width; ++x)
+                {
+                    const auto nibble = (x & 1) ? (src[x / 2] & 0x0f) : (src[x / 2] >> 4);
+                    out[x] = nibble * 17;
+                }
+            }
+        }
+    }
+
+    /// Glyph rendered ahead of time, with 8 bit coverage, to save a font.
+    struct SourceGlyph
+    {
+        Glyph glyph;
+        std::vector<unsigned char> coverage;
+    };
+
+    /**
+     * Save a font.
+     *
+     * The offsets of the glyphs are ignored, glyphs are sorted, and the
+     * coverage is reduced to @p bpp bits per pixel.
+     *
+     * @return The size of the saved font, or 0 on error.
+     */
+    static size_t save(const std::string& path, const Metrics& metrics,
+                       std::vector<SourceGlyph> glyphs, uint32_t bpp = 8)
+    {
+        if (bpp != 4 && bpp != 8)
+            return 0;
+
+        std::sort(glyphs.begin(), glyphs.end(), [](const SourceGlyph & a, const SourceGlyph & b)
+        {
+            return a.glyph.code_point < b.glyph.code_point;
+        });
+
+        const auto bpp_stride = [bpp](size_t width)
+        {
+            return (width * bpp + 7) / 8;
+        };
+
+        std::vector<unsigned char> out(header_size() + glyphs.size() * entry_size());
+        write_at(out, 0, egt_magic());
+        write_at(out, 4, version());
+        write_at(out, 8, bpp);
+        write_at(out, 12, metrics.size);
+        write_at(out, 16, metrics.ascent);
+        write_at(out, 20, metrics.descent);
+        write_at(out, 24, metrics.height);
+        write_at(out, 28, static_cast<uint32_t>(glyphs.size()));
+
+        for (size_t i = 0; i < glyphs.size(); ++i)
+        {
+            const auto& g = glyphs[i].glyph;
+            const auto& coverage = glyphs[i].coverage;
+            if (coverage.size() < static_cast<size_t>(g.width) * g.height)
+                return 0;
+
+            const auto entry = header_size() + i * entry_size();
+            write_at(out, entry, g.code_point);
+            write_at(out, entry + 4, g.advance);
+            write_at(out, entry + 8, static_cast<uint32_t>(static_cast<uint16_t>(g.left)) |
+                     (static_cast<uint32_t>(static_cast<uint16_t>(g.top)) << 16));
+            write_at(out, entry + 12, static_cast<uint32_t>(g.width) |
+                     (static_cast<uint32_t>(g.height) << 16));
+            write_at(out, entry + 16, static_cast<uint32_t>(out.size()));
+
+            const auto row = bpp_stride(g.width);
+            const auto start = out.size();
+            out.resize(start + row * g.height);
+            for (size_t y = 0; y < g.height; ++y)
+            {
+                auto dst = out.data() + start + y * row;
+                const auto src = coverage.data() + y * g.width;
+                if (bpp == 8)
+                {
+                    std::memcpy(dst, src, g.width);
+                }
+                else
+                {
+                    for (size_t x = 0; x < g.width; ++x)
+                    {
+                        const auto nibble = (src[x] + 8) / 17;
+                        dst[x / 2] |= (x & 1) ? nibble : nibble << 4;
+                    }
+                }
+            }
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(out.data()), out.size());
+        return file ? out.size() : 0;
+    }
+
+private:
+
+    size_t stride(size_t width) const
+    {
+        return (width * m_bpp + 7) / 8;
+    }
+
+    template<class T>
+    static bool read_at(const unsigned char* buf, size_t len, size_t offset, T& value)
+    {
+        if (!buf || offset + sizeof(T) > len)
+            return false;
+        memcpy(&value, buf + offset, sizeof(T));
+        return true;
+    }
+
+    template<class T>
+    static void write_at(std::vector<unsigned char>& buf, size_t offset, T value)
+    {
+        memcpy(buf.data() + offset, &value, sizeof(value));
+    }
+
+    const unsigned char* m_buf{nullptr};
+    size_t m_len{0};
+    uint32_t m_bpp{8};
+    uint32_t m_count{0};
+    Metrics m_metrics;
+};
+
+}
+}
+}
+
+#endif
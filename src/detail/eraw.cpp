@@ -3,8 +3,13 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include "detail/eraw.h"
 #include "detail/erawimage.h"
+#include "detail/erawtiled.h"
 
 namespace egt
 {
@@ -15,11 +20,23 @@ namespace detail
 
 Surface load_eraw(const std::string& filename)
 {
+    ErawTiledImage tiled;
+    if (tiled.open(filename))
+        return tiled.decode();
+
     return ErawImage::load(filename);
 }
 
 Surface load_eraw(const unsigned char* buf, size_t len)
 {
+    if (ErawTiledImage::is_tiled(buf, len))
+    {
+        ErawTiledImage tiled;
+        if (!tiled.open(buf, len))
+            return {};
+        return tiled.decode();
+    }
+
     return ErawImage::load(buf, len);
 }
 
@@ -20,6 +20,9 @@ namespace detail
 /**
  * Load an ERAW file into a surface.
  *
+ * Both the run length encoded format and the tiled format are supported.
+ * Tiles of the tiled format are decoded in parallel.
+ *
  * @param[in] filename The path of the SVG file.
  */
 Surface load_eraw(const std::string& filename);
@@ -0,0 +1,502 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "detail/erawtiled.h"
+#include "egt/detail/meta.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+template<class T>
+static bool read_at(const unsigned char* buf, size_t len, size_t offset, T& value)
+{
+    if (!buf || offset + sizeof(T) > len)
+        return false;
+    memcpy(&value, buf + offset, sizeof(T));
+    return true;
+}
+
+/// Number of tiles along a dimension, in 64 bits so that it cannot wrap.
+static uint64_t tiles_along(uint32_t size, uint32_t tile_size)
+{
+    return (static_cast<uint64_t>(size) + tile_size - 1) / tile_size;
+}
+
+static void write_at(std::vector<unsigned char>& buf, size_t offset, uint32_t value)
+{
+    memcpy(buf.data() + offset, &value, sizeof(value));
+}
+
+static uint16_t to_rgb565(uint32_t pixel)
+{
+    return ((pixel >> 8) & 0xf800) |
+           ((pixel >> 5) & 0x07e0) |
+           ((pixel >> 3) & 0x001f);
+}
+
+/*
+ * Same block scheme as the v1 format, except that pixels are T wide and a
+ * block never crosses a row of the tile so rows can be written directly to
+ * the target surface.
+ */
+template<class T>
+static void encode_rle(const T* data, const T* end, std::vector<unsigned char>& out)
+{
+    auto put = [&out](const void* p, size_t n)
+    {
+        auto b = static_cast<const unsigned char*>(p);
+        out.insert(out.end(), b, b + n);
+    };
+
+    while (data < end)
+    {
+        auto ptr = data;
+        while (ptr < end && *ptr == *data && ptr - data < 0x7fff)
+            ptr++;
+
+        uint16_t block = ptr - data;
+        if (block >= 2)
+        {
+            const uint16_t header = block | 0x8000;
+            put(&header, sizeof(header));
+            put(data, sizeof(T));
+            data += block;
+            continue;
+        }
+
+        ptr = data + 1;
+        while (ptr < end && *ptr != *(ptr - 1) && ptr - data < 0x7fff)
+            ptr++;
+        if (ptr < end && *ptr == *(ptr - 1))
+            ptr--;
+        block = std::max<ptrdiff_t>(ptr - data, 1);
+        put(&block, sizeof(block));
+        put(data, block * sizeof(T));
+        data += block;
+    }
+}
+
+template<class T>
+static bool decode_rle(const unsigned char* buf, const unsigned char* end,
+                       const Rect& box, Surface& target)
+{
+    auto base = static_cast<unsigned char*>(target.data());
+
+    for (DefaultDim row = 0; row < box.height(); ++row)
+    {
+        auto dst = reinterpret_cast<T*>(base + (box.y() + row) * target.stride()) + box.x();
+        const auto dst_end = dst + box.width();
+
+        while (dst < dst_end)
+        {
+            uint16_t block = 0;
+            if (!read_at(buf, end - buf, 0, block))
+                return false;
+            buf += sizeof(block);
+
+            if (block & 0x8000)
+            {
+                block &= 0x7fff;
+                T value = 0;
+                if (block > dst_end - dst ||
+                    !read_at(buf, end - buf, 0, value))
+                    return false;
+                buf += sizeof(value);
+                std::fill(dst, dst + block, value);
+            }
+            else
+            {
+                if (!block || block > dst_end - dst ||
+                    buf + block * sizeof(T) > end)
+                    return false;
+                memcpy(dst, buf, block * sizeof(T));
+                buf += block * sizeof(T);
+            }
+            dst += block;
+        }
+    }
+
+    return true;
+}
+
+static bool deflate(ErawTiledImage::Compression compression,
+                    const std::vector<unsigned char>& in,
+                    std::vector<unsigned char>& out)
+{
+    switch (compression)
+    {
+#ifdef HAVE_ZLIB
+    case ErawTiledImage::Compression::zlib:
+    {
+        auto len = compressBound(in.size());
+        out.resize(len);
+        if (compress2(out.data(), &len, in.data(), in.size(), Z_BEST_COMPRESSION) != Z_OK)
+            return false;
+        out.resize(len);
+        return true;
+    }
+#endif
+#ifdef HAVE_LZ4
+    case ErawTiledImage::Compression::lz4:
+    {
+        out.resize(LZ4_compressBound(in.size()));
+        const auto len = LZ4_compress_default(reinterpret_cast<const char*>(in.data()),
+                                              reinterpret_cast<char*>(out.data()),
+                                              in.size(), out.size());
+        if (len <= 0)
+            return false;
+        out.resize(len);
+        return true;
+    }
+#endif
+    default:
+        detail::ignoreparam(in);
+        detail::ignoreparam(out);
+        break;
+    }
+
+    return false;
+}
+
+bool ErawTiledImage::open(const unsigned char* buf, size_t len)
+{
+    m_buf = nullptr;
+    m_len = 0;
+    m_decoded.clear();
+
+    uint32_t magic = 0;
+    uint32_t flags = 0;
+    if (!read_at(buf, len, 0, magic) || magic != egt_magic())
+        return false;
+    if (!read_at(buf, len, 4, m_width) ||
+        !read_at(buf, len, 8, m_height) ||
+        !read_at(buf, len, 12, m_tile_size) ||
+        !read_at(buf, len, 16, flags))
+        return false;
+
+    if (!m_width || !m_height || !m_tile_size)
+        return false;
+
+    // the image must fit in the coordinates of a Rect
+    const auto limit = static_cast<uint32_t>(std::numeric_limits<DefaultDim>::max());
+    if (m_width > limit || m_height > limit)
+        return false;
+
+    if (!read_at(buf, len, 20, m_x) ||
+        !read_at(buf, len, 24, m_y))
+        return false;
+
+    m_format = static_cast<Format>(flags & 0xff);
+    m_compression = static_cast<Compression>((flags >> 8) & 0xff);
+    if (m_format != Format::argb8888 && m_format != Format::rgb565)
+        return false;
+
+    /*
+     * The tile index must fit in the buffer. Compare without multiplying, so
+     * that a crafted header cannot wrap the number of tiles.
+     */
+    const auto tiles_x = tiles_along(m_width, m_tile_size);
+    const auto tiles_y = tiles_along(m_height, m_tile_size);
+    const uint64_t max_tiles = len < header_size() ? 0 : (len - header_size()) / entry_size();
+    if (tiles_x > max_tiles || tiles_y > max_tiles / tiles_x)
+        return false;
+
+    m_tiles_x = static_cast<uint32_t>(tiles_x);
+    m_tiles_y = static_cast<uint32_t>(tiles_y);
+
+    m_buf = buf;
+    m_len = len;
+    m_decoded.assign(tile_count(), 0);
+
+    return true;
+}
+
+bool ErawTiledImage::open(const std::string& filename)
+{
+    std::ifstream i(filename, std::ios_base::binary | std::ios_base::ate);
+    if (!i)
+        return false;
+
+    const auto size = i.tellg();
+    if (size < static_cast<std::streamoff>(header_size()))
+        return false;
+
+    uint32_t magic = 0;
+    i.seekg(0);
+    if (!i.read(reinterpret_cast<char*>(&magic), sizeof(magic)) ||
+        magic != egt_magic())
+        return false;
+
+    m_storage.resize(size);
+    i.seekg(0);
+    if (!i.read(reinterpret_cast<char*>(m_storage.data()), size))
+        return false;
+
+    return open(m_storage.data(), m_storage.size());
+}
+
+bool ErawTiledImage::is_tiled(const unsigned char* buf, size_t len)
+{
+    uint32_t magic = 0;
+    return read_at(buf, len, 0, magic) && magic == egt_magic();
+}
+
+Rect ErawTiledImage::tile_rect(size_t index) const
+{
+    const uint32_t x = (index % m_tiles_x) * m_tile_size;
+    const uint32_t y = (index / m_tiles_x) * m_tile_size;
+    return {static_cast<DefaultDim>(x),
+            static_cast<DefaultDim>(y),
+            static_cast<DefaultDim>(std::min(m_tile_size, m_width - x)),
+            static_cast<DefaultDim>(std::min(m_tile_size, m_height - y))};
+}
+
+bool ErawTiledImage::decode_tile(size_t index, Surface& target,
+                                 std::vector<unsigned char>& scratch) const
+{
+    if (!valid() || index >= tile_count() ||
+        target.size() != size() || target.format() != format())
+        return false;
+
+    uint32_t offset = 0;
+    uint32_t length = 0;
+    uint32_t raw_length = 0;
+    const auto entry = header_size() + index * entry_size();
+    if (!read_at(m_buf, m_len, entry, offset) ||
+        !read_at(m_buf, m_len, entry + 4, length) ||
+        !read_at(m_buf, m_len, entry + 8, raw_length))
+        return false;
+
+    if (static_cast<size_t>(offset) + length > m_len)
+        return false;
+
+    const unsigned char* data = m_buf + offset;
+    if (length != raw_length)
+    {
+        scratch.resize(raw_length);
+        if (!inflate(data, length, scratch.data(), raw_length))
+            return false;
+        data = scratch.data();
+    }
+
+    const auto box = tile_rect(index);
+    if (m_format == Format::rgb565)
+        return decode_rle<uint16_t>(data, data + raw_length, box, target);
+    return decode_rle<uint32_t>(data, data + raw_length, box, target);
+}
+
+Surface ErawTiledImage::decode(unsigned threads) const
+{
+    if (!valid())
+        return {};
+
+    Surface surface = create_surface();
+    surface.sync_for_cpu();
+
+    if (!threads)
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    threads = std::min<size_t>(threads, tile_count());
+
+    std::atomic<bool> ok{true};
+    auto worker = [this, &surface, &ok, threads](unsigned first)
+    {
+        std::vector<unsigned char> scratch;
+        for (size_t t = first; t < tile_count() && ok; t += threads)
+        {
+            if (!decode_tile(t, surface, scratch))
+                ok = false;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+        pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& t : pool)
+        t.join();
+
+    if (!ok)
+        return {};
+
+    // must mark surface dirty once we manually fill it in
+    surface.mark_dirty();
+
+    return surface;
+}
+
+size_t ErawTiledImage::decode(const Rect& region, Surface& target)
+{
+    if (!valid())
+        return 0;
+
+    const auto area = Rect::intersection(region, Rect(Point(), size()));
+    if (area.empty())
+        return 0;
+
+    const auto tx0 = area.x() / m_tile_size;
+    const auto ty0 = area.y() / m_tile_size;
+    const auto tx1 = (area.right() - 1) / m_tile_size;
+    const auto ty1 = (area.bottom() - 1) / m_tile_size;
+
+    target.sync_for_cpu();
+
+    size_t count = 0;
+    std::vector<unsigned char> scratch;
+    for (auto ty = ty0; ty <= ty1; ++ty)
+    {
+        for (auto tx = tx0; tx <= tx1; ++tx)
+        {
+            const size_t index = static_cast<size_t>(ty) * m_tiles_x + tx;
+            if (m_decoded[index])
+                continue;
+
+            if (decode_tile(index, target, scratch))
+            {
+                m_decoded[index] = 1;
+                count++;
+            }
+        }
+    }
+
+    if (count)
+        target.mark_dirty();
+
+    return count;
+}
+
+uint32_t ErawTiledImage::save(const std::string& path, const unsigned char* data,
+                              int32_t x, int32_t y,
+                              uint32_t width, uint32_t height, uint32_t stride,
+                              Format format, Compression compression,
+                              uint32_t tile_size)
+{
+    if (!width || !height || !tile_size)
+        return 0;
+
+    // the offsets in the tile index are 32 bits
+    const auto tiles_x = tiles_along(width, tile_size);
+    const auto tiles_y = tiles_along(height, tile_size);
+    const uint64_t max_tiles = (UINT32_MAX - header_size()) / entry_size();
+    if (tiles_x > max_tiles || tiles_y > max_tiles / tiles_x)
+        return 0;
+    const auto count = static_cast<uint32_t>(tiles_x * tiles_y);
+
+    std::vector<unsigned char> out(header_size() + count * entry_size());
+    const uint32_t flags = static_cast<uint32_t>(format) |
+                           (static_cast<uint32_t>(compression) << 8);
+    write_at(out, 0, egt_magic());
+    write_at(out, 4, width);
+    write_at(out, 8, height);
+    write_at(out, 12, tile_size);
+    write_at(out, 16, flags);
+    write_at(out, 20, static_cast<uint32_t>(x));
+    write_at(out, 24, static_cast<uint32_t>(y));
+
+    std::vector<unsigned char> rle;
+    std::vector<unsigned char> packed;
+    std::vector<uint16_t> line;
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        const auto tx = static_cast<uint32_t>((index % tiles_x) * tile_size);
+        const auto ty = static_cast<uint32_t>((index / tiles_x) * tile_size);
+        const auto w = std::min(tile_size, width - tx);
+        const auto h = std::min(tile_size, height - ty);
+
+        rle.clear();
+        for (uint32_t row = 0; row < h; ++row)
+        {
+            auto src = reinterpret_cast<const uint32_t*>(data + static_cast<size_t>(ty + row) * stride) + tx;
+            if (format == Format::rgb565)
+            {
+                line.resize(w);
+                for (uint32_t i = 0; i < w; ++i)
+                    line[i] = to_rgb565(src[i]);
+                encode_rle(line.data(), line.data() + w, rle);
+            }
+            else
+            {
+                encode_rle(src, src + w, rle);
+            }
+        }
+
+        const unsigned char* payload = rle.data();
+        uint32_t length = rle.size();
+        if (deflate(compression, rle, packed) && packed.size() < rle.size())
+        {
+            payload = packed.data();
+            length = packed.size();
+        }
+
+        if (out.size() + length > UINT32_MAX)
+            return 0;
+
+        const auto entry = header_size() + index * entry_size();
+        write_at(out, entry, static_cast<uint32_t>(out.size()));
+        write_at(out, entry + 4, length);
+        write_at(out, entry + 8, static_cast<uint32_t>(rle.size()));
+        out.insert(out.end(), payload, payload + length);
+    }
+
+    std::ofstream o(path, std::ios_base::app | std::ios_base::binary);
+    if (!o.write(reinterpret_cast<const char*>(out.data()), out.size()))
+        return 0;
+
+    return out.size();
+}
+
+bool ErawTiledImage::inflate(const unsigned char* in, size_t len,
+                             unsigned char* out, size_t out_len) const
+{
+    switch (m_compression)
+    {
+#ifdef HAVE_ZLIB
+    case Compression::zlib:
+    {
+        uLongf dest_len = out_len;
+        return uncompress(out, &dest_len, in, len) == Z_OK && dest_len == out_len;
+    }
+#endif
+#ifdef HAVE_LZ4
+    case Compression::lz4:
+        return LZ4_decompress_safe(reinterpret_cast<const char*>(in),
+                                   reinterpret_cast<char*>(out),
+                                   len, out_len) == static_cast<int>(out_len);
+#endif
+    default:
+        detail::ignoreparam(in);
+        detail::ignoreparam(len);
+        detail::ignoreparam(out);
+        detail::ignoreparam(out_len);
+        break;
+    }
+
+    return false;
+}
+
+}
+}
+}
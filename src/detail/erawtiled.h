@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef EGT_SRC_DETAIL_ERAWTILED_H
+#define EGT_SRC_DETAIL_ERAWTILED_H
+
+#include <cstdint>
+#include <egt/geometry.h>
+#include <egt/surface.h>
+#include <string>
+#include <vector>
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+/**
+ * Tiled EGT raw image format (eraw v2).
+ *
+ * The image is split into square tiles, each one run length encoded
+ * independently and optionally compressed. A tile index at the start of the
+ * image gives the offset of every tile, so tiles can be decoded in parallel or
+ * only when they become visible.
+ *
+ * All offsets are relative to the start of the image header so that several
+ * images can be concatenated in one file.
+ */
+class ErawTiledImage
+{
+public:
+
+    /// Pixel format of the tile data.
+    enum class Format : uint8_t
+    {
+        argb8888 = 0,
+        rgb565 = 1,
+    };
+
+    /// Compression applied to each tile.
+    enum class Compression : uint8_t
+    {
+        none = 0,
+        zlib = 1,
+        lz4 = 2,
+    };
+
+    static constexpr uint32_t egt_magic()
+    {
+        return 0x50502AA3;
+    }
+
+    static constexpr uint32_t default_tile_size()
+    {
+        return 64;
+    }
+
+    /// Size of the fixed header in bytes.
+    static constexpr size_t header_size()
+    {
+        return 8 * sizeof(uint32_t);
+    }
+
+    /// Size of one tile index entry in bytes.
+    static constexpr size_t entry_size()
+    {
+        return 3 * sizeof(uint32_t);
+    }
+
+    ErawTiledImage() = default;
+
+    /**
+     * Open an image from a buffer.
+     *
+     * The buffer is not copied and must outlive this object.
+     */
+    bool open(const unsigned char* buf, size_t len);
+
+    /**
+     * Open an image from a file.
+     *
+     * The file is read in one pass and owned by this object.
+     */
+    bool open(const std::string& filename);
+
+    /// Returns true if the buffer starts with an eraw v2 header.
+    static bool is_tiled(const unsigned char* buf, size_t len);
+
+    bool valid() const { return m_buf != nullptr; }
+
+    Size size() const { return {static_cast<DefaultDim>(m_width), static_cast<DefaultDim>(m_height)}; }
+
+    /// Position of the image in the document it was extracted from.
+    Point origin() const { return {m_x, m_y}; }
+
+    PixelFormat format() const
+    {
+        return m_format == Format::rgb565 ? PixelFormat::rgb565 : PixelFormat::argb8888;
+    }
+
+    size_t tile_count() const { return static_cast<size_t>(m_tiles_x) * m_tiles_y; }
+
+    /// Box of the tile in image coordinates.
+    Rect tile_rect(size_t index) const;
+
+    /**
+     * Create an empty surface able to hold the whole image.
+     */
+    Surface create_surface() const
+    {
+        return Surface(size(), format());
+    }
+
+    /**
+     * Decode one tile into its position in the target surface.
+     *
+     * @param[in] index Tile index.
+     * @param[in] target Surface created with create_surface().
+     * @param[in] scratch Buffer reused for decompression.
+     */
+    bool decode_tile(size_t index, Surface& target, std::vector<unsigned char>& scratch) const;
+
+    bool decode_tile(size_t index, Surface& target) const
+    {
+        std::vector<unsigned char> scratch;
+        return decode_tile(index, target, scratch);
+    }
+
+    /**
+     * Decode the whole image.
+     *
+     * @param[in] threads Number of worker threads, 0 picks the number of
+     *            available cores.
+     */
+    Surface decode(unsigned threads = 0) const;
+
+    /**
+     * Decode on demand the tiles intersecting a region.
+     *
+     * Tiles already decoded into the target by a previous call are skipped,
+     * which makes this suitable for decoding the visible part of a large image
+     * while it is panned.
+     *
+     * @return The number of newly decoded tiles.
+     */
+    size_t decode(const Rect& region, Surface& target);
+
+    /**
+     * Save an image in the tiled format.
+     *
+     * @param[in] path Output file, the image is appended to it.
+     * @param[in] data ARGB32 premultiplied pixel data.
+     * @param[in] width Width of the image.
+     * @param[in] height Height of the image.
+     * @param[in] stride Stride of the data in bytes.
+     * @param[in] format Pixel format to store.
+     * @param[in] compression Compression to try on each tile.
+     * @param[in] tile_size Size of the square tiles.
+     * @return The number of bytes written, 0 on error.
+     */
+    static uint32_t save(const std::string& path, const unsigned char* data,
+                         uint32_t width, uint32_t height, uint32_t stride,
+                         Format format = Format::argb8888,
+                         Compression compression = Compression::none,
+                         uint32_t tile_size = default_tile_size())
+    {
+        return save(path, data, 0, 0, width, height, stride, format,
+                    compression, tile_size);
+    }
+
+    /**
+     * Save an image in the tiled format along with its origin.
+     *
+     * @see save()
+     */
+    static uint32_t save(const std::string& path, const unsigned char* data,
+                         int32_t x, int32_t y,
+                         uint32_t width, uint32_t height, uint32_t stride,
+                         Format format = Format::argb8888,
+                         Compression compression = Compression::none,
+                         uint32_t tile_size = default_tile_size());
+
+private:
+
+    /// Decompress the data of a tile.
+    bool inflate(const unsigned char* in, size_t len, unsigned char* out, size_t out_len) const;
+
+    const unsigned char* m_buf{nullptr};
+    size_t m_len{0};
+    std::vector<unsigned char> m_storage;
+    std::vector<uint8_t> m_decoded;
+    int32_t m_x{0};
+    int32_t m_y{0};
+    uint32_t m_width{0};
+    uint32_t m_height{0};
+    uint32_t m_tile_size{0};
+    uint32_t m_tiles_x{0};
+    uint32_t m_tiles_y{0};
+    Format m_format{Format::argb8888};
+    Compression m_compression{Compression::none};
+};
+
+}
+}
+}
+
+#endif
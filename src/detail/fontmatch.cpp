@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_FONTCONFIG
+
+#include "detail/egtlog.h"
+#include "detail/fmt.h"
+#include "detail/fontmatch.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+static constexpr auto FONT_MATCH_CACHE_VERSION = "egt-fontmatch 1";
+
+static std::string font_match_cache_path()
+{
+    if (const auto path = std::getenv("EGT_FONT_CACHE"))
+        return path;
+
+    if (const auto cache = std::getenv("XDG_CACHE_HOME"))
+    {
+        if (*cache)
+            return std::string(cache) + "/egt/fontmatch";
+    }
+
+    if (const auto home = std::getenv("HOME"))
+    {
+        if (*home)
+            return std::string(home) + "/.cache/egt/fontmatch";
+    }
+
+    return {};
+}
+
+FontMatchCache& FontMatchCache::instance()
+{
+    static FontMatchCache cache;
+    return cache;
+}
+
+FontMatchCache::FontMatchCache()
+    : m_path(font_match_cache_path())
+{
+    load();
+}
+
+FontMatchCache::~FontMatchCache()
+{
+    wait();
+    flush();
+}
+
+std::string FontMatchCache::key(const Font& font, const cairo_font_options_t* options)
+{
+    return fmt::format("{}|{}|{}|{}|{:x}",
+                       font.face(),
+                       static_cast<int>(font.weight()),
+                       static_cast<int>(font.slant()),
+                       font.size(),
+                       cairo_font_options_hash(options));
+}
+
+bool FontMatchCache::modification_time(const std::string& file, int64_t& mtime)
+{
+    struct stat st {};
+    if (::stat(file.c_str(), &st) < 0)
+        return false;
+
+    mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+bool FontMatchCache::resolve(const Font& font, const cairo_font_options_t* options, Entry& entry)
+{
+    EGTLOG_DEBUG("matching font using Fontconfig: {}", font.face());
+
+    unique_fcpattern pattern(FcPatternCreate(), FcPatternDestroy);
+    if (!pattern)
+        return false;
+
+    // NOLINTNEXTLINE
+    FcPatternAddString(pattern.get(), FC_FAMILY, (const FcChar8*)(font.face().c_str()));
+    FcPatternAddDouble(pattern.get(), FC_SIZE, font.size());
+
+    int weight = FC_WEIGHT_NORMAL;
+    switch (font.weight())
+    {
+    case Font::Weight::normal:
+        break;
+    case Font::Weight::bold:
+        weight = FC_WEIGHT_BOLD;
+        break;
+    }
+    FcPatternAddInteger(pattern.get(), FC_WEIGHT, weight);
+
+    int slant = FC_SLANT_ROMAN;
+    switch (font.slant())
+    {
+    case Font::Slant::normal:
+        break;
+    case Font::Slant::italic:
+        slant = FC_SLANT_ITALIC;
+        break;
+    case Font::Slant::oblique:
+        slant = FC_SLANT_OBLIQUE;
+        break;
+    }
+    FcPatternAddInteger(pattern.get(), FC_SLANT, slant);
+
+    FcConfigSubstitute(nullptr, pattern.get(), FcMatchPattern);
+    cairo_ft_font_options_substitute(options, pattern.get());
+    FcDefaultSubstitute(pattern.get());
+    FcResult result;
+
+    unique_fcpattern resolved(FcFontMatch(nullptr, pattern.get(), &result), FcPatternDestroy);
+    if (!resolved)
+        return false;
+
+    char* face = nullptr;
+    if (FcPatternGetString(resolved.get(), FC_FULLNAME, 0, reinterpret_cast<FcChar8**>(&face)) == FcResultMatch)
+    {
+        if (font.face() != std::string(face))
+            EGTLOG_DEBUG("Font \"{}\" not found: using default {} font", font.face(), face);
+    }
+
+    std::unique_ptr<FcObjectSet, decltype(FcObjectSetDestroy)*>
+    objects(FcObjectSetBuild(FC_FILE, FC_INDEX, FC_PIXEL_SIZE, FC_MATRIX,
+                             FC_ANTIALIAS, FC_HINTING, FC_HINT_STYLE, FC_AUTOHINT,
+                             FC_RGBA, FC_LCD_FILTER, FC_EMBOLDEN, FC_EMBEDDED_BITMAP,
+                             FC_VERTICAL_LAYOUT, nullptr),
+            FcObjectSetDestroy);
+    if (!objects)
+        return false;
+
+    unique_fcpattern filtered(FcPatternFilter(resolved.get(), objects.get()), FcPatternDestroy);
+    if (!filtered)
+        return false;
+
+    char* file = nullptr;
+    if (FcPatternGetString(filtered.get(), FC_FILE, 0, reinterpret_cast<FcChar8**>(&file)) != FcResultMatch)
+        return false;
+
+    std::unique_ptr<FcChar8, decltype(std::free)*> name(FcNameUnparse(filtered.get()), std::free);
+    if (!name)
+        return false;
+
+    entry.pattern = reinterpret_cast<const char*>(name.get());
+    entry.file = file;
+    entry.checked = modification_time(entry.file, entry.mtime);
+
+    return true;
+}
+
+bool FontMatchCache::lookup(const std::string& key, std::string& pattern)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto i = m_entries.find(key);
+    if (i == m_entries.end())
+        return false;
+
+    if (!i->second.checked)
+    {
+        int64_t mtime = 0;
+        if (!modification_time(i->second.file, mtime) || mtime != i->second.mtime)
+        {
+            EGTLOG_DEBUG("font file changed: {}", i->second.file);
+            m_entries.erase(i);
+            return false;
+        }
+
+        i->second.checked = true;
+    }
+
+    pattern = i->second.pattern;
+    return true;
+}
+
+unique_fcpattern FontMatchCache::match(const Font& font, const cairo_font_options_t* options)
+{
+    const auto k = key(font, options);
+
+    std::string pattern;
+    if (!lookup(k, pattern))
+    {
+        Entry entry;
+        if (!resolve(font, options, entry))
+            return {nullptr, FcPatternDestroy};
+
+        pattern = entry.pattern;
+
+        // saved later, not to write the file from the main thread
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries[k] = std::move(entry);
+        m_dirty = true;
+    }
+
+    /*
+     * The match is always parsed back from its text, so a font is the same
+     * whether it comes from the file or straight from Fontconfig.
+     */
+    // NOLINTNEXTLINE
+    return {FcNameParse((const FcChar8*)(pattern.c_str())), FcPatternDestroy};
+}
+
+void FontMatchCache::preload(const std::vector<Font>& fonts, const cairo_font_options_t* options)
+{
+    wait();
+
+    std::vector<Font> copies;
+    copies.reserve(fonts.size());
+    for (const auto& font : fonts)
+        copies.emplace_back(font.face(), font.size(), font.weight(), font.slant());
+
+    std::shared_ptr<cairo_font_options_t> copy(cairo_font_options_copy(options),
+            cairo_font_options_destroy);
+
+    m_preload = std::thread([this, copies = std::move(copies), copy]()
+    {
+        for (const auto& font : copies)
+        {
+            const auto k = key(font, copy.get());
+
+            std::string pattern;
+            if (lookup(k, pattern))
+                continue;
+
+            Entry entry;
+            if (!resolve(font, copy.get(), entry))
+                continue;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries[k] = std::move(entry);
+            m_dirty = true;
+        }
+
+        // also saves the matches found by match() in the meantime
+        flush();
+    });
+}
+
+void FontMatchCache::wait()
+{
+    if (m_preload.joinable())
+        m_preload.join();
+}
+
+void FontMatchCache::flush()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_dirty)
+            return;
+        m_dirty = false;
+    }
+
+    save();
+}
+
+void FontMatchCache::load()
+{
+    if (m_path.empty())
+        return;
+
+    std::ifstream in(m_path);
+    std::string line;
+    if (!std::getline(in, line) || line != FONT_MATCH_CACHE_VERSION)
+        return;
+
+    // key, modification time, file, and pattern separated by tabs
+    while (std::getline(in, line))
+    {
+        const auto a = line.find('\t');
+        const auto b = line.find('\t', a + 1);
+        const auto c = line.find('\t', b + 1);
+        if (a == std::string::npos || b == std::string::npos || c == std::string::npos)
+            continue;
+
+        Entry entry;
+        entry.mtime = std::strtoll(line.c_str() + a + 1, nullptr, 10);
+        entry.file = line.substr(b + 1, c - b - 1);
+        entry.pattern = line.substr(c + 1);
+        m_entries[line.substr(0, a)] = std::move(entry);
+    }
+
+    EGTLOG_DEBUG("loaded {} font matches from {}", m_entries.size(), m_path);
+}
+
+void FontMatchCache::save()
+{
+    if (m_path.empty())
+        return;
+
+    std::string content = FONT_MATCH_CACHE_VERSION;
+    content += '\n';
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& [key, entry] : m_entries)
+        {
+            const auto line = fmt::format("{}\t{}\t{}\t{}", key, entry.mtime, entry.file, entry.pattern);
+            if (std::count(line.begin(), line.end(), '\t') != 3 ||
+                line.find('\n') != std::string::npos)
+                continue;
+
+            content += line;
+            content += '\n';
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_save_mutex);
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(m_path).parent_path(), ec);
+
+    /*
+     * Write a new file and rename it, so that another application reading
+     * the file never sees it half written.
+     */
+    const auto tmp = fmt::format("{}.{}", m_path, ::getpid());
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << content;
+        if (!out)
+        {
+            EGTLOG_DEBUG("unable to write font matches to {}", tmp);
+            std::remove(tmp.c_str());
+            return;
+        }
+    }
+
+    if (std::rename(tmp.c_str(), m_path.c_str()) < 0)
+        std::remove(tmp.c_str());
+}
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef EGT_SRC_DETAIL_FONTMATCH_H
+#define EGT_SRC_DETAIL_FONTMATCH_H
+
+#include "egt/font.h"
+#include <cairo-ft.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+using unique_fcpattern = std::unique_ptr<FcPattern, decltype(FcPatternDestroy)*>;
+
+/**
+ * Fontconfig matches of fonts, saved to a file so that later runs do not need
+ * Fontconfig for the same fonts.
+ *
+ * Only what is needed to create a font face is kept from a match: the file,
+ * the face index, the pixel size, and the rendering options. A match is
+ * dropped when the modification time of its file changes.
+ *
+ * The file is EGT_FONT_CACHE, or egt/fontmatch in XDG_CACHE_HOME or in
+ * ~/.cache. An empty EGT_FONT_CACHE only keeps the matches in memory.
+ *
+ * match() does not write the file, so that the main thread never waits for
+ * it. New matches are saved at the end of preload(), by
+ * Font::shutdown_fonts(), or at exit.
+ */
+class FontMatchCache
+{
+public:
+
+    /// Get the cache, loaded from its file the first time.
+    static FontMatchCache& instance();
+
+    FontMatchCache(const FontMatchCache&) = delete;
+    FontMatchCache& operator=(const FontMatchCache&) = delete;
+
+    /**
+     * Get the pattern of the font face matching a font.
+     *
+     * @param[in] font The font.
+     * @param[in] options Font options of the context the font is created for.
+     * @return nullptr if Fontconfig finds no match.
+     */
+    unique_fcpattern match(const Font& font, const cairo_font_options_t* options);
+
+    /**
+     * Match fonts in a background thread, and save them to the file.
+     *
+     * Waits for a previous call to be done first.
+     */
+    void preload(const std::vector<Font>& fonts, const cairo_font_options_t* options);
+
+    /// Wait for the background thread started by preload().
+    void wait();
+
+    /// Save the matches to the file, if matches were added since it was saved.
+    void flush();
+
+    ~FontMatchCache();
+
+protected:
+
+    FontMatchCache();
+
+    struct Entry
+    {
+        /// Pattern unparsed by Fontconfig.
+        std::string pattern;
+        /// File of the face and its modification time in nanoseconds.
+        std::string file;
+        int64_t mtime{0};
+        /// The modification time of the file has been checked.
+        bool checked{false};
+    };
+
+    static std::string key(const Font& font, const cairo_font_options_t* options);
+    static bool resolve(const Font& font, const cairo_font_options_t* options, Entry& entry);
+    static bool modification_time(const std::string& file, int64_t& mtime);
+
+    bool lookup(const std::string& key, std::string& pattern);
+    void load();
+    void save();
+
+    std::mutex m_mutex;
+    std::mutex m_save_mutex;
+    std::map<std::string, Entry> m_entries;
+    /// Matches were added since the file was saved.
+    bool m_dirty{false};
+    std::string m_path;
+    std::thread m_preload;
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "detail/glyphatlas.h"
+#include "egt/painter.h"
+#include "egt/text.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <vector>
+
+#ifdef HAVE_SIMD
+#include "Simd/SimdLib.hpp"
+#endif
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+static TextRenderer renderer_from_env()
+{
+    if (std::getenv("EGT_GLYPH_ATLAS"))
+        return TextRenderer::glyph_atlas;
+    return TextRenderer::cairo;
+}
+
+static TextRenderer& current_renderer()
+{
+    static TextRenderer renderer = renderer_from_env();
+    return renderer;
+}
+
+void text_renderer(TextRenderer renderer)
+{
+    current_renderer() = renderer;
+}
+
+TextRenderer text_renderer()
+{
+    return current_renderer();
+}
+
+GlyphAtlas::GlyphAtlas(cairo_scaled_font_t* font)
+    : m_font(cairo_scaled_font_reference(font))
+{}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    cairo_scaled_font_destroy(m_font);
+}
+
+const GlyphAtlas::Cell* GlyphAtlas::cell(unsigned long index, unsigned position)
+{
+    const auto key = (static_cast<uint64_t>(index) << 8) | position;
+    const auto i = m_cells.find(key);
+    if (i != m_cells.end())
+        return &i->second;
+
+    Cell cell;
+    if (!rasterize(index, position, cell))
+        return nullptr;
+
+    return &m_cells.emplace(key, cell).first->second;
+}
+
+bool GlyphAtlas::rasterize(unsigned long index, unsigned position, Cell& cell)
+{
+    cairo_glyph_t glyph{index, 0, 0};
+    cairo_text_extents_t te;
+    cairo_scaled_font_glyph_extents(m_font, &glyph, 1, &te);
+
+    if (te.width <= 0 || te.height <= 0)
+        return true;
+
+    const auto shift = static_cast<double>(position) / subpixel_positions();
+
+    // one pixel of margin for antialiasing
+    const auto left = static_cast<DefaultDim>(std::floor(te.x_bearing + shift)) - 1;
+    const auto top = static_cast<DefaultDim>(std::floor(te.y_bearing)) - 1;
+    const auto width = static_cast<DefaultDim>(std::ceil(te.x_bearing + shift + te.width)) - left + 1;
+    const auto height = static_cast<DefaultDim>(std::ceil(te.y_bearing + te.height)) - top + 1;
+
+    if (width > page_size() || height > page_size())
+        return false;
+
+    if (m_x + width > page_size())
+    {
+        m_x = 0;
+        m_y += m_row_height;
+        m_row_height = 0;
+    }
+
+    if (m_pages.empty() || m_y + height > page_size())
+    {
+        m_pages.emplace_back(Size(page_size(), page_size()), PixelFormat::a8);
+        m_pages.back().zero();
+        m_x = 0;
+        m_y = 0;
+        m_row_height = 0;
+    }
+
+    cell.page = m_pages.size() - 1;
+    cell.x = m_x;
+    cell.y = m_y;
+    cell.width = width;
+    cell.height = height;
+    cell.left = left;
+    cell.top = top;
+
+    auto& page = m_pages.back();
+    unique_cairo_t cr(cairo_create(page.impl()));
+    cairo_set_scaled_font(cr.get(), m_font);
+    glyph.x = cell.x - left + shift;
+    glyph.y = cell.y - top;
+    cairo_show_glyphs(cr.get(), &glyph, 1);
+    cr.reset();
+    page.flush(true);
+
+    m_x += width;
+    m_row_height = std::max(m_row_height, height);
+
+    return true;
+}
+
+/*
+ * Atlases of the most recently used fonts, most recent first.
+ */
+static GlyphAtlas& atlas(cairo_scaled_font_t* font)
+{
+    using AtlasList = std::list<std::pair<cairo_scaled_font_t*, std::unique_ptr<GlyphAtlas>>>;
+    static AtlasList atlases;
+
+    auto i = std::find_if(atlases.begin(), atlases.end(),
+                          [font](const AtlasList::value_type & item)
+    {
+        return item.first == font;
+    });
+
+    if (i != atlases.end())
+    {
+        atlases.splice(atlases.begin(), atlases, i);
+    }
+    else
+    {
+        atlases.emplace_front(font, std::make_unique<GlyphAtlas>(font));
+
+        static constexpr auto MAX_ATLASES = 8;
+        while (atlases.size() > MAX_ATLASES)
+            atlases.pop_back();
+    }
+
+    return *atlases.front().second;
+}
+
+/*
+ * Blend a solid color into premultiplied 32 bit pixels through an 8 bit mask,
+ * two channels at a time in 16 bit lanes of a 32 bit word.
+ */
+static inline uint32_t blend(uint32_t dst, uint32_t color, uint32_t alpha)
+{
+    const uint32_t inv = 255 - alpha;
+    uint32_t rb = (color & 0x00ff00ff) * alpha + (dst & 0x00ff00ff) * inv;
+    uint32_t ag = ((color >> 8) & 0x00ff00ff) * alpha + ((dst >> 8) & 0x00ff00ff) * inv;
+    rb = ((rb + 0x00800080 + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+    ag = ((ag + 0x00800080 + ((ag >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+    return rb | (ag << 8);
+}
+
+static void blend_mask(unsigned char* dst, size_t dst_stride,
+                       const unsigned char* mask, size_t mask_stride,
+                       size_t width, size_t height,
+                       uint32_t color, uint32_t alpha)
+{
+#ifdef HAVE_SIMD
+    if (alpha == 255)
+    {
+        const uint32_t channels = color;
+        SimdAlphaFilling(dst, dst_stride, width, height,
+                         reinterpret_cast<const uint8_t*>(&channels), 4,
+                         mask, mask_stride);
+        return;
+    }
+#endif
+
+    for (size_t y = 0; y < height; ++y)
+    {
+        auto out = reinterpret_cast<uint32_t*>(dst + y * dst_stride);
+        const auto m = mask + y * mask_stride;
+        for (size_t x = 0; x < width; ++x)
+        {
+            if (!m[x])
+                continue;
+
+            const uint32_t a = alpha == 255 ? m[x] : (m[x] * alpha + 127) / 255;
+            out[x] = a == 255 ? color : blend(out[x], color, a);
+        }
+    }
+}
+
+static inline bool integral(double value)
+{
+    return std::floor(value) == value;
+}
+
+/*
+ * Temporary buffers of draw_atlas_glyphs(), kept from one draw to the next so
+ * drawing text does not allocate once they are large enough.
+ */
+struct AtlasScratch
+{
+    std::vector<Rect> clips;
+    std::vector<const GlyphAtlas::Cell*> cells;
+    std::vector<Point> origins;
+};
+
+static AtlasScratch atlas_scratch;
+
+bool draw_atlas_glyphs(Painter& painter,
+                       const cairo_glyph_t* glyphs,
+                       size_t count,
+                       const Pattern& color)
+{
+    if (color.type() != Pattern::Type::solid)
+        return false;
+
+    cairo_t* cr = painter.context();
+    if (cairo_get_operator(cr) != CAIRO_OPERATOR_OVER)
+        return false;
+
+    cairo_matrix_t matrix;
+    cairo_get_matrix(cr, &matrix);
+    if (matrix.xx != 1. || matrix.yy != 1. || matrix.xy != 0. || matrix.yx != 0. ||
+        !integral(matrix.x0) || !integral(matrix.y0))
+        return false;
+
+    auto target = cairo_get_target(cr);
+    if (cairo_get_group_target(cr) != target ||
+        cairo_surface_get_type(target) != CAIRO_SURFACE_TYPE_IMAGE)
+        return false;
+
+    const auto format = cairo_image_surface_get_format(target);
+    if (format != CAIRO_FORMAT_ARGB32 && format != CAIRO_FORMAT_RGB24)
+        return false;
+
+    double device_x = 0;
+    double device_y = 0;
+    cairo_surface_get_device_offset(target, &device_x, &device_y);
+    if (!integral(device_x) || !integral(device_y))
+        return false;
+
+    std::unique_ptr<cairo_rectangle_list_t, decltype(&cairo_rectangle_list_destroy)>
+    clip(cairo_copy_clip_rectangle_list(cr), cairo_rectangle_list_destroy);
+    if (clip->status != CAIRO_STATUS_SUCCESS)
+        return false;
+
+    /*
+     * Clip rectangles in surface pixels. Unaligned clips are antialiased by
+     * cairo, which the atlas does not reproduce.
+     */
+    const auto offset = Point(matrix.x0 + device_x, matrix.y0 + device_y);
+    const Rect bounds(0, 0,
+                      cairo_image_surface_get_width(target),
+                      cairo_image_surface_get_height(target));
+    auto& clips = atlas_scratch.clips;
+    clips.clear();
+    for (int i = 0; i < clip->num_rectangles; ++i)
+    {
+        const auto& r = clip->rectangles[i];
+        if (!integral(r.x) || !integral(r.y) || !integral(r.width) || !integral(r.height))
+            return false;
+
+        auto rect = Rect::intersection(Rect(r.x, r.y, r.width, r.height) + offset, bounds);
+        if (!rect.empty())
+            clips.push_back(rect);
+    }
+
+    if (clips.empty())
+        return true;
+
+    /*
+     * Rasterize missing glyphs first, so nothing is drawn if one of them
+     * cannot be handled.
+     */
+    auto& glyph_atlas = atlas(cairo_get_scaled_font(cr));
+    auto& cells = atlas_scratch.cells;
+    auto& origins = atlas_scratch.origins;
+    cells.resize(count);
+    origins.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        // x in whole pixels and a subpixel position, y in whole pixels
+        const auto x = std::lround(glyphs[i].x * GlyphAtlas::subpixel_positions());
+        const auto positions = static_cast<long>(GlyphAtlas::subpixel_positions());
+        auto pixel_x = x / positions;
+        auto position = x % positions;
+        if (position < 0)
+        {
+            pixel_x -= 1;
+            position += positions;
+        }
+
+        cells[i] = glyph_atlas.cell(glyphs[i].index, static_cast<unsigned>(position));
+        if (!cells[i])
+            return false;
+        origins[i] = offset + Point(pixel_x, std::lround(glyphs[i].y));
+    }
+
+    const auto c = color.solid();
+    const uint32_t pixel = 0xff000000 | (c.red() << 16) | (c.green() << 8) | c.blue();
+
+    cairo_surface_flush(target);
+    auto data = cairo_image_surface_get_data(target);
+    const size_t stride = cairo_image_surface_get_stride(target);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& cell = *cells[i];
+        if (!cell.width)
+            continue;
+
+        const auto& page = glyph_atlas.page(cell.page);
+        const auto& origin = origins[i];
+        const Rect dest(origin.x() + cell.left, origin.y() + cell.top, cell.width, cell.height);
+
+        for (const auto& clip_rect : clips)
+        {
+            const auto rect = Rect::intersection(dest, clip_rect);
+            if (rect.empty())
+                continue;
+
+            const auto mask = static_cast<const unsigned char*>(page.data()) +
+                              (cell.y + rect.y() - dest.y()) * page.stride() +
+                              (cell.x + rect.x() - dest.x());
+
+            blend_mask(data + rect.y() * stride + rect.x() * sizeof(uint32_t), stride,
+                       mask, page.stride(),
+                       rect.width(), rect.height(),
+                       pixel, c.alpha());
+        }
+    }
+
+    cairo_surface_mark_dirty(target);
+
+    return true;
+}
+
+}
+}
+}
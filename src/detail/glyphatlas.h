@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef EGT_SRC_DETAIL_GLYPHATLAS_H
+#define EGT_SRC_DETAIL_GLYPHATLAS_H
+
+#include "detail/cairoabstraction.h"
+#include <egt/geometry.h>
+#include <egt/pattern.h>
+#include <egt/surface.h>
+#include <unordered_map>
+#include <vector>
+
+namespace egt
+{
+inline namespace v1
+{
+class Painter;
+
+namespace detail
+{
+
+/**
+ * Glyphs of a scaled font rasterized once into A8 pages.
+ *
+ * Each glyph is rasterized at a few horizontal subpixel positions, so text
+ * keeps the spacing cairo gives it. Vertical positions are rounded to whole
+ * pixels, like the baselines text is laid out on.
+ *
+ * Glyphs are packed in rows, and a new page is started when the current one
+ * is full.
+ */
+class GlyphAtlas
+{
+public:
+
+    /// Location of a rasterized glyph.
+    struct Cell
+    {
+        /// Page holding the glyph.
+        uint16_t page{0};
+        /// Position of the glyph in the page.
+        uint16_t x{0};
+        uint16_t y{0};
+        /// Size of the glyph, empty for glyphs that draw nothing.
+        uint16_t width{0};
+        uint16_t height{0};
+        /// Offset of the top left corner of the cell from the glyph origin.
+        int16_t left{0};
+        int16_t top{0};
+    };
+
+    /// Number of horizontal positions a glyph is rasterized at within a pixel.
+    static constexpr unsigned subpixel_positions()
+    {
+        return 4;
+    }
+
+    /// Width and height of a page in pixels.
+    static constexpr DefaultDim page_size()
+    {
+        return 256;
+    }
+
+    explicit GlyphAtlas(cairo_scaled_font_t* font);
+
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+    ~GlyphAtlas();
+
+    /**
+     * Get the cell of a glyph, rasterizing it the first time.
+     *
+     * @param index Index of the glyph in the font.
+     * @param position Horizontal offset of the glyph origin, in units of
+     *        1 / subpixel_positions() of a pixel.
+     *
+     * @return nullptr if the glyph does not fit in a page.
+     */
+    const Cell* cell(unsigned long index, unsigned position = 0);
+
+    /// Get a page.
+    const Surface& page(size_t n) const { return m_pages[n]; }
+
+protected:
+
+    bool rasterize(unsigned long index, unsigned position, Cell& cell);
+
+    cairo_scaled_font_t* m_font;
+    std::vector<Surface> m_pages;
+    /// Cells by glyph index and subpixel position.
+    std::unordered_map<uint64_t, Cell> m_cells;
+    DefaultDim m_x{0};
+    DefaultDim m_y{0};
+    DefaultDim m_row_height{0};
+};
+
+/**
+ * Draw glyphs with the current scaled font of the painter by blending
+ * rasterized glyphs from an atlas straight into the target surface.
+ *
+ * Only a solid color, the default operator, a translation and a rectangular
+ * clip are supported.
+ *
+ * @param painter Painter to draw with.
+ * @param glyphs Glyphs to draw, in user space.
+ * @param count Number of glyphs.
+ * @param color Color of the text.
+ *
+ * @return false if nothing was drawn because the painter state is not
+ * supported, the caller then has to draw the glyphs with cairo.
+ */
+bool draw_atlas_glyphs(Painter& painter,
+                       const cairo_glyph_t* glyphs,
+                       size_t count,
+                       const Pattern& color);
+
+}
+}
+}
+
+#endif
@@ -10,11 +10,17 @@
 #include "detail/cairoabstraction.h"
 #include "detail/egtlog.h"
 #include "detail/eraw.h"
+#include "detail/erawtiled.h"
+#include "detail/mappedfile.h"
+#include "detail/mipmap.h"
 #include "egt/app.h"
 #include "egt/detail/filesystem.h"
 #include "egt/detail/image.h"
+#include "egt/detail/imagecache.h"
 #include "egt/resource.h"
+#include "egt/respath.h"
 #include "images/bmp/cairo_bmp.h"
+#include <algorithm>
 #include <fstream>
 #include <vector>
 
@@ -84,32 +90,76 @@ static constexpr auto MIME_ZIP = "application/zip";
 static constexpr auto MIME_GZIP = "application/gzip";
 static constexpr auto MIME_ERAW = "image/eraw";
 
-static Surface scale_cairo_surface(cairo_surface_t* surface, float hscale, float vscale)
+/*
+ * Size of an image of the given size once scaled, rounded up.
+ */
+static Size scaled_size(const Size& size, float hscale, float vscale)
 {
-    Size src_size(cairo_image_surface_get_width(surface),
-                  cairo_image_surface_get_height(surface));
-    Size size = src_size;
-    auto format = detail::egt_format(cairo_image_surface_get_format(surface));
+    Size result = size;
 
-    bool scaled = false;
     if (egt_unlikely(!detail::float_equal(hscale, 1.0f)))
-    {
-        size.width(std::ceil(hscale * size.width()));
-        scaled = true;
-    }
+        result.width(std::ceil(hscale * size.width()));
 
     if (egt_unlikely(!detail::float_equal(vscale, 1.0f)))
-    {
-        size.height(std::ceil(vscale * size.height()));
-        scaled = true;
-    }
+        result.height(std::ceil(vscale * size.height()));
+
+    return result;
+}
 
-    Surface image(size, format);
+/*
+ * Take over the pixels of a decoded cairo image surface, without any copy,
+ * when they can be used as is.
+ *
+ * With libm2d, surfaces are allocated from GPU memory so the pixels are
+ * copied instead.
+ */
+static bool adopt_cairo_surface(unique_cairo_surface_t& surface, Surface& image)
+{
+#ifdef HAVE_LIBM2D
+    detail::ignoreparam(surface);
+    detail::ignoreparam(image);
+    return false;
+#else
+    const Size size(cairo_image_surface_get_width(surface.get()),
+                    cairo_image_surface_get_height(surface.get()));
+    const auto format = detail::egt_format(cairo_image_surface_get_format(surface.get()));
+    const DefaultDim stride = cairo_image_surface_get_stride(surface.get());
+
+    if (format != PixelFormat::argb8888 && format != PixelFormat::xrgb8888)
+        return false;
+
+    if (stride != Surface::stride(format, size.width()))
+        return false;
+
+    cairo_surface_flush(surface.get());
+    auto data = cairo_image_surface_get_data(surface.get());
+    auto owner = surface.release();
+    image = Surface(data, [owner](void*) { cairo_surface_destroy(owner); },
+                    size, format, stride);
+    return true;
+#endif
+}
+
+static Surface scale_cairo_surface(unique_cairo_surface_t surface, const Size& size)
+{
+    if (cairo_surface_status(surface.get()) != CAIRO_STATUS_SUCCESS)
+        return {};
+
+    Size src_size(cairo_image_surface_get_width(surface.get()),
+                  cairo_image_surface_get_height(surface.get()));
+    auto format = detail::egt_format(cairo_image_surface_get_format(surface.get()));
+    const bool scaled = size != src_size;
+
+    Surface image;
+    if (!scaled && adopt_cairo_surface(surface, image))
+        return image;
+
+    image = Surface(size, format);
     image.sync_for_cpu();
 
-    const uint8_t* src = cairo_image_surface_get_data(surface);
+    const uint8_t* src = cairo_image_surface_get_data(surface.get());
     uint8_t* dst = static_cast<uint8_t*>(image.data());
-    DefaultDim src_stride = cairo_image_surface_get_stride(surface);
+    DefaultDim src_stride = cairo_image_surface_get_stride(surface.get());
     DefaultDim dst_stride = image.stride();
 
     if (egt_unlikely(scaled))
@@ -128,7 +178,7 @@ static Surface scale_cairo_surface(cairo_surface_t* surface, float hscale, float
                     static_cast<double>(size.width()) / src_size.width(), /* more accurate than `hscale` */
                     static_cast<double>(size.height()) / src_size.height()); /* more accurate than `vscale` */
 
-        cairo_set_source_surface(cr.get(), surface, 0, 0);
+        cairo_set_source_surface(cr.get(), surface.get(), 0, 0);
 
         /* To avoid getting the edge pixels blended with 0 alpha, which would
          * occur with the default EXTEND_NONE.
@@ -160,28 +210,58 @@ static Surface scale_cairo_surface(cairo_surface_t* surface, float hscale, float
     return image;
 }
 
-EGT_API Surface load_image_from_memory(const unsigned char* data,
-                                       size_t len,
-                                       const std::string& name,
-                                       float hscale, float vscale)
+static Surface scale_cairo_surface(unique_cairo_surface_t surface, float hscale, float vscale)
 {
-    if (!data || !len)
-        return {};
+    Size size(cairo_image_surface_get_width(surface.get()),
+              cairo_image_surface_get_height(surface.get()));
+    return scale_cairo_surface(std::move(surface), scaled_size(size, hscale, vscale));
+}
 
-    Surface image;
+#ifdef HAVE_LIBJPEG
+/*
+ * Largest libjpeg DCT scaling denominator out of 1, 2, 4 and 8 whose scale is
+ * not smaller than the requested one, so the decoded image only has to be
+ * downscaled further, never upscaled.
+ */
+static unsigned int jpeg_scale_denom(float hscale, float vscale)
+{
+    const auto scale = std::max(hscale, vscale);
+    unsigned int denom = 8;
+    while (denom > 1 && scale * denom > 1.0f)
+        denom /= 2;
+    return denom;
+}
+
+/*
+ * libjpeg can decode at 1/2, 1/4 or 1/8 of the full size for almost free, so
+ * the scale is handed to the decoder and only the remainder is resampled.
+ * The result has the same size as if the full image had been scaled.
+ */
+static Surface scale_jpeg_surface(unique_cairo_surface_t surface, int width, int height,
+                                  float hscale, float vscale)
+{
+    return scale_cairo_surface(std::move(surface),
+                               scaled_size(Size(width, height), hscale, vscale));
+}
+#endif
 
-    const auto mimetype = get_mime_type(data, len);
+static Surface load_image(const unsigned char* data, size_t len,
+                          const std::string& name, const std::string& mimetype,
+                          float hscale, float vscale)
+{
     if (mimetype.empty())
         throw std::runtime_error("unable to determine mimetype for: " + name);
 
     EGTLOG_DEBUG("mimetype of {} is {}", name, mimetype);
 
+    Surface image;
+
     if (mimetype == MIME_BMP)
     {
         StreamObject stream = {data, len, 0};
         unique_cairo_surface_t surface(
             cairo_image_surface_create_from_bmp_stream(read_stream, &stream));
-        image = scale_cairo_surface(surface.get(), hscale, vscale);
+        image = scale_cairo_surface(std::move(surface), hscale, vscale);
     }
     else if (mimetype == MIME_ERAW)
     {
@@ -190,10 +270,12 @@ EGT_API Surface load_image_from_memory(const unsigned char* data,
 #ifdef HAVE_LIBJPEG
     else if (mimetype == MIME_JPEG)
     {
-        StreamObject stream = {data, len, 0};
+        int width = 0;
+        int height = 0;
         unique_cairo_surface_t surface(
-            cairo_image_surface_create_from_jpeg_stream(read_stream, &stream));
-        image = scale_cairo_surface(surface.get(), hscale, vscale);
+            cairo_image_surface_create_from_jpeg_buffer(data, len,
+                    jpeg_scale_denom(hscale, vscale), &width, &height));
+        image = scale_jpeg_surface(std::move(surface), width, height, hscale, vscale);
     }
 #endif
 #if CAIRO_HAS_PNG_FUNCTIONS == 1
@@ -202,7 +284,7 @@ EGT_API Surface load_image_from_memory(const unsigned char* data,
         StreamObject stream = {data, len, 0};
         unique_cairo_surface_t surface(
             cairo_image_surface_create_from_png_stream(read_stream, &stream));
-        image = scale_cairo_surface(surface.get(), hscale, vscale);
+        image = scale_cairo_surface(std::move(surface), hscale, vscale);
     }
 #endif
 #ifdef HAVE_LIBRSVG
@@ -219,6 +301,60 @@ EGT_API Surface load_image_from_memory(const unsigned char* data,
     return image;
 }
 
+EGT_API Surface load_image_from_memory(const unsigned char* data,
+                                       size_t len,
+                                       const std::string& name,
+                                       float hscale, float vscale)
+{
+    if (!data || !len)
+        return {};
+
+    return load_image(data, len, name, get_mime_type(data, len), hscale, vscale);
+}
+
+Surface load_mip_level(const unsigned char* data, size_t len, const std::string& name,
+                       size_t& level, Size& size)
+{
+    Surface image;
+    size_t decoded = 0;
+
+#ifdef HAVE_LIBJPEG
+    if (get_mime_type(data, len) == MIME_JPEG)
+    {
+        // libjpeg reduces by up to 8, with the same rounding as box_reduce()
+        decoded = std::min<size_t>(level, 3);
+        int width = 0;
+        int height = 0;
+        unique_cairo_surface_t surface(
+            cairo_image_surface_create_from_jpeg_buffer(data, len, 1U << decoded,
+                    &width, &height));
+        if (cairo_surface_status(surface.get()) != CAIRO_STATUS_SUCCESS)
+            throw std::runtime_error("unable to decode image: " + name);
+
+        size = Size(width, height);
+        const Size reduced(cairo_image_surface_get_width(surface.get()),
+                           cairo_image_surface_get_height(surface.get()));
+        image = scale_cairo_surface(std::move(surface), reduced);
+    }
+#endif
+
+    if (image.empty())
+    {
+        image = load_image_from_memory(data, len, name);
+        size = image.size();
+    }
+
+    while (decoded < level && MipChain::supported(image) &&
+           (image.width() > 1 || image.height() > 1))
+    {
+        image = box_reduce(image);
+        decoded++;
+    }
+
+    level = decoded;
+    return image;
+}
+
 Surface load_image_from_resource(const std::string& name,
                                  float hscale, float vscale)
 {
@@ -239,51 +375,29 @@ Surface load_image_from_filesystem(const std::string& path,
     if (!detail::exists(path))
         throw std::runtime_error("file not found: " + path);
 
-    const auto mimetype = get_mime_type(path);
-    if (mimetype.empty())
+    /*
+     * The file is opened once: the mime type is detected from the same
+     * mapping the image is then decoded from.
+     */
+    const MappedFile file(path);
+    if (!file.size())
         throw std::runtime_error("unable to determine mimetype for: " + path);
-    EGTLOG_DEBUG("mimetype of {} is {}", path, mimetype);
 
-    Surface image;
+    const auto mimetype = get_mime_type(file.data(), file.size());
 
-    if (mimetype == MIME_BMP)
-    {
-        unique_cairo_surface_t surface(
-            cairo_image_surface_create_from_bmp(path.c_str()));
-        image = scale_cairo_surface(surface.get(), hscale, vscale);
-    }
-    else if (mimetype == MIME_ERAW)
-    {
-        image = load_eraw(path);
-    }
-#ifdef HAVE_LIBJPEG
-    else if (mimetype == MIME_JPEG)
-    {
-        unique_cairo_surface_t surface(
-            cairo_image_surface_create_from_jpeg(path.c_str()));
-        image = scale_cairo_surface(surface.get(), hscale, vscale);
-    }
-#endif
-#if CAIRO_HAS_PNG_FUNCTIONS == 1
-    else if (mimetype == MIME_PNG)
-    {
-        unique_cairo_surface_t surface(
-            cairo_image_surface_create_from_png(path.c_str()));
-        image = scale_cairo_surface(surface.get(), hscale, vscale);
-    }
-#endif
 #ifdef HAVE_LIBRSVG
-    else if (mimetype == MIME_SVGXML || mimetype == MIME_SVG)
+    /*
+     * SVG images are loaded from their path, which is the base of the
+     * relative references they contain.
+     */
+    if (mimetype == MIME_SVGXML || mimetype == MIME_SVG)
     {
-        image = load_svg(path, hscale, vscale);
+        EGTLOG_DEBUG("mimetype of {} is {}", path, mimetype);
+        return load_svg(path, hscale, vscale);
     }
 #endif
-    else
-    {
-        throw std::runtime_error("unsupported image mimetype " + mimetype + " for: " + path);
-    }
 
-    return image;
+    return load_image(file.data(), file.size(), path, mimetype, hscale, vscale);
 }
 
 EGT_API Surface load_image_from_network(const std::string& url,
@@ -398,6 +512,7 @@ private:
         case 0x504B0304:
             return MIME_ZIP;
         case 0xA22A5050:
+        case 0xA32A5050:
             return MIME_ERAW;
         default:
             break;
@@ -468,6 +583,80 @@ std::string get_mime_type(const std::string& path)
     return result;
 }
 
+TiledImage::TiledImage(const std::string& uri)
+{
+    std::string path;
+    const auto type = resolve_path(uri, path);
+
+    auto eraw = std::make_unique<ErawTiledImage>();
+    auto tiled = false;
+    if (type == SchemeType::resource)
+    {
+        auto& resources = ResourceManager::instance();
+        if (resources.exists(path.c_str()))
+            tiled = eraw->open(resources.data(path.c_str()), resources.size(path.c_str()));
+    }
+    else if (type == SchemeType::filesystem)
+    {
+        tiled = eraw->open(path);
+    }
+
+    if (tiled)
+    {
+        m_surface = std::make_shared<Surface>(eraw->create_surface());
+        m_surface->zero();
+        m_eraw = std::move(eraw);
+        return;
+    }
+
+    // other images are decoded at once
+    m_surface = image_cache().get(uri, 1.0, 1.0, false);
+}
+
+TiledImage::TiledImage(TiledImage&&) noexcept = default;
+TiledImage& TiledImage::operator=(TiledImage&&) noexcept = default;
+
+Size TiledImage::size() const
+{
+    return m_surface ? m_surface->size() : Size();
+}
+
+size_t TiledImage::decode(const Rect& region)
+{
+    if (!m_eraw)
+        return 0;
+
+    return m_eraw->decode(region, *m_surface);
+}
+
+void TiledImage::save(const std::string& path, const Surface& surface,
+                      PixelFormat format, Compression compression,
+                      uint32_t tile_size)
+{
+    if (surface.format() != PixelFormat::argb8888)
+        throw std::runtime_error("tiled images are saved from argb8888 surfaces: " + path);
+
+    auto eraw_format = ErawTiledImage::Format::argb8888;
+    if (format == PixelFormat::rgb565)
+        eraw_format = ErawTiledImage::Format::rgb565;
+    else if (format != PixelFormat::argb8888)
+        throw std::runtime_error("unsupported pixel format for tiled image: " + path);
+
+    // the image is appended to the file, start with an empty one
+    if (!std::ofstream(path, std::ios_base::binary | std::ios_base::trunc))
+        throw std::runtime_error("unable to create file: " + path);
+
+    surface.sync_for_cpu();
+    if (!ErawTiledImage::save(path, static_cast<const unsigned char*>(surface.data()),
+                              surface.width(), surface.height(), surface.stride(),
+                              eraw_format,
+                              static_cast<ErawTiledImage::Compression>(compression),
+                              tile_size))
+        throw std::runtime_error("unable to save tiled image: " + path);
+}
+
+TiledImage::~TiledImage() noexcept = default;
+
 }
 }
 }
@@ -10,14 +10,15 @@
 #include "detail/cairoabstraction.h"
 #include "detail/dump.h"
 #include "detail/egtlog.h"
+#include "detail/mappedfile.h"
+#include "detail/mipmap.h"
+#include "egt/detail/filesystem.h"
 #include "egt/detail/image.h"
 #include "egt/detail/imagecache.h"
 #include "egt/detail/math.h"
+#include "egt/resource.h"
 #include "egt/respath.h"
-
-#ifdef HAVE_SIMD
-#include "Simd/SimdLib.hpp"
-#endif
+#include <algorithm>
 
 namespace egt
 {
@@ -54,25 +55,31 @@ std::shared_ptr<Surface> ImageCache::get(const std::string& uri,
     EGTLOG_DEBUG("image cache miss {} hscale:{} vscale:{}", uri, hscale, vscale);
 
     std::shared_ptr<Surface> image;
-    std::string path;
-    auto type = detail::resolve_path(uri, path);
+    if (approximate)
+        image = get_scaled(uri, hscale, vscale);
 
-    switch (type)
+    if (!image)
     {
-    case detail::SchemeType::resource:
-        image = std::make_shared<Surface>(detail::load_image_from_resource(path, hscale, vscale));
-        break;
-
-    case detail::SchemeType::filesystem:
-        image = std::make_shared<Surface>(detail::load_image_from_filesystem(path, hscale, vscale));
-        break;
-
-    case detail::SchemeType::network:
-        image = std::make_shared<Surface>(detail::load_image_from_network(path, hscale, vscale));
-        break;
-
-    default:
-        throw std::runtime_error("unsupported uri: " + uri);
+        std::string path;
+        auto type = detail::resolve_path(uri, path);
+
+        switch (type)
+        {
+        case detail::SchemeType::resource:
+            image = std::make_shared<Surface>(detail::load_image_from_resource(path, hscale, vscale));
+            break;
+
+        case detail::SchemeType::filesystem:
+            image = std::make_shared<Surface>(detail::load_image_from_filesystem(path, hscale, vscale));
+            break;
+
+        case detail::SchemeType::network:
+            image = std::make_shared<Surface>(detail::load_image_from_network(path, hscale, vscale));
+            break;
+
+        default:
+            throw std::runtime_error("unsupported uri: " + uri);
+        }
     }
 
     if (!image)
@@ -89,64 +96,126 @@ std::shared_ptr<Surface> ImageCache::get(const std::string& uri,
 void ImageCache::clear()
 {
     m_cache.clear();
+    m_sources.clear();
 }
 
-float ImageCache::round(float v, float fraction)
+void ImageCache::source_budget(size_t bytes)
 {
-    return floorf(v) + floorf((v - floorf(v)) / fraction) * fraction;
+    m_source_budget = bytes;
+    trim_sources();
 }
 
-std::string ImageCache::id(const std::string& name, float hscale, float vscale)
-{
-    return fmt::format("{}-{}-{}", name, hscale * 100, vscale * 100);
-}
-
-#ifdef HAVE_SIMD
-Surface ImageCache::resize(const Surface& surface, const Size& size)
+std::shared_ptr<Surface> ImageCache::get_scaled(const std::string& uri,
+        float hscale, float vscale)
 {
-    Surface new_surface(size, surface.format());
+    if (!m_source_budget ||
+        (detail::float_equal(hscale, 1.0f) && detail::float_equal(vscale, 1.0f)))
+        return nullptr;
 
-    SimdResizeBilinear(static_cast<const uint8_t*>(surface.data()),
-                       surface.width(),
-                       surface.height(),
-                       surface.stride(),
-                       static_cast<uint8_t*>(new_surface.data()),
-                       new_surface.width(),
-                       new_surface.height(),
-                       new_surface.stride(),
-                       4);
+    auto chain = source(uri, MipChain::covering_level(hscale, vscale));
+    if (!chain)
+        return nullptr;
 
-    new_surface.mark_dirty();
-
-    return new_surface;
+    auto image = chain->scaled(hscale, vscale);
+    trim_sources();
+    return image;
 }
-#else
-Surface ImageCache::resize(const Surface& surface, const Size& size)
+
+std::shared_ptr<MipChain> ImageCache::source(const std::string& uri, size_t level)
 {
-    Surface new_surface(size, surface.format());
-    unique_cairo_t cr(cairo_create(new_surface.impl()));
+    auto i = std::find_if(m_sources.begin(), m_sources.end(),
+                          [&uri](const auto & entry) { return entry.first == uri; });
+    if (i != m_sources.end())
+    {
+        if (i->second->first() <= level)
+        {
+            m_sources.splice(m_sources.begin(), m_sources, i);
+            return i->second;
+        }
+
+        // decoded too small for this request, decode it again larger
+        m_sources.erase(i);
+    }
 
-    /* Scale *before* setting the source surface (1) */
-    cairo_scale(cr.get(),
-                static_cast<double>(size.width()) / surface.width(),
-                static_cast<double>(size.height()) / surface.height());
+    /*
+     * Only raster images are kept: vector images are rendered at the
+     * requested scale instead.
+     */
+    std::string path;
+    std::unique_ptr<MappedFile> file;
+    const unsigned char* data = nullptr;
+    size_t len = 0;
+    switch (detail::resolve_path(uri, path))
+    {
+    case detail::SchemeType::resource:
+    {
+        auto& resources = ResourceManager::instance();
+        if (!resources.exists(path.c_str()))
+            return nullptr;
+        data = resources.data(path.c_str());
+        len = resources.size(path.c_str());
+        break;
+    }
+    case detail::SchemeType::filesystem:
+        if (!detail::exists(path))
+            return nullptr;
+        file = std::make_unique<MappedFile>(path);
+        data = file->data();
+        len = file->size();
+        break;
+    default:
+        return nullptr;
+    }
 
-    cairo_set_source_surface(cr.get(), surface.impl(), 0, 0);
+    if (!data || !len || get_mime_type(data, len).find("svg") != std::string::npos)
+        return nullptr;
 
-    /* To avoid getting the edge pixels blended with 0 alpha, which would
-     * occur with the default EXTEND_NONE. Use EXTEND_PAD for 1.2 or newer (2)
+    /*
+     * Only decode the level the request needs, directly at a reduced size
+     * when the decoder supports it.
      */
-    cairo_pattern_set_extend(cairo_get_source(cr.get()), CAIRO_EXTEND_REFLECT);
+    Size size;
+    auto surface = load_mip_level(data, len, path, level, size);
+    if (!MipChain::supported(surface))
+        return nullptr;
+
+    auto chain = std::make_shared<MipChain>(std::make_shared<Surface>(std::move(surface)),
+                                            size, level);
+    m_sources.emplace_front(uri, chain);
+    return chain;
+}
 
-    /* Replace the destination with the source instead of overlaying */
-    cairo_set_operator(cr.get(), CAIRO_OPERATOR_SOURCE);
+void ImageCache::trim_sources()
+{
+    size_t total = 0;
+    for (auto i = m_sources.begin(); i != m_sources.end();)
+    {
+        const auto bytes = i->second->bytes();
+        if (total + bytes > m_source_budget)
+        {
+            i = m_sources.erase(i);
+            continue;
+        }
+
+        total += bytes;
+        ++i;
+    }
+}
+
+float ImageCache::round(float v, float fraction)
+{
+    return floorf(v) + floorf((v - floorf(v)) / fraction) * fraction;
+}
 
-    /* Do the actual drawing */
-    cairo_paint(cr.get());
+std::string ImageCache::id(const std::string& name, float hscale, float vscale)
+{
+    return fmt::format("{}-{}-{}", name, hscale * 100, vscale * 100);
+}
 
-    return new_surface;
+Surface ImageCache::resize(const Surface& surface, const Size& size)
+{
+    return resample(surface, size);
 }
-#endif
 
 ImageCache& image_cache()
 {
@@ -18,6 +18,27 @@ inline namespace v1
 namespace detail
 {
 
+/*
+ * Context shared by all flex layouts.
+ *
+ * Nested sizers are laid out one after the other, never while another layout
+ * is running, so one context reset for each layout is enough, and it keeps its
+ * items allocated from one layout to the next.
+ */
+static lay_context& layout_context()
+{
+    struct Context
+    {
+        Context() { lay_init_context(&ctx); }
+        ~Context() { lay_destroy_context(&ctx); }
+        lay_context ctx;
+    };
+
+    static Context context;
+    lay_reset_context(&context.ctx);
+    return context.ctx;
+}
+
 static void run_and_apply(lay_context& ctx, lay_id parent,
                           std::vector<LayoutRect>& children)
 {
@@ -105,13 +126,7 @@ void flex_layout(const Rect& parent,
                  Justification justify,
                  Orientation orient)
 {
-    lay_context ctx;
-    lay_init_context(&ctx);
-
-    auto cleanup = on_scope_exit([&ctx]()
-    {
-        lay_destroy_context(&ctx);
-    });
+    auto& ctx = layout_context();
 
     lay_reserve_items_capacity(&ctx, children.size() + 1);
 
@@ -129,13 +144,7 @@ void flex_layout(const Rect& parent,
                  Orientation orient,
                  const AlignFlags& align)
 {
-    lay_context ctx;
-    lay_init_context(&ctx);
-
-    auto cleanup = on_scope_exit([&ctx]()
-    {
-        lay_destroy_context(&ctx);
-    });
+    auto& ctx = layout_context();
 
     lay_reserve_items_capacity(&ctx, children.size() + 2);
 
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "detail/mappedfile.h"
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+MappedFile::MappedFile(const std::string& filename)
+{
+    const int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::runtime_error("unable to open file: " + filename);
+
+    struct stat st {};
+    if (::fstat(fd, &st) < 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("unable to stat file: " + filename);
+    }
+
+    m_size = st.st_size;
+    if (!m_size)
+    {
+        ::close(fd);
+        return;
+    }
+
+    void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED)
+    {
+        m_data = static_cast<const unsigned char*>(addr);
+        m_mapped = true;
+        ::close(fd);
+        return;
+    }
+
+    /*
+     * Some filesystems do not support mmap(), fall back to reading the file.
+     */
+    m_buffer.resize(m_size);
+    size_t offset = 0;
+    while (offset < m_size)
+    {
+        const auto ret = ::read(fd, m_buffer.data() + offset, m_size - offset);
+        if (ret <= 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("unable to read file: " + filename);
+        }
+        offset += ret;
+    }
+
+    ::close(fd);
+    m_data = m_buffer.data();
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_mapped)
+        ::munmap(const_cast<unsigned char*>(m_data), m_size);
+}
+
+}
+}
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef EGT_SRC_DETAIL_MAPPEDFILE_H
+#define EGT_SRC_DETAIL_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+/**
+ * Read-only view of the whole content of a file.
+ *
+ * The file is mapped in memory when possible, and read otherwise, so it is
+ * opened exactly once whatever is done with its content afterwards.
+ */
+class MappedFile
+{
+public:
+
+    /**
+     * @param[in] filename The path of the file.
+     *
+     * @throws std::runtime_error if the file cannot be opened or read.
+     */
+    explicit MappedFile(const std::string& filename);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Pointer to the content of the file.
+    const unsigned char* data() const { return m_data; }
+
+    /// Size of the file in bytes.
+    size_t size() const { return m_size; }
+
+    ~MappedFile();
+
+protected:
+
+    const unsigned char* m_data{nullptr};
+    size_t m_size{0};
+    bool m_mapped{false};
+    std::vector<unsigned char> m_buffer;
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "detail/cairoabstraction.h"
+#include "detail/mipmap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#ifdef HAVE_SIMD
+#include "Simd/SimdLib.hpp"
+#endif
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+/*
+ * Below this number of destination pixels, reducing a level in a single
+ * thread is cheaper than starting workers.
+ */
+static constexpr size_t THREAD_MIN_PIXELS = 512 * 512;
+
+static inline DefaultDim half(DefaultDim dim)
+{
+    return std::max<DefaultDim>(1, (dim + 1) / 2);
+}
+
+#ifndef HAVE_SIMD
+/*
+ * Average four premultiplied 32 bit pixels, two channels at a time in 16 bit
+ * lanes of a 32 bit word so no channel needs to be unpacked.
+ */
+static inline uint32_t average4(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+    const uint32_t rb = (a & 0x00ff00ff) + (b & 0x00ff00ff) +
+                        (c & 0x00ff00ff) + (d & 0x00ff00ff) + 0x00020002;
+    const uint32_t ag = ((a >> 8) & 0x00ff00ff) + ((b >> 8) & 0x00ff00ff) +
+                        ((c >> 8) & 0x00ff00ff) + ((d >> 8) & 0x00ff00ff) + 0x00020002;
+    return ((rb >> 2) & 0x00ff00ff) | (((ag >> 2) & 0x00ff00ff) << 8);
+}
+
+static void box_reduce_rows(const Surface& src, Surface& dst,
+                            DefaultDim first, DefaultDim last)
+{
+    const auto src_data = static_cast<const unsigned char*>(src.data());
+    const auto dst_data = static_cast<unsigned char*>(dst.data());
+    const auto last_x = src.width() - 1;
+    const auto last_y = src.height() - 1;
+
+    for (auto y = first; y < last; ++y)
+    {
+        const auto row0 = reinterpret_cast<const uint32_t*>(src_data + std::min(2 * y, last_y) * src.stride());
+        const auto row1 = reinterpret_cast<const uint32_t*>(src_data + std::min(2 * y + 1, last_y) * src.stride());
+        auto out = reinterpret_cast<uint32_t*>(dst_data + y * dst.stride());
+
+        for (DefaultDim x = 0; x < dst.width(); ++x)
+        {
+            const auto x0 = std::min(2 * x, last_x);
+            const auto x1 = std::min(2 * x + 1, last_x);
+            out[x] = average4(row0[x0], row0[x1], row1[x0], row1[x1]);
+        }
+    }
+}
+#endif
+
+Surface box_reduce(const Surface& surface)
+{
+    Surface result(Size(half(surface.width()), half(surface.height())),
+                   surface.format());
+    result.sync_for_cpu();
+    surface.flush(true);
+
+#ifdef HAVE_SIMD
+    SimdReduceColor2x2(static_cast<const uint8_t*>(surface.data()),
+                       surface.width(), surface.height(), surface.stride(),
+                       static_cast<uint8_t*>(result.data()),
+                       result.width(), result.height(), result.stride(),
+                       4);
+#else
+    const size_t pixels = result.width() * result.height();
+    unsigned threads = 1;
+    if (pixels >= THREAD_MIN_PIXELS)
+        threads = std::max(1U, std::min<unsigned>(std::thread::hardware_concurrency(), result.height()));
+
+    if (threads > 1)
+    {
+        std::vector<std::thread> pool;
+        const auto rows = (result.height() + threads - 1) / threads;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            const DefaultDim first = t * rows;
+            const DefaultDim last = std::min<DefaultDim>(first + rows, result.height());
+            if (first < last)
+                pool.emplace_back(box_reduce_rows, std::cref(surface), std::ref(result), first, last);
+        }
+        for (auto& t : pool)
+            t.join();
+    }
+    else
+    {
+        box_reduce_rows(surface, result, 0, result.height());
+    }
+#endif
+
+    result.mark_dirty();
+
+    return result;
+}
+
+#ifdef HAVE_SIMD
+Surface resample(const Surface& surface, const Size& size)
+{
+    Surface new_surface(size, surface.format());
+    new_surface.sync_for_cpu();
+    surface.flush(true);
+
+    SimdResizeBilinear(static_cast<const uint8_t*>(surface.data()),
+                       surface.width(),
+                       surface.height(),
+                       surface.stride(),
+                       static_cast<uint8_t*>(new_surface.data()),
+                       new_surface.width(),
+                       new_surface.height(),
+                       new_surface.stride(),
+                       4);
+
+    new_surface.mark_dirty();
+
+    return new_surface;
+}
+#else
+Surface resample(const Surface& surface, const Size& size)
+{
+    Surface new_surface(size, surface.format());
+    unique_cairo_t cr(cairo_create(new_surface.impl()));
+
+    /* Scale *before* setting the source surface (1) */
+    cairo_scale(cr.get(),
+                static_cast<double>(size.width()) / surface.width(),
+                static_cast<double>(size.height()) / surface.height());
+
+    cairo_set_source_surface(cr.get(), surface.impl(), 0, 0);
+
+    /* To avoid getting the edge pixels blended with 0 alpha, which would
+     * occur with the default EXTEND_NONE. Use EXTEND_PAD for 1.2 or newer (2)
+     */
+    cairo_pattern_set_extend(cairo_get_source(cr.get()), CAIRO_EXTEND_REFLECT);
+
+    /* Replace the destination with the source instead of overlaying */
+    cairo_set_operator(cr.get(), CAIRO_OPERATOR_SOURCE);
+
+    /* Do the actual drawing */
+    cairo_paint(cr.get());
+
+    return new_surface;
+}
+#endif
+
+MipChain::MipChain(std::shared_ptr<Surface> source, const Size& size, size_t first)
+    : m_size(size),
+      m_first(first)
+{
+    m_bytes = source->stride() * source->height();
+    m_levels.emplace_back(std::move(source));
+}
+
+size_t MipChain::covering_level(float hscale, float vscale)
+{
+    /*
+     * Level n is at least 1 / 2^n of the original size, so it covers any
+     * scale up to that.
+     */
+    const auto scale = std::max(hscale, vscale);
+    size_t n = 0;
+    while (n < 16 && scale * (2U << n) <= 1.0f)
+        n++;
+    return n;
+}
+
+bool MipChain::supported(const Surface& surface)
+{
+    return !surface.empty() &&
+           (surface.format() == PixelFormat::argb8888 ||
+            surface.format() == PixelFormat::xrgb8888);
+}
+
+const std::shared_ptr<Surface>& MipChain::level(size_t n)
+{
+    while (m_levels.size() <= n)
+    {
+        auto next = std::make_shared<Surface>(box_reduce(*m_levels.back()));
+        m_bytes += next->stride() * next->height();
+        m_levels.emplace_back(std::move(next));
+    }
+
+    return m_levels[n];
+}
+
+std::shared_ptr<Surface> MipChain::scaled(float hscale, float vscale)
+{
+    const Size target(std::ceil(hscale * m_size.width()),
+                      std::ceil(vscale * m_size.height()));
+    if (target.empty())
+        return nullptr;
+
+    /*
+     * Find the smallest level that is not smaller than the target in either
+     * direction.
+     */
+    size_t n = 0;
+    Size size = m_size;
+    while (size.width() > 1 || size.height() > 1)
+    {
+        const Size next(half(size.width()), half(size.height()));
+        if (next.width() < target.width() || next.height() < target.height())
+            break;
+        size = next;
+        n++;
+    }
+
+    if (n < m_first)
+        return nullptr;
+
+    const auto& base = level(n - m_first);
+    if (base->size() == target)
+        return base;
+
+    return std::make_shared<Surface>(resample(*base, target));
+}
+
+}
+}
+}
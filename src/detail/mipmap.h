@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef EGT_SRC_DETAIL_MIPMAP_H
+#define EGT_SRC_DETAIL_MIPMAP_H
+
+#include <egt/geometry.h>
+#include <egt/surface.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+/**
+ * Chain of successively halved copies of a decoded image.
+ *
+ * Levels are built lazily with a 2x2 box filter, each one from the previous
+ * level. A scaled image is resampled from the smallest level that is still
+ * larger than the requested size, so shrinking an image costs a resample of
+ * a surface at most twice as large as the result instead of a new decode and
+ * a resample of the original.
+ *
+ * The chain does not need to start from the original image: it may start
+ * from any level, decoded at a reduced size.
+ */
+class MipChain
+{
+public:
+
+    /**
+     * @param[in] source First level of the chain.
+     * @param[in] size Size of the original image.
+     * @param[in] first Level of the source, the original image being level 0.
+     */
+    MipChain(std::shared_ptr<Surface> source, const Size& size, size_t first = 0);
+
+    /**
+     * Return the first level able to give the image scaled by the given
+     * factors, whatever its size.
+     */
+    static size_t covering_level(float hscale, float vscale);
+
+    /**
+     * Return true if the pixel format of the surface is supported.
+     */
+    static bool supported(const Surface& surface);
+
+    /**
+     * Get the image scaled by the given factors.
+     *
+     * The size of the result is rounded up like when scaling at decode time.
+     *
+     * @return nullptr if the first level of the chain is too small.
+     */
+    std::shared_ptr<Surface> scaled(float hscale, float vscale);
+
+    /**
+     * Level of the first surface of the chain.
+     */
+    size_t first() const { return m_first; }
+
+    /**
+     * Number of bytes used by the levels built so far.
+     */
+    size_t bytes() const { return m_bytes; }
+
+protected:
+
+    const std::shared_ptr<Surface>& level(size_t n);
+
+    /// Levels built so far, starting from level m_first.
+    std::vector<std::shared_ptr<Surface>> m_levels;
+    Size m_size;
+    size_t m_first{0};
+    size_t m_bytes{0};
+};
+
+/**
+ * Downscale a 32 bpp surface by two in each direction with a box filter.
+ */
+Surface box_reduce(const Surface& surface);
+
+/**
+ * Resample a surface to a new size.
+ */
+Surface resample(const Surface& surface, const Size& size);
+
+/**
+ * Decode an image at a level of its mip chain.
+ *
+ * JPEG images are decoded directly at up to 1/8 of their size by libjpeg,
+ * and any further level is built with box_reduce(). Other images are decoded
+ * at full size before being reduced.
+ *
+ * @param[in] data Pointer to the in-memory data.
+ * @param[in] len Size of the data.
+ * @param[in] name Name of the image, for errors.
+ * @param[in,out] level Requested level, changed to the level of the result
+ *                which is smaller for tiny images.
+ * @param[out] size Size of the original image.
+ */
+Surface load_mip_level(const unsigned char* data, size_t len, const std::string& name,
+                       size_t& level, Size& size);
+
+}
+}
+}
+
+#endif
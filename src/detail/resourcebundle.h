@@ -0,0 +1,411 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef EGT_SRC_DETAIL_RESOURCEBUNDLE_H
+#define EGT_SRC_DETAIL_RESOURCEBUNDLE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+/**
+ * Indexed resource bundle format.
+ *
+ * A bundle packs many resources in a single blob that can be mapped or
+ * embedded as is:
+ *
+ *     [header]
+ *     {seed}...       one signed 32 bit word per bucket
+ *     {entry}...      one entry per resource, in hash slot order
+ *     {name}...       nul terminated names
+ *     {data}...       resource data
+ *
+ * Resources are looked up with a minimal perfect hash: the name is hashed once
+ * to select a bucket, and the seed of the bucket either gives the slot
+ * directly or is used to hash the name a second time. A lookup is then a
+ * single name comparison whatever the number of resources.
+ *
+ * Every entry stores the uncompressed size of its resource, so a compressed
+ * resource is inflated in one pass into a buffer of the final size.
+ * Uncompressed data are aligned on the bundle alignment, a page by default,
+ * so they can be used directly from a mapping of the bundle.
+ *
+ * All words are little endian and all offsets are relative to the start of
+ * the header.
+ */
+class ResourceBundle
+{
+public:
+
+    /// Compression applied to a resource.
+    enum class Compression : uint32_t
+    {
+        none = 0,
+        zlib = 1,
+    };
+
+    /// A resource of the bundle.
+    struct Entry
+    {
+        /// Nul terminated name of the resource.
+        const char* name{nullptr};
+        /// Stored data.
+        const unsigned char* data{nullptr};
+        /// Size of the stored data.
+        uint32_t size{0};
+        /// Size of the data once uncompressed.
+        uint32_t raw_size{0};
+        /// Compression of the stored data.
+        Compression compression{Compression::none};
+    };
+
+    static constexpr uint32_t egt_magic()
+    {
+        return 0x53455245; // "ERES"
+    }
+
+    static constexpr uint32_t version()
+    {
+        return 1;
+    }
+
+    static constexpr uint32_t default_alignment()
+    {
+        return 4096;
+    }
+
+    /// Size of the fixed header in bytes.
+    static constexpr size_t header_size()
+    {
+        return 8 * sizeof(uint32_t);
+    }
+
+    /// Size of one entry in bytes.
+    static constexpr size_t entry_size()
+    {
+        return 6 * sizeof(uint32_t);
+    }
+
+    ResourceBundle() = default;
+
+    /**
+     * Open a bundle from a buffer.
+     *
+     * The buffer is not copied and must outlive this object.
+     */
+    bool open(const unsigned char* buf, size_t len)
+    {
+        m_buf = nullptr;
+        m_len = 0;
+        m_count = 0;
+
+        uint32_t magic = 0;
+        uint32_t ver = 0;
+        uint32_t count = 0;
+        if (!read_at(buf, len, 0, magic) || magic != egt_magic())
+            return false;
+        if (!read_at(buf, len, 4, ver) || ver != version())
+            return false;
+        if (!read_at(buf, len, 8, count) ||
+            !read_at(buf, len, 16, m_seeds) ||
+            !read_at(buf, len, 20, m_entries) ||
+            !read_at(buf, len, 24, m_names))
+            return false;
+
+        if (m_seeds + count * sizeof(uint32_t) > len ||
+            m_entries + count * entry_size() > len ||
+            m_names > len)
+            return false;
+
+        m_buf = buf;
+        m_len = len;
+        m_count = count;
+
+        return true;
+    }
+
+    /// Number of resources in the bundle.
+    size_t count() const
+    {
+        return m_count;
+    }
+
+    /**
+     * Get a resource by slot.
+     *
+     * @return false if the entry is out of the bounds of the bundle.
+     */
+    bool entry(size_t slot, Entry& entry) const
+    {
+        if (slot >= m_count)
+            return false;
+
+        uint32_t name = 0;
+        uint32_t name_len = 0;
+        uint32_t offset = 0;
+        uint32_t compression = 0;
+        const size_t base = m_entries + slot * entry_size();
+        read_at(m_buf, m_len, base, name);
+        read_at(m_buf, m_len, base + 4, name_len);
+        read_at(m_buf, m_len, base + 8, offset);
+        read_at(m_buf, m_len, base + 12, entry.size);
+        read_at(m_buf, m_len, base + 16, entry.raw_size);
+        read_at(m_buf, m_len, base + 20, compression);
+
+        if (static_cast<size_t>(m_names) + name + name_len >= m_len ||
+            static_cast<size_t>(offset) + entry.size > m_len)
+            return false;
+
+        entry.name = reinterpret_cast<const char*>(m_buf + m_names + name);
+        entry.data = m_buf + offset;
+        entry.compression = static_cast<Compression>(compression);
+
+        return true;
+    }
+
+    /**
+     * Find a resource by name.
+     */
+    bool find(const char* name, Entry& result) const
+    {
+        if (!m_count)
+            return false;
+
+        const auto len = strlen(name);
+        if (!entry(slot(name, len), result))
+            return false;
+
+        return strcmp(result.name, name) == 0;
+    }
+
+    /// Input of build().
+    struct Input
+    {
+        std::string name;
+        std::vector<unsigned char> data;
+        bool compress{false};
+    };
+
+    /**
+     * Build a bundle.
+     *
+     * A resource is only stored compressed if that makes it smaller.
+     *
+     * @param[in] inputs Resources, names must be unique.
+     * @param[in] alignment Alignment of uncompressed data, a power of two.
+     */
+    static std::vector<unsigned char> build(const std::vector<Input>& inputs,
+                                            uint32_t alignment = default_alignment())
+    {
+        const auto count = static_cast<uint32_t>(inputs.size());
+        std::vector<int32_t> seeds(count, 0);
+        std::vector<uint32_t> slots(count, 0);
+        place(inputs, seeds, slots);
+
+        std::vector<unsigned char> names;
+        std::vector<uint32_t> name_offsets(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            name_offsets[i] = names.size();
+            names.insert(names.end(), inputs[i].name.begin(), inputs[i].name.end());
+            names.push_back(0);
+        }
+
+        const uint32_t seeds_offset = header_size();
+        const uint32_t entries_offset = seeds_offset + count * sizeof(uint32_t);
+        const uint32_t names_offset = entries_offset + count * entry_size();
+
+        std::vector<unsigned char> out(names_offset);
+        write_at(out, 0, egt_magic());
+        write_at(out, 4, version());
+        write_at(out, 8, count);
+        write_at(out, 12, alignment);
+        write_at(out, 16, seeds_offset);
+        write_at(out, 20, entries_offset);
+        write_at(out, 24, names_offset);
+        for (uint32_t b = 0; b < count; ++b)
+            write_at(out, seeds_offset + b * sizeof(uint32_t), static_cast<uint32_t>(seeds[b]));
+        out.insert(out.end(), names.begin(), names.end());
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const auto& input = inputs[i];
+            auto compression = Compression::none;
+            std::vector<unsigned char> packed;
+#ifdef HAVE_ZLIB
+            if (input.compress && !input.data.empty())
+            {
+                uLongf packed_len = compressBound(input.data.size());
+                packed.resize(packed_len);
+                if (compress2(packed.data(), &packed_len,
+                              input.data.data(), input.data.size(),
+                              Z_BEST_COMPRESSION) == Z_OK &&
+                    packed_len < input.data.size())
+                {
+                    packed.resize(packed_len);
+                    compression = Compression::zlib;
+                }
+            }
+#endif
+            const auto& data = compression == Compression::none ? input.data : packed;
+
+            // compressed data is inflated anyway, so only word align it
+            const uint32_t align = compression == Compression::none ?
+                                   std::max<uint32_t>(alignment, 1) : sizeof(uint32_t);
+            out.resize((out.size() + align - 1) / align * align);
+
+            const size_t base = entries_offset + slots[i] * entry_size();
+            write_at(out, base, name_offsets[i]);
+            write_at(out, base + 4, static_cast<uint32_t>(input.name.size()));
+            write_at(out, base + 8, static_cast<uint32_t>(out.size()));
+            write_at(out, base + 12, static_cast<uint32_t>(data.size()));
+            write_at(out, base + 16, static_cast<uint32_t>(input.data.size()));
+            write_at(out, base + 20, static_cast<uint32_t>(compression));
+
+            out.insert(out.end(), data.begin(), data.end());
+        }
+
+        return out;
+    }
+
+    /**
+     * Seeded FNV-1a hash of a name.
+     */
+    static uint32_t hash(uint32_t seed, const char* name, size_t len)
+    {
+        uint32_t h = 0x811c9dc5 ^ (seed * 0x9e3779b9);
+        for (size_t i = 0; i < len; ++i)
+        {
+            h ^= static_cast<unsigned char>(name[i]);
+            h *= 0x01000193;
+        }
+        return h;
+    }
+
+protected:
+
+    size_t slot(const char* name, size_t len) const
+    {
+        const auto bucket = hash(0, name, len) % m_count;
+        uint32_t value = 0;
+        read_at(m_buf, m_len, m_seeds + bucket * sizeof(uint32_t), value);
+        const auto seed = static_cast<int32_t>(value);
+        if (seed < 0)
+            return -seed - 1;
+        return hash(seed, name, len) % m_count;
+    }
+
+    /*
+     * Hash and displace: buckets are placed from the largest to the smallest,
+     * each with the first seed that sends all of its names to free slots.
+     * Buckets of one name take any free slot directly, stored as a negative
+     * seed.
+     */
+    static void place(const std::vector<Input>& inputs,
+                      std::vector<int32_t>& seeds,
+                      std::vector<uint32_t>& slots)
+    {
+        const auto count = static_cast<uint32_t>(inputs.size());
+        if (!count)
+            return;
+
+        std::vector<std::vector<uint32_t>> buckets(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const auto& name = inputs[i].name;
+            buckets[hash(0, name.data(), name.size()) % count].push_back(i);
+        }
+
+        std::vector<uint32_t> order(count);
+        for (uint32_t b = 0; b < count; ++b)
+            order[b] = b;
+        std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b)
+        {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        std::vector<bool> used(count, false);
+        size_t o = 0;
+        for (; o < count && buckets[order[o]].size() > 1; ++o)
+        {
+            const auto& bucket = buckets[order[o]];
+            std::vector<uint32_t> candidate;
+            for (uint32_t seed = 1;; ++seed)
+            {
+                candidate.clear();
+                for (auto i : bucket)
+                {
+                    const auto& name = inputs[i].name;
+                    const auto s = hash(seed, name.data(), name.size()) % count;
+                    if (used[s] ||
+                        std::find(candidate.begin(), candidate.end(), s) != candidate.end())
+                        break;
+                    candidate.push_back(s);
+                }
+
+                if (candidate.size() == bucket.size())
+                {
+                    for (size_t k = 0; k < bucket.size(); ++k)
+                    {
+                        used[candidate[k]] = true;
+                        slots[bucket[k]] = candidate[k];
+                    }
+                    seeds[order[o]] = static_cast<int32_t>(seed);
+                    break;
+                }
+            }
+        }
+
+        uint32_t free_slot = 0;
+        for (; o < count && !buckets[order[o]].empty(); ++o)
+        {
+            while (used[free_slot])
+                free_slot++;
+            used[free_slot] = true;
+            slots[buckets[order[o]].front()] = free_slot;
+            seeds[order[o]] = -static_cast<int32_t>(free_slot) - 1;
+        }
+    }
+
+    template<class T>
+    static bool read_at(const unsigned char* buf, size_t len, size_t offset, T& value)
+    {
+        if (offset + sizeof(T) > len)
+            return false;
+        memcpy(&value, buf + offset, sizeof(T));
+        return true;
+    }
+
+    static void write_at(std::vector<unsigned char>& out, size_t offset, uint32_t value)
+    {
+        memcpy(out.data() + offset, &value, sizeof(value));
+    }
+
+    const unsigned char* m_buf{nullptr};
+    size_t m_len{0};
+    uint32_t m_count{0};
+    uint32_t m_seeds{0};
+    uint32_t m_entries{0};
+    uint32_t m_names{0};
+};
+
+}
+}
+}
+
+#endif
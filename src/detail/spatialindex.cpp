@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "egt/detail/math.h"
+#include "egt/detail/spatialindex.h"
+#include "egt/widget.h"
+#include <algorithm>
+#include <cmath>
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+/// Maximum number of cells in each direction.
+static constexpr int SPATIAL_INDEX_MAX_CELLS = 128;
+
+void SpatialIndex::clear()
+{
+    m_widgets.clear();
+    m_boxes.clear();
+    m_positions.clear();
+    for (auto& cell : m_cells)
+        cell.clear();
+    m_outside = 0;
+    m_valid = false;
+}
+
+void SpatialIndex::build()
+{
+    m_boxes.reserve(m_widgets.size());
+    m_positions.reserve(m_widgets.size());
+
+    m_bounds = {};
+    for (size_t i = 0; i < m_widgets.size(); ++i)
+    {
+        m_boxes.push_back(m_widgets[i]->box());
+        m_positions[m_widgets[i]] = static_cast<uint32_t>(i);
+
+        if (i == 0)
+            m_bounds = m_boxes.back();
+        else
+            m_bounds = Rect::merge(m_bounds, m_boxes.back());
+    }
+
+    // about one cell per widget
+    const auto n = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(m_widgets.size()))));
+    m_columns = detail::clamp(n, 1, SPATIAL_INDEX_MAX_CELLS);
+    m_rows = m_columns;
+    m_cell_width = std::max<DefaultDim>(1, (m_bounds.width() + m_columns - 1) / m_columns);
+    m_cell_height = std::max<DefaultDim>(1, (m_bounds.height() + m_rows - 1) / m_rows);
+
+    // keep the cells that are still there to reuse their memory
+    m_cells.resize(static_cast<size_t>(m_columns) * m_rows);
+
+    for (size_t i = 0; i < m_widgets.size(); ++i)
+        insert(static_cast<uint32_t>(i));
+
+    m_valid = true;
+}
+
+size_t SpatialIndex::cell(const Point& point) const
+{
+    const auto column = detail::clamp((point.x() - m_bounds.x()) / m_cell_width, 0, m_columns - 1);
+    const auto row = detail::clamp((point.y() - m_bounds.y()) / m_cell_height, 0, m_rows - 1);
+    return static_cast<size_t>(row) * m_columns + column;
+}
+
+void SpatialIndex::cells(const Rect& rect, int& left, int& top, int& right, int& bottom) const
+{
+    left = detail::clamp((rect.x() - m_bounds.x()) / m_cell_width, 0, m_columns - 1);
+    top = detail::clamp((rect.y() - m_bounds.y()) / m_cell_height, 0, m_rows - 1);
+    right = detail::clamp((rect.x() + rect.width() - m_bounds.x()) / m_cell_width, 0, m_columns - 1);
+    bottom = detail::clamp((rect.y() + rect.height() - m_bounds.y()) / m_cell_height, 0, m_rows - 1);
+}
+
+void SpatialIndex::insert(uint32_t position)
+{
+    int left, top, right, bottom;
+    cells(m_boxes[position], left, top, right, bottom);
+
+    for (auto row = top; row <= bottom; ++row)
+        for (auto column = left; column <= right; ++column)
+            m_cells[static_cast<size_t>(row) * m_columns + column].push_back(position);
+}
+
+void SpatialIndex::erase(uint32_t position)
+{
+    int left, top, right, bottom;
+    cells(m_boxes[position], left, top, right, bottom);
+
+    for (auto row = top; row <= bottom; ++row)
+    {
+        for (auto column = left; column <= right; ++column)
+        {
+            auto& cell = m_cells[static_cast<size_t>(row) * m_columns + column];
+            auto i = std::find(cell.begin(), cell.end(), position);
+            if (i != cell.end())
+            {
+                *i = cell.back();
+                cell.pop_back();
+            }
+        }
+    }
+}
+
+void SpatialIndex::update(const Widget& widget)
+{
+    if (!m_valid)
+        return;
+
+    auto i = m_positions.find(&widget);
+    if (i == m_positions.end())
+        return;
+
+    const auto position = i->second;
+    if (m_boxes[position] == widget.box())
+        return;
+
+    erase(position);
+    m_boxes[position] = widget.box();
+    insert(position);
+
+    /*
+     * Boxes out of the grid are in its border cells. When there are too many
+     * of them, have the index built again over the new bounds.
+     */
+    if (!m_bounds.contains(m_boxes[position]))
+    {
+        if (++m_outside > m_widgets.size() / 8)
+            m_valid = false;
+    }
+}
+
+void SpatialIndex::query(const Rect& rect, std::vector<Widget*>& widgets) const
+{
+    widgets.clear();
+
+    if (!m_valid || m_cells.empty() || rect.empty())
+        return;
+
+    int left, top, right, bottom;
+    cells(rect, left, top, right, bottom);
+
+    m_found.clear();
+    for (auto row = top; row <= bottom; ++row)
+    {
+        for (auto column = left; column <= right; ++column)
+        {
+            for (auto position : m_cells[static_cast<size_t>(row) * m_columns + column])
+            {
+                if (m_boxes[position].intersect(rect))
+                    m_found.push_back(position);
+            }
+        }
+    }
+
+    // a widget over several cells is found once per cell
+    std::sort(m_found.begin(), m_found.end());
+    m_found.erase(std::unique(m_found.begin(), m_found.end()), m_found.end());
+
+    widgets.reserve(m_found.size());
+    for (auto position : m_found)
+        widgets.push_back(m_widgets[position]);
+}
+
+}
+}
+}
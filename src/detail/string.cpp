@@ -80,6 +80,18 @@ void tokenize(const std::string& str, char delimiter, std::vector<std::string>&
     }
 }
 
+void tokenize(std::string_view str, char delimiter, std::vector<std::string_view>& tokens)
+{
+    size_t start = str.find_first_not_of(delimiter);
+
+    while (start != std::string_view::npos)
+    {
+        auto end = str.find(delimiter, start);
+        tokens.push_back(str.substr(start, end - start));
+        start = str.find_first_not_of(delimiter, end);
+    }
+}
+
 void tolower(std::string& s)
 {
     std::transform(s.begin(), s.end(), s.begin(),
@@ -0,0 +1,300 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "egt/detail/timerwheel.h"
+#include <algorithm>
+
+namespace egt
+{
+inline namespace v1
+{
+namespace detail
+{
+
+void TimerWheel::Entry::cancel()
+{
+    if (m_wheel)
+        m_wheel->cancel(*this);
+}
+
+TimerWheel::TimerWheel(asio::io_context& io, std::chrono::milliseconds resolution)
+    : m_timer(io),
+      m_resolution(std::max(resolution, std::chrono::milliseconds(1))),
+      m_start(Clock::now())
+{
+    for (auto& head : m_ticks)
+        head.prev = head.next = &head;
+    for (auto& head : m_blocks)
+        head.prev = head.next = &head;
+    m_expired.prev = m_expired.next = &m_expired;
+}
+
+uint64_t TimerWheel::tick(const Clock::time_point& time) const
+{
+    if (time <= m_start)
+        return 0;
+    return static_cast<uint64_t>((time - m_start) / m_resolution);
+}
+
+void TimerWheel::link(Link& next, Entry& entry) noexcept
+{
+    entry.prev = next.prev;
+    entry.next = &next;
+    next.prev->next = &entry;
+    next.prev = &entry;
+}
+
+void TimerWheel::unlink(Entry& entry) noexcept
+{
+    entry.prev->next = entry.next;
+    entry.next->prev = entry.prev;
+    entry.prev = entry.next = nullptr;
+}
+
+void TimerWheel::insert(Entry& entry) noexcept
+{
+    const auto block = entry.m_tick / SLOTS;
+    const auto current = m_tick / SLOTS;
+
+    if (block == current)
+    {
+        const auto slot = entry.m_tick % SLOTS;
+        entry.m_head = &m_ticks[slot];
+        m_ticks_occupied |= UINT64_C(1) << slot;
+    }
+    else
+    {
+        // further blocks wait in the last slot
+        const auto slot = std::min(block, current + SLOTS - 1) % SLOTS;
+        entry.m_head = &m_blocks[slot];
+        m_blocks_occupied |= UINT64_C(1) << slot;
+    }
+
+    link(*entry.m_head, entry);
+}
+
+void TimerWheel::update_slot(const Link& head) noexcept
+{
+    if (head.next != &head)
+        return;
+
+    if (&head >= m_ticks.data() && &head < m_ticks.data() + SLOTS)
+        m_ticks_occupied &= ~(UINT64_C(1) << (&head - m_ticks.data()));
+    else if (&head >= m_blocks.data() && &head < m_blocks.data() + SLOTS)
+        m_blocks_occupied &= ~(UINT64_C(1) << (&head - m_blocks.data()));
+}
+
+uint64_t TimerWheel::next_tick_in_block() const noexcept
+{
+    const auto bits = m_ticks_occupied & (~UINT64_C(0) << (m_tick % SLOTS));
+    if (!bits)
+        return UINT64_MAX;
+
+    return m_tick - m_tick % SLOTS + __builtin_ctzll(bits);
+}
+
+uint64_t TimerWheel::next_block() const noexcept
+{
+    if (!m_blocks_occupied)
+        return UINT64_MAX;
+
+    // first occupied slot after the one of the current block, wrapping around
+    const auto current = m_tick / SLOTS;
+    const auto shift = (current + 1) % SLOTS;
+    auto bits = m_blocks_occupied >> shift;
+    if (shift)
+        bits |= m_blocks_occupied << (SLOTS - shift);
+
+    return current + 1 + __builtin_ctzll(bits);
+}
+
+uint64_t TimerWheel::next_tick() const noexcept
+{
+    const auto t = next_tick_in_block();
+    if (t != UINT64_MAX)
+        return t;
+
+    const auto block = next_block();
+    if (block == UINT64_MAX)
+        return UINT64_MAX;
+
+    // the earliest timer of the block, which may be further in the last slot
+    const auto& head = m_blocks[block % SLOTS];
+    auto result = UINT64_MAX;
+    for (auto next = head.next; next != &head; next = next->next)
+        result = std::min(result, static_cast<const Entry*>(next)->m_tick);
+    return result;
+}
+
+void TimerWheel::advance(uint64_t to) noexcept
+{
+    while (m_tick < to)
+    {
+        const auto end = (m_tick / SLOTS + 1) * SLOTS;
+        const auto last = std::min(to, end);
+
+        for (auto t = next_tick_in_block(); t < last; t = next_tick_in_block())
+        {
+            auto& head = m_ticks[t % SLOTS];
+            while (head.next != &head)
+            {
+                auto entry = static_cast<Entry*>(head.next);
+                unlink(*entry);
+                entry->m_head = &m_expired;
+                link(m_expired, *entry);
+            }
+            update_slot(head);
+        }
+
+        if (last != end)
+        {
+            m_tick = last;
+            break;
+        }
+
+        // skip the blocks without timers, from the block that just ended
+        const auto block = next_block();
+        if (block == UINT64_MAX || block > to / SLOTS)
+        {
+            m_tick = to;
+            break;
+        }
+
+        // cascade the timers of the block to the first level
+        m_tick = block * SLOTS;
+        auto& head = m_blocks[block % SLOTS];
+        Link cascade;
+        cascade.prev = cascade.next = &cascade;
+        while (head.next != &head)
+        {
+            auto entry = static_cast<Entry*>(head.next);
+            unlink(*entry);
+            link(cascade, *entry);
+        }
+        update_slot(head);
+
+        while (cascade.next != &cascade)
+        {
+            auto entry = static_cast<Entry*>(cascade.next);
+            unlink(*entry);
+            insert(*entry);
+        }
+    }
+}
+
+void TimerWheel::schedule(Entry& entry, std::chrono::milliseconds duration)
+{
+    if (entry.m_wheel)
+        cancel(entry);
+
+    // round up, so the timer never expires early
+    const auto deadline = Clock::now() + std::max(duration, std::chrono::milliseconds(0));
+    auto t = tick(deadline);
+    if (m_start + t * m_resolution < deadline)
+        ++t;
+
+    // ticks before m_tick were already processed
+    t = std::max(t, m_tick);
+
+    entry.m_tick = t;
+    entry.m_wheel = this;
+    insert(entry);
+    ++m_count;
+
+    if (!m_armed || t < m_armed_tick)
+        arm(t);
+}
+
+void TimerWheel::cancel(Entry& entry)
+{
+    if (entry.m_wheel != this)
+        return;
+
+    unlink(entry);
+    update_slot(*entry.m_head);
+    entry.m_head = nullptr;
+    entry.m_wheel = nullptr;
+    --m_count;
+
+    // the asio timer stays armed, waking up for nothing at worst once
+}
+
+void TimerWheel::arm(uint64_t t)
+{
+    m_armed = true;
+    m_armed_tick = t;
+    m_timer.expires_at(m_start + t * m_resolution);
+    m_timer.async_wait([this](const asio::error_code & error)
+    {
+        expire(error);
+    });
+}
+
+void TimerWheel::arm()
+{
+    m_armed = false;
+    if (!m_count)
+        return;
+
+    const auto t = next_tick();
+    if (t != UINT64_MAX)
+        arm(t);
+}
+
+void TimerWheel::expire(const asio::error_code& error)
+{
+    // the asio timer was armed again for an earlier tick
+    if (error)
+        return;
+
+    /*
+     * Move the expired timers to their own list in the order they expire, so
+     * that the timers that are cancelled by one that runs before them do not
+     * run.
+     */
+    advance(tick(Clock::now()) + 1);
+
+    while (m_expired.next != &m_expired)
+    {
+        auto entry = static_cast<Entry*>(m_expired.next);
+        unlink(*entry);
+        entry->m_head = nullptr;
+        entry->m_wheel = nullptr;
+        --m_count;
+
+        // this may schedule or cancel any timer
+        entry->callback();
+    }
+
+    arm();
+}
+
+TimerWheel::~TimerWheel() noexcept
+{
+    const auto clear = [](Link & head)
+    {
+        while (head.next != &head)
+        {
+            auto entry = static_cast<Entry*>(head.next);
+            unlink(*entry);
+            entry->m_head = nullptr;
+            entry->m_wheel = nullptr;
+        }
+    };
+
+    for (auto& head : m_ticks)
+        clear(head);
+    for (auto& head : m_blocks)
+        clear(head);
+    clear(m_expired);
+}
+
+}
+}
+}
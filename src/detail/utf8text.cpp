@@ -3,9 +3,19 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "detail/cairoabstraction.h"
+#include "detail/glyphatlas.h"
 #include "detail/utf8text.h"
 #include "egt/detail/layout.h"
 #include "egt/image.h"
+#include <cmath>
+#include <limits>
+#include <list>
+#include <unordered_map>
 
 namespace egt
 {
@@ -44,181 +54,476 @@ enum
     LAY_BREAK = 0x200
 };
 
+/*
+ * Text laid out in a box, ready to be drawn with a single cairo_show_glyphs().
+ *
+ * Everything is relative to the top left corner of the box, so a run can be
+ * drawn again wherever the box moves as long as its size does not change.
+ */
+struct GlyphRun
+{
+    /*
+     * Cell of a code point that counts as a cursor position.
+     */
+    struct Cell
+    {
+        /// Highlight rectangle of the code point.
+        RectF rect;
+        /// Cursor position before the code point.
+        Point cursor;
+    };
+
+    std::vector<cairo_glyph_t> glyphs;
+    std::vector<Cell> cells;
+    std::vector<Point> images;
+    /// Cursor position after the last code point.
+    Point end;
+    DefaultDim line_height{0};
+};
+
+/*
+ * Temporary buffers of build_glyph_run(), kept from one draw to the next so
+ * laying out text does not allocate once they are large enough.
+ */
+struct TextScratch
+{
+    std::vector<cairo_glyph_t> glyphs;
+    std::vector<float> advances;
+    /// Text of each rect in rects, an empty view for an image.
+    std::vector<std::string_view> tokens;
+    /// Rects laid out without their string, which is in tokens instead.
+    std::vector<detail::LayoutRect> rects;
+};
+
+static TextScratch text_scratch;
+
+/*
+ * Convert text to one glyph per code point with its advance.
+ *
+ * With the cairo toy font API there is one glyph per code point, but each
+ * code point is converted on its own if the font maps clusters otherwise.
+ */
+static void text_to_glyphs(cairo_t* cr,
+                           std::string_view text,
+                           std::vector<cairo_glyph_t>& glyphs,
+                           std::vector<float>& advances)
+{
+    const auto count = utf8len(text);
+    auto scaled_font = cairo_get_scaled_font(cr);
+
+    cairo_glyph_t* buffer = nullptr;
+    int num_glyphs = 0;
+    if (cairo_scaled_font_text_to_glyphs(scaled_font, 0, 0,
+                                         text.data(), text.size(),
+                                         &buffer, &num_glyphs,
+                                         nullptr, nullptr, nullptr) == CAIRO_STATUS_SUCCESS &&
+        static_cast<size_t>(num_glyphs) == count)
+    {
+        glyphs.assign(buffer, buffer + num_glyphs);
+    }
+    else
+    {
+        glyphs.clear();
+        for (size_t pos = 0; pos < text.size();)
+        {
+            const auto str = utf8_char_view(text, pos);
+            pos += str.size();
+            cairo_glyph_t* one = nullptr;
+            int num = 0;
+            cairo_glyph_t glyph{};
+            if (cairo_scaled_font_text_to_glyphs(scaled_font, 0, 0,
+                                                 str.data(), str.size(),
+                                                 &one, &num,
+                                                 nullptr, nullptr, nullptr) == CAIRO_STATUS_SUCCESS &&
+                num > 0)
+                glyph = one[0];
+            cairo_glyph_free(one);
+            glyphs.push_back(glyph);
+        }
+    }
+    cairo_glyph_free(buffer);
+
+    advances.resize(glyphs.size());
+    for (size_t i = 0; i < glyphs.size(); ++i)
+    {
+        cairo_glyph_t glyph = glyphs[i];
+        glyph.x = glyph.y = 0;
+        cairo_text_extents_t te;
+        cairo_glyph_extents(cr, &glyph, 1, &te);
+        advances[i] = te.x_advance;
+    }
+}
+
 static void draw_text_setup(std::vector<detail::LayoutRect>& rects,
-                            const Painter& painter,
-                            const std::string& text,
+                            std::vector<std::string_view>& tokens,
+                            const Font::FontExtents& fe,
+                            std::string_view text,
+                            const std::vector<float>& advances,
                             const TextBox::TextFlags& flags)
 {
-    const auto fe = painter.extents();
-
     // tokenize based on words or code points
-    static const std::string delimiters = " \t\n\r";
-    std::vector<std::string> tokens;
+    tokens.clear();
     if (flags.is_set(TextBox::TextFlag::multiline) &&
         flags.is_set(TextBox::TextFlag::word_wrap))
     {
-        detail::tokenize_with_delimiters(text.cbegin(),
-                                         text.cend(),
-                                         delimiters.cbegin(),
-                                         delimiters.cend(),
-                                         tokens);
+        detail::tokenize_with_delimiters(text, " \t\n\r", tokens);
     }
     else
     {
-        for (utf8_const_iterator ch(text.begin(), text.begin(), text.end());
-             ch != utf8_const_iterator(text.end(), text.begin(), text.end()); ++ch)
+        for (size_t pos = 0; pos < text.size();)
         {
-            tokens.emplace_back(utf8_char_to_string(ch.base(), text.cend()));
+            tokens.emplace_back(utf8_char_view(text, pos));
+            pos += tokens.back().size();
         }
     }
 
-    rects.reserve(tokens.size());
+    rects.clear();
+    rects.reserve(tokens.size() + 2);
 
     uint32_t default_behave = 0;
     uint32_t behave = default_behave;
 
+    size_t index = 0;
     for (const auto& t : tokens)
     {
+        const auto len = utf8len(t);
         if (t == "\n")
         {
-            rects.emplace_back(behave, Rect(0, 0, 1, fe.height), t);
+            rects.emplace_back(behave, Rect(0, 0, 1, fe.height));
             behave |= LAY_BREAK;
         }
         else
         {
-            const auto te = painter.extents(t);
-            rects.emplace_back(behave, Rect(0, 0, te.x_advance, fe.height), t);
+            float width = 0;
+            for (size_t i = index; i < index + len; ++i)
+                width += advances[i];
+            rects.emplace_back(behave, Rect(0, 0, width, fe.height));
             behave = default_behave;
         }
+        index += len;
     }
 }
 
 #define fl(f) static_cast<float>(f)
 
-void draw_text(Painter& painter,
-               const Rect& b,
-               const std::string& text,
-               const Font& font,
-               const TextBox::TextFlags& flags,
-               const AlignFlags& text_align,
-               Justification justify,
-               const Pattern& text_color,
-               const std::function<void(const Point& offset, size_t height)>& draw_cursor,
-               size_t cursor_pos,
-               const Pattern& highlight_color,
-               size_t select_start,
-               size_t select_len)
+/*
+ * Lay out the text and compute the position of every glyph, cursor position
+ * and highlight rectangle.
+ */
+static void build_glyph_run(GlyphRun& run,
+                            Painter& painter,
+                            const Size& size,
+                            std::string_view text,
+                            const TextBox::TextFlags& flags,
+                            const AlignFlags& text_align,
+                            Justification justify,
+                            const AlignFlags* image_align,
+                            const Size& image_size)
 {
-    painter.set(font);
     const auto fe = painter.extents();
+    run.glyphs.clear();
+    run.cells.clear();
+    run.images.clear();
+    run.end = {};
+    run.line_height = fe.height;
+
+    auto& glyphs = text_scratch.glyphs;
+    auto& advances = text_scratch.advances;
+    text_to_glyphs(painter.context(), text, glyphs, advances);
+
+    auto& rects = text_scratch.rects;
+    auto& tokens = text_scratch.tokens;
+    draw_text_setup(rects, tokens, fe, text, advances, flags);
+
+    /*
+     * The line break that separates the image from the text is not part of
+     * the text, so it does not consume a glyph.
+     */
+    auto inserted_break = std::numeric_limits<size_t>::max();
+    if (image_align)
+    {
+        if (image_align->is_set(AlignFlag::top))
+        {
+            detail::LayoutRect r(LAY_BREAK, Rect(0, 0, 1, fe.height));
+            rects.insert(rects.begin(), r);
+            tokens.insert(tokens.begin(), "\n");
 
-    std::vector<detail::LayoutRect> rects;
-
-    draw_text_setup(rects,
-                    painter,
-                    text,
-                    flags);
-
-    detail::flex_layout(b, rects, justify, Orientation::flex, text_align);
+            detail::LayoutRect r2(0, Rect(Point(), image_size));
+            rects.insert(rects.begin(), r2);
+            tokens.insert(tokens.begin(), {});
 
-    // draw the code points, cursor, and selected box
-    size_t pos = 0;
-    std::string last_char;
-    bool workaround = false;
-    for (const auto& r : rects)
-    {
-        float roff = 0.;
-        for (utf8_const_iterator ch(r.str.begin(), r.str.begin(), r.str.end());
-             ch != utf8_const_iterator(r.str.end(), r.str.begin(), r.str.end()); ++ch)
+            inserted_break = 1;
+        }
+        else if (image_align->is_set(AlignFlag::right))
+        {
+            rects.emplace_back(0, Rect(Point(), image_size));
+            tokens.emplace_back();
+        }
+        else if (image_align->is_set(AlignFlag::bottom))
         {
-            float char_width = 0;
-            last_char = utf8_char_to_string(ch.base(), r.str.cend());
+            inserted_break = rects.size();
+            rects.emplace_back(LAY_BREAK, Rect(0, 0, 1, fe.height));
+            tokens.emplace_back("\n");
+            rects.emplace_back(0, Rect(Point(), image_size));
+            tokens.emplace_back();
+        }
+        else
+        {
+            detail::LayoutRect r(0, Rect(Point(), image_size));
+            rects.insert(rects.begin(), r);
+            tokens.insert(tokens.begin(), {});
+        }
+    }
 
-            if (*ch != '\n')
-            {
-                const auto te = painter.extents(last_char);;
-                char_width = te.x_advance;
+    detail::flex_layout(Rect(Point(), size), rects, justify, Orientation::flex, text_align);
 
-                auto p = PointF(fl(b.x()) + fl(r.rect.x()) + roff + fl(te.x_bearing),
-                                fl(b.y()) + fl(r.rect.y()) + fl(te.y_bearing) - fl(fe.descent) + fl(fe.height));
+    run.glyphs.reserve(glyphs.size());
+    run.cells.reserve(glyphs.size());
 
-                if (workaround)
-                    p.y(p.y() + fl(fe.height));
+    size_t index = 0;
+    std::string_view last_char;
+    for (size_t i = 0; i < rects.size(); ++i)
+    {
+        const auto& r = rects[i];
+        const auto str = tokens[i];
+        if (str.empty())
+        {
+            run.images.push_back(r.rect.point());
+            continue;
+        }
 
-                auto s = SizeF(char_width, r.rect.height());
+        const size_t consumed = i == inserted_break ? 0 : 1;
 
-                if (pos >= select_start && pos < select_start + select_len)
-                {
-                    auto p2 = PointF(fl(b.x()) + fl(r.rect.x()) + roff,
-                                     fl(b.y()) + fl(r.rect.y()));
+        float roff = 0.;
+        for (size_t pos = 0; pos < str.size(); pos += last_char.size())
+        {
+            last_char = utf8_char_view(str, pos);
 
-                    if (workaround)
-                        p2.y(p2.y() + fl(fe.height));
+            if (last_char != "\n")
+            {
+                const auto char_width = advances[index];
 
-                    auto rect = RectF(p2, s);
-                    if (!rect.empty())
-                    {
-                        painter.draw(highlight_color, rect);
-                    }
-                }
+                cairo_glyph_t glyph = glyphs[index];
+                glyph.x = fl(r.rect.x()) + roff;
+                glyph.y = fl(r.rect.y()) - fl(fe.descent) + fl(fe.height);
+                run.glyphs.push_back(glyph);
 
-                painter.set(text_color);
-                painter.draw(p);
-                painter.draw(last_char);
+                const auto p = PointF(fl(r.rect.x()) + roff, fl(r.rect.y()));
+                run.cells.push_back({RectF(p, SizeF(char_width, r.rect.height())),
+                                     Point(r.rect.x() + roff, r.rect.y())});
 
                 roff += char_width;
             }
             else
             {
                 if (!flags.is_set(TextBox::TextFlag::multiline))
+                {
+                    index += consumed;
                     break;
+                }
 
-                // if first char is a "\n" layout doesn't respond right
-                if (last_char.empty())
-                    workaround = true;
+                run.cells.push_back({RectF(), Point(r.rect.x() + roff, r.rect.y())});
             }
 
-            // draw cursor if before current character
-            if (pos == cursor_pos)
-            {
-                if (draw_cursor)
-                {
-                    auto p = Point(b.x() + r.rect.x() + roff - char_width, b.y() + r.rect.y());
-                    draw_cursor(p, fe.height);
-                }
-            }
+            index += consumed;
+        }
+    }
 
-            pos++;
+    if (!rects.empty())
+    {
+        auto p = rects.back().rect.point() + Point(rects.back().rect.width(), 0);
+        if (last_char == "\n")
+        {
+            p.x(0);
+            p.y(p.y() + fe.height);
         }
+
+        run.end = p;
     }
+}
 
-    // handle cursor after last character
-    if (pos == cursor_pos)
+#undef fl
+
+/*
+ * Cache of glyph runs, most recently used first.
+ *
+ * The text of a key is a view, into the text being drawn to look up a run,
+ * and into a copy kept with the run in the cache, so a lookup does not copy
+ * the text.
+ */
+struct GlyphRunCache
+{
+    struct Key
     {
-        if (draw_cursor)
+        uint32_t font;
+        std::string_view text;
+        uint32_t flags;
+        Size size;
+        AlignFlags text_align;
+        Justification justify;
+        bool has_image;
+        AlignFlags image_align;
+        Size image_size;
+
+        bool operator==(const Key& rhs) const
         {
-            if (!rects.empty())
-            {
-                auto p = b.point() + rects.back().rect.point() + Point(rects.back().rect.width(), 0);
-                if (workaround)
-                {
-                    p.y(p.y() + fe.height);
-                }
+            return text == rhs.text &&
+                   font == rhs.font &&
+                   flags == rhs.flags &&
+                   size == rhs.size &&
+                   text_align == rhs.text_align &&
+                   justify == rhs.justify &&
+                   has_image == rhs.has_image &&
+                   image_align == rhs.image_align &&
+                   image_size == rhs.image_size;
+        }
+    };
 
-                if (last_char == "\n")
-                {
-                    p.x(b.x());
-                    p.y(p.y() + fe.height);
-                }
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            size_t h = std::hash<std::string_view>()(key.text);
+            h ^= key.font + 0x9e3779b9 + (h << 6) + (h >> 2);
+            h ^= (key.size.width() * 31 + key.size.height()) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
 
-                draw_cursor(p, fe.height);
-            }
-            else
-                draw_cursor(b.point(), fe.height);
+    const GlyphRun* find(const Key& key)
+    {
+        const auto i = index.find(key);
+        if (i == index.end())
+            return nullptr;
+
+        runs.splice(runs.begin(), runs, i->second);
+        return &i->second->run;
+    }
+
+    const GlyphRun& add(const Key& key, GlyphRun&& run)
+    {
+        runs.emplace_front();
+        auto& entry = runs.front();
+        entry.text = key.text;
+        entry.key = key;
+        entry.key.text = entry.text;
+        entry.run = std::move(run);
+        index.emplace(entry.key, runs.begin());
+
+        static constexpr auto MAX_CACHE_ITEMS = 64;
+        while (runs.size() > MAX_CACHE_ITEMS)
+        {
+            index.erase(runs.back().key);
+            runs.pop_back();
         }
+
+        return entry.run;
     }
+
+private:
+    struct Entry
+    {
+        std::string text;
+        Key key{};
+        GlyphRun run;
+    };
+
+    using RunList = std::list<Entry>;
+    RunList runs;
+    std::unordered_map<Key, RunList::iterator, KeyHash> index;
+};
+
+static GlyphRunCache glyph_run_cache;
+
+static const GlyphRun& glyph_run(Painter& painter,
+                                 const Size& size,
+                                 const std::string& text,
+                                 const Font& font,
+                                 const TextBox::TextFlags& flags,
+                                 const AlignFlags& text_align,
+                                 Justification justify,
+                                 const AlignFlags* image_align = nullptr,
+                                 const Size& image_size = {})
+{
+    // very long text, like a document in a TextBox, is not worth keeping
+    static constexpr auto MAX_CACHE_ITEM_SIZE = 1024;
+    if (text.size() >= MAX_CACHE_ITEM_SIZE)
+    {
+        // reused, so that drawing it again does not allocate
+        static GlyphRun scratch;
+        build_glyph_run(scratch, painter, size, text, flags,
+                        text_align, justify, image_align, image_size);
+        return scratch;
+    }
+
+    const GlyphRunCache::Key key{font.id(), text, flags.raw(), size,
+                                 text_align, justify,
+                                 image_align != nullptr,
+                                 image_align ? *image_align : AlignFlags(),
+                                 image_size};
+
+    auto run = glyph_run_cache.find(key);
+    if (run)
+        return *run;
+
+    GlyphRun result;
+    build_glyph_run(result, painter, size, text, flags,
+                    text_align, justify, image_align, image_size);
+    return glyph_run_cache.add(key, std::move(result));
 }
 
+static void draw_glyph_run(Painter& painter,
+                           const GlyphRun& run,
+                           const Rect& b,
+                           const Pattern& text_color,
+                           const Image* image,
+                           const std::function<void(const Point& offset, size_t height)>& draw_cursor,
+                           size_t cursor_pos,
+                           const Pattern& highlight_color,
+                           size_t select_start,
+                           size_t select_len)
+{
+    if (image)
+    {
+        for (const auto& p : run.images)
+            painter.draw(*image, b.point() + p);
+    }
+
+    // draw the selected box
+    const auto select_end = std::min(select_start + select_len, run.cells.size());
+    for (auto pos = select_start; pos < select_end; ++pos)
+    {
+        auto rect = run.cells[pos].rect;
+        if (!rect.empty())
+        {
+            rect.point(rect.point() + PointF(b.x(), b.y()));
+            painter.draw(highlight_color, rect);
+        }
+    }
+
+    // draw the code points
+    if (!run.glyphs.empty())
+    {
+        painter.sync_for_cpu();
+        painter.set(text_color);
+
+        Painter::AutoSaveRestore sr(painter);
+        cairo_t* cr = painter.context();
+        cairo_translate(cr, b.x(), b.y());
+        if (text_renderer() != TextRenderer::glyph_atlas ||
+            !draw_atlas_glyphs(painter, run.glyphs.data(), run.glyphs.size(), text_color))
+            cairo_show_glyphs(cr, run.glyphs.data(), run.glyphs.size());
+    }
+
+    // draw the cursor
+    if (draw_cursor)
+    {
+        if (cursor_pos < run.cells.size())
+            draw_cursor(b.point() + run.cells[cursor_pos].cursor, run.line_height);
+        else if (cursor_pos == run.cells.size())
+            draw_cursor(b.point() + run.end, run.line_height);
+    }
+}
 
 void draw_text(Painter& painter,
                const Rect& b,
@@ -228,8 +533,6 @@ void draw_text(Painter& painter,
                const AlignFlags& text_align,
                Justification justify,
                const Pattern& text_color,
-               const AlignFlags& image_align,
-               const Image& image,
                const std::function<void(const Point& offset, size_t height)>& draw_cursor,
                size_t cursor_pos,
                const Pattern& highlight_color,
@@ -237,145 +540,128 @@ void draw_text(Painter& painter,
                size_t select_len)
 {
     painter.set(font);
-    const auto fe = painter.extents();
 
-    std::vector<detail::LayoutRect> rects;
+    const auto& run = glyph_run(painter, b.size(), text, font, flags,
+                                text_align, justify);
 
-    draw_text_setup(rects,
-                    painter,
-                    text,
-                    flags);
+    draw_glyph_run(painter, run, b, text_color, nullptr,
+                   draw_cursor, cursor_pos,
+                   highlight_color, select_start, select_len);
+}
 
-    if (image_align.is_set(AlignFlag::top))
-    {
-        detail::LayoutRect r(LAY_BREAK, Rect(0, 0, 1, fe.height), "\n");
-        rects.insert(rects.begin(), r);
+static inline bool integral(double value)
+{
+    return std::floor(value) == value;
+}
 
-        detail::LayoutRect r2(0, Rect(Point(), image.size()));
-        rects.insert(rects.begin(), r2);
-    }
-    else if (image_align.is_set(AlignFlag::right))
-    {
-        rects.emplace_back(0, Rect(Point(), image.size()));
-    }
-    else if (image_align.is_set(AlignFlag::bottom))
-    {
-        rects.emplace_back(LAY_BREAK, Rect(0, 0, 1, fe.height), "\n");
-        rects.emplace_back(0, Rect(Point(), image.size()));
-    }
-    else
+static void render_text_mask(TextMask& mask, Painter& painter, const GlyphRun& run)
+{
+    mask.mask = Surface(Size(), PixelFormat::a8);
+
+    if (run.glyphs.empty())
+        return;
+
+    cairo_text_extents_t te;
+    cairo_glyph_extents(painter.context(), run.glyphs.data(), run.glyphs.size(), &te);
+    if (te.width <= 0 || te.height <= 0)
+        return;
+
+    // one pixel of margin for antialiasing
+    const auto left = static_cast<DefaultDim>(std::floor(te.x_bearing)) - 1;
+    const auto top = static_cast<DefaultDim>(std::floor(te.y_bearing)) - 1;
+    const auto width = static_cast<DefaultDim>(std::ceil(te.x_bearing + te.width)) - left + 1;
+    const auto height = static_cast<DefaultDim>(std::ceil(te.y_bearing + te.height)) - top + 1;
+
+    mask.origin = Point(left, top);
+    mask.mask = Surface(Size(width, height), PixelFormat::a8);
+    mask.mask.zero();
+
+    unique_cairo_t cr(cairo_create(mask.mask.impl()));
+    cairo_set_scaled_font(cr.get(), cairo_get_scaled_font(painter.context()));
+    cairo_translate(cr.get(), -left, -top);
+    cairo_show_glyphs(cr.get(), run.glyphs.data(), run.glyphs.size());
+    cr.reset();
+    mask.mask.flush(true);
+}
+
+void draw_text(Painter& painter,
+               std::unique_ptr<TextMask>& mask,
+               const Rect& b,
+               const std::string& text,
+               const Font& font,
+               const TextBox::TextFlags& flags,
+               const AlignFlags& text_align,
+               Justification justify,
+               const Pattern& text_color)
+{
+    /*
+     * The mask is painted at a whole pixel offset, which gives the same
+     * result as drawing the glyphs only without scaling or rotation.
+     */
+    cairo_t* cr = painter.context();
+    cairo_matrix_t matrix;
+    cairo_get_matrix(cr, &matrix);
+    if (matrix.xx != 1. || matrix.yy != 1. || matrix.xy != 0. || matrix.yx != 0. ||
+        !integral(matrix.x0) || !integral(matrix.y0))
     {
-        detail::LayoutRect r(0, Rect(Point(), image.size()));
-        rects.insert(rects.begin(), r);
+        draw_text(painter, b, text, font, flags, text_align, justify, text_color);
+        return;
     }
 
-    detail::flex_layout(b, rects, justify, Orientation::flex, text_align);
-
-    // draw the code points, cursor, and selected box
-    size_t pos = 0;
-    std::string last_char;
-    bool workaround = false;
-    for (const auto& r : rects)
+    const auto font_id = font.id();
+    if (!mask ||
+        mask->key.font != font_id ||
+        mask->key.text != text ||
+        mask->key.flags != flags.raw() ||
+        mask->key.size != b.size() ||
+        mask->key.text_align != text_align ||
+        mask->key.justify != justify)
     {
-        if (r.str.empty())
-        {
-            auto p = Point(b.x() + r.rect.x(),
-                           b.y() + r.rect.y());
-
-            painter.draw(image, p);
-            continue;
-        }
-
-        float roff = 0.;
-        for (utf8_const_iterator ch(r.str.begin(), r.str.begin(), r.str.end());
-             ch != utf8_const_iterator(r.str.end(), r.str.begin(), r.str.end()); ++ch)
-        {
-            float char_width = 0;
-            last_char = utf8_char_to_string(ch.base(), r.str.cend());
-
-            if (*ch != '\n')
-            {
-                const auto te = painter.extents(last_char);
-                char_width = te.x_advance;
-
-                auto p = PointF(fl(b.x()) + fl(r.rect.x()) + roff + fl(te.x_bearing),
-                                fl(b.y()) + fl(r.rect.y()) + fl(te.y_bearing) - fl(fe.descent) + fl(fe.height));
-
-                if (workaround)
-                    p.y(p.y() + fl(fe.height));
-
-                auto s = SizeF(char_width, r.rect.height());
-
-                if (pos >= select_start && pos < select_start + select_len)
-                {
-                    auto p2 = PointF(fl(b.x()) + fl(r.rect.x()) + roff,
-                                     fl(b.y()) + fl(r.rect.y()));
-
-                    if (workaround)
-                        p2.y(p2.y() + fl(fe.height));
-
-                    auto rect = RectF(p2, s);
-                    if (!rect.empty())
-                    {
-                        painter.draw(highlight_color, rect);
-                    }
-                }
+        if (!mask)
+            mask = std::make_unique<TextMask>();
 
-                painter.set(text_color);
-                painter.draw(p);
-                painter.draw(last_char);
-
-                roff += char_width;
-            }
-            else
-            {
-                if (!flags.is_set(TextBox::TextFlag::multiline))
-                    break;
+        painter.set(font);
 
-                // if first char is a "\n" layout doesn't respond right
-                if (last_char.empty())
-                    workaround = true;
-            }
+        const auto& run = glyph_run(painter, b.size(), text, font, flags,
+                                    text_align, justify);
+        render_text_mask(*mask, painter, run);
+        mask->key = TextMask::Key{font_id, text, flags.raw(), b.size(), text_align, justify};
+    }
 
-            // draw cursor if before current character
-            if (pos == cursor_pos)
-            {
-                if (draw_cursor)
-                {
-                    auto p = Point(b.x() + r.rect.x() + roff - char_width, b.y() + r.rect.y());
-                    draw_cursor(p, fe.height);
-                }
-            }
+    if (mask->mask.empty())
+        return;
 
-            pos++;
-        }
-    }
+    painter.sync_for_cpu();
+    painter.set(text_color);
+    cairo_mask_surface(cr, mask->mask.impl(),
+                       b.x() + mask->origin.x(),
+                       b.y() + mask->origin.y());
+}
 
-    // handle cursor after last character
-    if (pos == cursor_pos)
-    {
-        if (draw_cursor)
-        {
-            if (!rects.empty())
-            {
-                auto p = b.point() + rects.back().rect.point() + Point(rects.back().rect.width(), 0);
-                if (workaround)
-                {
-                    p.y(p.y() + fe.height);
-                }
+void draw_text(Painter& painter,
+               const Rect& b,
+               const std::string& text,
+               const Font& font,
+               const TextBox::TextFlags& flags,
+               const AlignFlags& text_align,
+               Justification justify,
+               const Pattern& text_color,
+               const AlignFlags& image_align,
+               const Image& image,
+               const std::function<void(const Point& offset, size_t height)>& draw_cursor,
+               size_t cursor_pos,
+               const Pattern& highlight_color,
+               size_t select_start,
+               size_t select_len)
+{
+    painter.set(font);
 
-                if (last_char == "\n")
-                {
-                    p.x(b.x());
-                    p.y(p.y() + fe.height);
-                }
+    const auto& run = glyph_run(painter, b.size(), text, font, flags,
+                                text_align, justify, &image_align, image.size());
 
-                draw_cursor(p, fe.height);
-            }
-            else
-                draw_cursor(b.point(), fe.height);
-        }
-    }
+    draw_glyph_run(painter, run, b, text_color, &image,
+                   draw_cursor, cursor_pos,
+                   highlight_color, select_start, select_len);
 }
 
 }
@@ -7,9 +7,11 @@
 #define EGT_SRC_DETAIL_UTF8TEXT_H
 
 #include "egt/painter.h"
+#include "egt/surface.h"
 #include "egt/text.h"
 #include <functional>
 #include <string>
+#include <string_view>
 #include <utf8.h>
 #include <vector>
 
@@ -26,45 +28,49 @@ using utf8_iterator = utf8::iterator<std::string::iterator>;
 /**
  * Returns the length of a utf-8 encoded string.
  */
-inline size_t utf8len(const std::string& str)
+inline size_t utf8len(std::string_view str)
 {
     return utf8::distance(str.begin(), str.end());
 }
 
 /**
- * Convert a UTF-8 iterator to a standalone std::string.
+ * Get the code point at a position in a utf-8 encoded string, as a view into
+ * the string.
+ *
+ * @param[in] str The string.
+ * @param[in] pos Offset of the code point in bytes.
  */
-template<class T1, class T2>
-std::string utf8_char_to_string(T1 ch, T2 e)
+inline std::string_view utf8_char_view(std::string_view str, size_t pos)
 {
-    auto ch2 = ch;
-    utf8::advance(ch2, 1, e);
-    return std::string(ch.base(), ch2.base());
+    auto end = str.begin() + pos;
+    utf8::advance(end, 1, str.end());
+    return str.substr(pos, end - str.begin() - pos);
 }
 
 /**
  * Special UTF-8 aware string tokenizer which keeps delimiters as tokens.
  *
- * @param[in] begin Input string begin iterator.
- * @param[in] end Input string end iterator.
- * @param[in] dbegin  Delimiter string begin iterator.
- * @param[in] dend Delimiter string end iterator.
- * @param[out] tokens The resulting string tokens.
+ * Tokens are views into @p str, so they are only valid as long as @p str is.
+ *
+ * @param[in] str Input string.
+ * @param[in] delimiters Delimiter code points.
+ * @param[out] tokens The resulting tokens.
  */
-template<class T, class Container>
-void tokenize_with_delimiters(T begin, T end,
-                              T dbegin, T dend,
+template<class Container>
+void tokenize_with_delimiters(std::string_view str,
+                              std::string_view delimiters,
                               Container& tokens)
 {
-    std::string token;
+    auto token = str.begin();
 
-    for (auto pos = begin; pos != end;)
+    for (auto pos = str.begin(); pos != str.end();)
     {
         bool found = false;
-        const auto ch = utf8::next(pos, end);
-        for (auto d = dbegin; d != dend;)
+        const auto start = pos;
+        const auto ch = utf8::next(pos, str.end());
+        for (auto d = delimiters.begin(); d != delimiters.end();)
         {
-            auto del = utf8::next(d, dend);
+            auto del = utf8::next(d, delimiters.end());
             if (del == ch)
             {
                 found = true;
@@ -74,26 +80,54 @@ void tokenize_with_delimiters(T begin, T end,
 
         if (found)
         {
-            if (!token.empty())
-            {
-                tokens.emplace_back(std::move(token));
-                token.clear();
-            }
+            if (token != start)
+                tokens.emplace_back(str.substr(token - str.begin(), start - token));
 
-            std::string tmp;
-            utf8::append(ch, std::back_inserter(tmp));
-            tokens.emplace_back(tmp);
-        }
-        else
-        {
-            utf8::append(ch, std::back_inserter(token));
+            tokens.emplace_back(str.substr(start - str.begin(), pos - start));
+            token = pos;
         }
     }
 
-    if (!token.empty())
-        tokens.emplace_back(token);
+    if (token != str.end())
+        tokens.emplace_back(str.substr(token - str.begin()));
 }
 
+/**
+ * Text rendered by draw_text() into an A8 mask, kept by a widget to paint its
+ * text again without rasterizing glyphs.
+ */
+class TextMask
+{
+public:
+
+    /// What the mask was rendered for, the color excepted.
+    struct Key
+    {
+        uint32_t font{0};
+        std::string text;
+        uint32_t flags{0};
+        Size size;
+        AlignFlags text_align;
+        Justification justify{Justification::start};
+
+        bool operator==(const Key& rhs) const
+        {
+            return font == rhs.font &&
+                   text == rhs.text &&
+                   flags == rhs.flags &&
+                   size == rhs.size &&
+                   text_align == rhs.text_align &&
+                   justify == rhs.justify;
+        }
+    };
+
+    Key key;
+    /// Coverage of the text, empty if nothing is drawn.
+    Surface mask{Size(), PixelFormat::a8};
+    /// Position of the mask relative to the text box.
+    Point origin;
+};
+
 }
 }
 }
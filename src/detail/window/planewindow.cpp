@@ -43,6 +43,7 @@ void PlaneWindow::resize(const Size& size)
         }
 
         m_interface->m_box.size(size);
+        m_interface->update_parent_spatial_index();
         m_interface->damage();
     }
 }
@@ -75,6 +76,7 @@ void PlaneWindow::scale(float scalex, float scaley)
             auto w = m_interface->user_requested_box().width() * scalex;
             auto h = m_interface->user_requested_box().height() * scaley;
             m_interface->m_box.size(Size(w, h));
+            m_interface->update_parent_spatial_index();
         }
     }
 }
@@ -84,6 +86,7 @@ void PlaneWindow::move(const Point& point)
     if (point != m_interface->box().point())
     {
         m_interface->m_box.point(point);
+        m_interface->update_parent_spatial_index();
         m_dirty = true;
     }
 }
@@ -17,7 +17,7 @@ Dialog::Dialog(const Rect& rect) noexcept
       m_button1("OK"),
       m_button2("Cancel")
 {
-    name("Dialog" + std::to_string(m_widgetid));
+    name_prefix("Dialog");
     initialize();
 }
 
@@ -7,10 +7,12 @@
 #include "detail/egtlog.h"
 #include "detail/priorityqueue.h"
 #include "egt/app.h"
+#include "egt/detail/timerwheel.h"
 #include "egt/eventloop.h"
 #include "egt/tools.h"
 #include "egt/widget.h"
 #include "egt/window.h"
+#include <algorithm>
 #include <cstdlib>
 #include <egt/asio.hpp>
 #include <numeric>
@@ -25,6 +27,9 @@ struct EventLoop::EventLoopImpl
     asio::io_context m_io;
     asio::executor_work_guard<asio::io_context::executor_type> m_work{egt::asio::make_work_guard(m_io)};
     detail::PriorityQueue m_queue;
+    std::unique_ptr<detail::TimerWheel> m_timer_wheel;
+    bool m_timer_wheel_checked{false};
+    std::vector<EventLoop::FrameCallback> m_frame_callbacks;
 };
 
 EventLoop::EventLoop(const Application& app) noexcept
@@ -101,6 +106,14 @@ void EventLoop::draw()
 {
     detail::code_timer(time_event_loop_enabled(), "draw: ", [this]()
     {
+        // callbacks may add callbacks
+        auto& callbacks = m_impl->m_frame_callbacks;
+        for (size_t i = 0; i < callbacks.size(); ++i)
+            callbacks[i]();
+
+        // all the layout requested since the last frame, done once
+        Widget::flush_layout_requests();
+
         for (auto& w : m_app.windows())
         {
             if (!w->visible())
@@ -190,6 +203,11 @@ void EventLoop::add_idle_callback(IdleCallback func)
     m_idle.emplace_back(std::move(func));
 }
 
+void EventLoop::add_frame_callback(FrameCallback func)
+{
+    m_impl->m_frame_callbacks.emplace_back(std::move(func));
+}
+
 void EventLoop::invoke_idle_callbacks()
 {
     for (auto& i : m_idle)
@@ -201,6 +219,24 @@ detail::PriorityQueue& EventLoop::queue()
     return m_impl->m_queue;
 }
 
+detail::TimerWheel* EventLoop::timer_wheel()
+{
+    if (!m_impl->m_timer_wheel_checked)
+    {
+        m_impl->m_timer_wheel_checked = true;
+
+        // the value is the resolution of the wheel in milliseconds
+        if (auto value = std::getenv("EGT_TIMER_WHEEL"))
+        {
+            const auto resolution = std::max(1, std::atoi(value));
+            m_impl->m_timer_wheel = std::make_unique<detail::TimerWheel>(m_impl->m_io,
+                                    std::chrono::milliseconds(resolution));
+        }
+    }
+
+    return m_impl->m_timer_wheel.get();
+}
+
 EventLoop::~EventLoop() noexcept = default;
 
 }
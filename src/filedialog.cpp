@@ -24,7 +24,7 @@ FileDialog::FileDialog(const std::string& filepath, const Rect& rect) noexcept
       m_flist(std::make_shared<egt::ListBox>()),
       m_filepath(filepath)
 {
-    name("FileDialog" + std::to_string(m_widgetid));
+    name_prefix("FileDialog");
     initialize();
 }
 
@@ -178,7 +178,7 @@ void FileDialog::deserialize(Serializer::Properties& props)
 FileOpenDialog::FileOpenDialog(const std::string& filepath, const Rect& rect) noexcept
     : FileDialog(filepath, rect)
 {
-    name("FileOpenDialog" + std::to_string(m_widgetid));
+    name_prefix("FileOpenDialog");
     initialize();
 }
 
@@ -226,7 +226,7 @@ FileSaveDialog::FileSaveDialog(const std::string& filepath, const Rect& rect) no
     : FileDialog(filepath, rect),
       m_fsave_box("", Size(rect.width() * 0.50, rect.height() * 0.15))
 {
-    name("FileSaveDialog" + std::to_string(m_widgetid));
+    name_prefix("FileSaveDialog");
     initialize();
 }
 
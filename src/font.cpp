@@ -7,18 +7,27 @@
 #include "config.h"
 #endif
 
+#include "detail/bitmapfont.h"
 #include "detail/cairoabstraction.h"
 #include "detail/egtlog.h"
+#ifdef HAVE_FONTCONFIG
+#include "detail/fontmatch.h"
+#endif
+#include "detail/mappedfile.h"
 #include "detail/painter.h"
 #include "egt/app.h"
 #include "egt/detail/enum.h"
 #include "egt/font.h"
+#include "egt/resource.h"
 #include "egt/respath.h"
 #include "egt/screen.h"
 #include "egt/serialize.h"
+#include <algorithm>
 #include <cairo-ft.h>
 #include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace egt
 {
@@ -68,18 +77,10 @@ static void ft_done_face_uncached(void* closure)
     FT_Done_Face(face);
 }
 
-static detail::InternalFont create_ft_font(cairo_t* cr,
-        FT_Face& face,
+static detail::InternalFont create_face_scaled_font(cairo_t* cr,
+        cairo_font_face_t* font_face,
         const Font& font)
 {
-    std::unique_ptr<cairo_font_face_t, decltype(cairo_font_face_destroy)*>
-    font_face(cairo_ft_font_face_create_for_ft_face(face, FT_LOAD_NO_HINTING | FT_LOAD_NO_BITMAP),
-              cairo_font_face_destroy);
-
-    static const cairo_user_data_key_t key{};
-    if (cairo_font_face_set_user_data(font_face.get(), &key, face, ft_done_face_uncached))
-        return nullptr;
-
     std::unique_ptr<cairo_font_options_t, decltype(cairo_font_options_destroy)*>
     font_options(cairo_font_options_create(), cairo_font_options_destroy);
     cairo_get_font_options(cr, font_options.get());
@@ -91,7 +92,7 @@ static detail::InternalFont create_ft_font(cairo_t* cr,
     cairo_matrix_init_scale(&size_matrix, font.size(), font.size());
     cairo_matrix_init_identity(&identity_matrix);
 
-    detail::InternalFont scaled_font(cairo_scaled_font_create(font_face.get(),
+    detail::InternalFont scaled_font(cairo_scaled_font_create(font_face,
                                      &size_matrix,
                                      &identity_matrix,
                                      font_options.get()));
@@ -101,6 +102,170 @@ static detail::InternalFont create_ft_font(cairo_t* cr,
     return scaled_font;
 }
 
+static detail::InternalFont create_ft_font(cairo_t* cr,
+        FT_Face& face,
+        const Font& font)
+{
+    std::unique_ptr<cairo_font_face_t, decltype(cairo_font_face_destroy)*>
+    font_face(cairo_ft_font_face_create_for_ft_face(face, FT_LOAD_NO_HINTING | FT_LOAD_NO_BITMAP),
+              cairo_font_face_destroy);
+
+    static const cairo_user_data_key_t key{};
+    if (cairo_font_face_set_user_data(font_face.get(), &key, face, ft_done_face_uncached))
+        return nullptr;
+
+    return create_face_scaled_font(cr, font_face.get(), font);
+}
+
+/*
+ * Bitmap fonts are cairo user fonts painting the coverage of their glyphs, so
+ * they are measured and drawn like any other font without FreeType.
+ */
+struct BitmapFontFace
+{
+    detail::BitmapFont font;
+    /// Set when the font is read from a file.
+    std::unique_ptr<detail::MappedFile> file;
+    /// Coverage of every glyph, decoded when the glyph is first rendered.
+    std::vector<unique_cairo_surface_t> coverage;
+    /// Size of the font in pixels, which is the em size of the user font.
+    double size{1};
+};
+
+static const cairo_user_data_key_t bitmap_font_key{};
+
+static BitmapFontFace& bitmap_font_face(cairo_scaled_font_t* scaled_font)
+{
+    return *static_cast<BitmapFontFace*>(cairo_font_face_get_user_data(
+            cairo_scaled_font_get_font_face(scaled_font), &bitmap_font_key));
+}
+
+static cairo_status_t bitmap_font_init(cairo_scaled_font_t* scaled_font,
+                                       cairo_t* /*cr*/,
+                                       cairo_font_extents_t* extents)
+{
+    const auto& face = bitmap_font_face(scaled_font);
+    const auto& metrics = face.font.metrics();
+
+    extents->ascent = detail::BitmapFont::from_fixed(metrics.ascent) / face.size;
+    extents->descent = detail::BitmapFont::from_fixed(metrics.descent) / face.size;
+    extents->height = detail::BitmapFont::from_fixed(metrics.height) / face.size;
+
+    int32_t max_advance = 0;
+    for (size_t i = 0; i < face.font.count(); ++i)
+        max_advance = std::max(max_advance, face.font.glyph(i).advance);
+    extents->max_x_advance = detail::BitmapFont::from_fixed(max_advance) / face.size;
+    extents->max_y_advance = 0;
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t bitmap_font_unicode_to_glyph(cairo_scaled_font_t* scaled_font,
+        unsigned long unicode,
+        unsigned long* glyph_index)
+{
+    const auto& font = bitmap_font_face(scaled_font).font;
+
+    // glyph 0 stands for code points missing in the font
+    auto index = font.find(unicode);
+    if (index == font.count())
+        index = font.find(0xfffd);
+    if (index == font.count())
+        index = font.find('?');
+    *glyph_index = index == font.count() ? 0 : index + 1;
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t bitmap_font_render_glyph(cairo_scaled_font_t* scaled_font,
+        unsigned long glyph_index,
+        cairo_t* cr,
+        cairo_text_extents_t* extents)
+{
+    auto& face = bitmap_font_face(scaled_font);
+    if (!glyph_index || glyph_index > face.font.count())
+    {
+        extents->x_advance = 0.5;
+        return CAIRO_STATUS_SUCCESS;
+    }
+
+    const auto glyph = face.font.glyph(glyph_index - 1);
+    extents->x_bearing = glyph.left / face.size;
+    extents->y_bearing = glyph.top / face.size;
+    extents->width = glyph.width / face.size;
+    extents->height = glyph.height / face.size;
+    extents->x_advance = detail::BitmapFont::from_fixed(glyph.advance) / face.size;
+    extents->y_advance = 0;
+
+    if (!glyph.width || !glyph.height)
+        return CAIRO_STATUS_SUCCESS;
+
+    auto& coverage = face.coverage[glyph_index - 1];
+    if (!coverage)
+    {
+        coverage.reset(cairo_image_surface_create(CAIRO_FORMAT_A8, glyph.width, glyph.height));
+        if (cairo_surface_status(coverage.get()))
+            return CAIRO_STATUS_NO_MEMORY;
+
+        cairo_surface_flush(coverage.get());
+        face.font.decode(glyph,
+                         cairo_image_surface_get_data(coverage.get()),
+                         cairo_image_surface_get_stride(coverage.get()));
+        cairo_surface_mark_dirty(coverage.get());
+    }
+
+    // the user font is drawn in em units
+    cairo_scale(cr, 1. / face.size, 1. / face.size);
+    cairo_mask_surface(cr, coverage.get(), glyph.left, glyph.top);
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+/*
+ * Font faces of the bitmap fonts, kept for the life of the application like
+ * the data of the fonts.
+ */
+static std::map<std::string, std::shared_ptr<cairo_font_face_t>> bitmap_font_faces;
+
+static detail::InternalFont create_bitmap_scaled_font(cairo_t* cr,
+        const std::string& key,
+        const unsigned char* data,
+        size_t len,
+        std::unique_ptr<detail::MappedFile> file,
+        const Font& font)
+{
+    auto i = bitmap_font_faces.find(key);
+    if (i == bitmap_font_faces.end())
+    {
+        EGTLOG_DEBUG("allocating bitmap font: {}", font.face());
+
+        auto face = std::make_unique<BitmapFontFace>();
+        face->file = std::move(file);
+        if (!face->font.open(data, len))
+        {
+            detail::error("invalid bitmap font {}", font.face());
+            return nullptr;
+        }
+        face->size = detail::BitmapFont::from_fixed(face->font.metrics().size);
+        face->coverage.resize(face->font.count());
+
+        std::shared_ptr<cairo_font_face_t> font_face(cairo_user_font_face_create(),
+                cairo_font_face_destroy);
+        cairo_user_font_face_set_init_func(font_face.get(), bitmap_font_init);
+        cairo_user_font_face_set_unicode_to_glyph_func(font_face.get(), bitmap_font_unicode_to_glyph);
+        cairo_user_font_face_set_render_glyph_func(font_face.get(), bitmap_font_render_glyph);
+
+        if (cairo_font_face_set_user_data(font_face.get(), &bitmap_font_key, face.get(),
+                                          [](void* data) { delete static_cast<BitmapFontFace*>(data); }))
+            return nullptr;
+        face.release();
+
+        i = bitmap_font_faces.emplace(key, std::move(font_face)).first;
+    }
+
+    return create_face_scaled_font(cr, i->second.get(), font);
+}
+
 static detail::InternalFont create_ft_scaled_font(cairo_t* cr,
         const char* path,
         const Font& font)
@@ -139,66 +304,58 @@ static detail::InternalFont create_ft_scaled_font(cairo_t* cr,
     return create_ft_font(cr, face, font);
 }
 
-#ifdef HAVE_FONTCONFIG
-static detail::InternalFont create_scaled_font(cairo_t* cr, const Font& font)
+static detail::InternalFont create_file_scaled_font(cairo_t* cr,
+        const std::string& path,
+        const Font& font)
 {
-    EGTLOG_DEBUG("allocating font using Fontconfig: {}", font.face());
-
-    std::unique_ptr<cairo_font_options_t, decltype(cairo_font_options_destroy)*>
-    font_options(cairo_font_options_create(), cairo_font_options_destroy);
-    cairo_get_font_options(cr, font_options.get());
+    if (detail::BitmapFont::is_bitmap_font(path))
+    {
+        std::unique_ptr<detail::MappedFile> file;
+        try
+        {
+            file = std::make_unique<detail::MappedFile>(path);
+        }
+        catch (const std::runtime_error& e)
+        {
+            detail::error("error opening font {}: {}", path, e.what());
+            return nullptr;
+        }
 
-    std::unique_ptr<FcPattern, decltype(FcPatternDestroy)*>
-    pattern(FcPatternCreate(), FcPatternDestroy);
-    if (!pattern)
-        return nullptr;
+        const auto data = file->data();
+        const auto len = file->size();
+        return create_bitmap_scaled_font(cr, path, data, len, std::move(file), font);
+    }
 
-    // NOLINTNEXTLINE
-    FcPatternAddString(pattern.get(), FC_FAMILY, (const FcChar8*)(font.face().c_str()));
-    FcPatternAddDouble(pattern.get(), FC_SIZE, font.size());
+    return create_ft_scaled_font(cr, path.c_str(), font);
+}
 
-    int weight = FC_WEIGHT_NORMAL;
-    switch (font.weight())
+static detail::InternalFont create_memory_scaled_font(cairo_t* cr,
+        const unsigned char* data,
+        size_t len,
+        const Font& font)
+{
+    if (detail::BitmapFont::is_bitmap_font(data, len))
     {
-    case Font::Weight::normal:
-        break;
-    case Font::Weight::bold:
-        weight = FC_WEIGHT_BOLD;
-        break;
+        const auto key = std::to_string(reinterpret_cast<uintptr_t>(data));
+        return create_bitmap_scaled_font(cr, key, data, len, nullptr, font);
     }
-    FcPatternAddInteger(pattern.get(), FC_WEIGHT, weight);
 
-    int slant = FC_SLANT_ROMAN;
-    switch (font.slant())
-    {
-    case Font::Slant::normal:
-        break;
-    case Font::Slant::italic:
-        slant = FC_SLANT_ITALIC;
-        break;
-    case Font::Slant::oblique:
-        slant = FC_SLANT_OBLIQUE;
-        break;
-    }
-    FcPatternAddInteger(pattern.get(), FC_SLANT, slant);
+    return create_ft_scaled_font(cr, data, len, font);
+}
+
+#ifdef HAVE_FONTCONFIG
+static detail::InternalFont create_scaled_font(cairo_t* cr, const Font& font)
+{
+    EGTLOG_DEBUG("allocating font: {}", font.face());
 
-    FcConfigSubstitute(nullptr, pattern.get(), FcMatchPattern);
-    cairo_ft_font_options_substitute(font_options.get(), pattern.get());
-    FcDefaultSubstitute(pattern.get());
-    FcResult result;
+    std::unique_ptr<cairo_font_options_t, decltype(cairo_font_options_destroy)*>
+    font_options(cairo_font_options_create(), cairo_font_options_destroy);
+    cairo_get_font_options(cr, font_options.get());
 
-    std::unique_ptr<FcPattern, decltype(FcPatternDestroy)*>
-    resolved(FcFontMatch(nullptr, pattern.get(), &result), FcPatternDestroy);
+    auto resolved = detail::FontMatchCache::instance().match(font, font_options.get());
     if (!resolved)
         return nullptr;
 
-    char* face = nullptr;
-    if (FcPatternGetString(resolved.get(), FC_FULLNAME, 0, reinterpret_cast<FcChar8**>(&face)) == FcResultMatch)
-    {
-        if (font.face() != std::string(face))
-            EGTLOG_DEBUG("Font \"{}\" not found: using default {} font", font.face(), face);
-    }
-
     double pixel_size;
     FcPatternGetDouble(resolved.get(), FC_PIXEL_SIZE, 0, &pixel_size);
 
@@ -281,12 +438,12 @@ Font::FontExtents Font::extents() const
     return detail::dummy_painter().set(*this).extents();
 }
 
-Font::TextExtents Font::extents(const std::string& text) const
+Font::TextExtents Font::extents(std::string_view text) const
 {
     return detail::dummy_painter().set(*this).extents(text);
 }
 
-Size Font::text_size(const std::string& text) const
+Size Font::text_size(std::string_view text) const
 {
     return detail::dummy_painter().set(*this).text_size(text);
 }
@@ -390,7 +547,18 @@ struct FontCache : private detail::NonCopyable<FontCache>
         {
         case detail::SchemeType::filesystem:
         {
-            scaled_font = create_ft_scaled_font(cr, path.c_str(), font);
+            scaled_font = create_file_scaled_font(cr, path, font);
+            break;
+        }
+        case detail::SchemeType::resource:
+        {
+            const auto data = ResourceManager::instance().data(path.c_str());
+            if (!data)
+                throw std::runtime_error("resource not found: " + path);
+
+            scaled_font = create_memory_scaled_font(cr, data,
+                                                    ResourceManager::instance().size(path.c_str()),
+                                                    font);
             break;
         }
         case detail::SchemeType::unknown:
@@ -400,7 +568,6 @@ struct FontCache : private detail::NonCopyable<FontCache>
             break;
         }
 #endif
-        case detail::SchemeType::resource:
         case detail::SchemeType::network:
         default:
             throw std::runtime_error("unable to load font uri: " + font.face());
@@ -413,12 +580,53 @@ struct FontCache : private detail::NonCopyable<FontCache>
 
 static FontCache font_cache;
 
+/*
+ * Small integer ids handed out to each unique font. Fonts created from memory
+ * are told apart by their data.
+ */
+struct FontIds : private detail::NonCopyable<FontIds>
+{
+    struct FontKey
+    {
+        const unsigned char* data;
+        Font font;
+    };
+
+    struct FontKeyCompare
+    {
+        bool operator()(const FontKey& lhs, const FontKey& rhs) const
+        {
+            if (lhs.data != rhs.data)
+                return lhs.data < rhs.data;
+            return FontCache::FontCompare()(lhs.font, rhs.font);
+        }
+    };
+
+    std::map<FontKey, uint32_t, FontKeyCompare> ids;
+
+    uint32_t id(const Font& font, const unsigned char* data)
+    {
+        FontKey key{data, Font(font.face(), font.size(), font.weight(), font.slant())};
+        const auto id = static_cast<uint32_t>(ids.size() + 1);
+        return ids.emplace(std::move(key), id).first->second;
+    }
+};
+
+static FontIds font_ids;
+
+uint32_t Font::id() const
+{
+    if (!m_id)
+        m_id = font_ids.id(*this, m_data);
+    return m_id;
+}
+
 const detail::InternalFont& Font::scaled_font() const
 {
     if (m_data && m_len && !m_scaled_font)
     {
         auto cr = detail::dummy_painter().context().get();
-        m_scaled_font = std::make_shared<detail::InternalFont>(create_ft_scaled_font(cr, m_data, m_len, *this));
+        m_scaled_font = std::make_shared<detail::InternalFont>(create_memory_scaled_font(cr, m_data, m_len, *this));
     }
 
     if (m_scaled_font)
@@ -439,10 +647,36 @@ void Font::reset_font_cache()
     font_cache.cache.clear();
 }
 
+void Font::preload(const std::vector<Font>& fonts)
+{
+#ifdef HAVE_FONTCONFIG
+    std::vector<Font> fontconfig_fonts;
+    for (const auto& font : fonts)
+    {
+        std::string path;
+        if (!font.m_data && detail::resolve_path(font.face(), path) == detail::SchemeType::unknown)
+            fontconfig_fonts.push_back(font);
+    }
+
+    if (fontconfig_fonts.empty())
+        return;
+
+    std::unique_ptr<cairo_font_options_t, decltype(cairo_font_options_destroy)*>
+    font_options(cairo_font_options_create(), cairo_font_options_destroy);
+    cairo_get_font_options(detail::dummy_painter().context().get(), font_options.get());
+
+    detail::FontMatchCache::instance().preload(fontconfig_fonts, font_options.get());
+#else
+    detail::ignoreparam(fonts);
+#endif
+}
+
 void Font::shutdown_fonts()
 {
     reset_font_cache();
 #ifdef HAVE_FONTCONFIG
+    detail::FontMatchCache::instance().wait();
+    detail::FontMatchCache::instance().flush();
     FcFini();
 #endif
 }
@@ -450,6 +684,7 @@ void Font::shutdown_fonts()
 void Font::direct_allocate()
 {
     m_scaled_font.reset();
+    m_id = 0;
 }
 
 void Font::on_screen_resized()
@@ -17,7 +17,7 @@ namespace experimental
 Form::Form(const std::string& title) noexcept
     : m_vsizer(Orientation::vertical, Justification::start)
 {
-    name("Form" + std::to_string(m_widgetid));
+    name_prefix("Form");
 
     m_vsizer.align(AlignFlag::expand);
     add(m_vsizer);
@@ -23,8 +23,7 @@ inline namespace v1
 Frame::Frame(const Rect& rect, const Widget::Flags& flags) noexcept
     : Widget(rect, flags | Widget::Flag::frame)
 {
-    name("Frame" + std::to_string(m_widgetid));
-    m_damage.reserve(10);
+    name_prefix("Frame");
 }
 
 Frame::Frame(Serializer::Properties& props, bool is_derived) noexcept
@@ -32,8 +31,6 @@ Frame::Frame(Serializer::Properties& props, bool is_derived) noexcept
 {
     flags().set(Widget::Flag::frame);
 
-    m_damage.reserve(10);
-
     if (!is_derived)
         deserialize_leaf(props);
 }
@@ -48,13 +45,14 @@ void Frame::add_private(const std::shared_ptr<Widget>& widget, ssize_t pos)
 {
     widget->set_parent(this);
 
-    const auto it = (pos >= 0 && static_cast<size_t>(pos) < m_children.size()) ?
-                    std::next(m_children.begin(), pos) : m_children.end();
+    const auto index = (pos >= 0 && static_cast<size_t>(pos) < m_components_begin) ?
+                       static_cast<size_t>(pos) : m_components_begin;
 
-    m_subordinates.emplace(it, widget);
+    m_subordinates.emplace(std::next(m_subordinates.begin(), index), widget);
+    ++m_components_begin;
     update_subordinates_ranges();
 
-    layout();
+    request_layout();
 }
 
 void Frame::add(const std::shared_ptr<Widget>& widget)
@@ -92,24 +90,27 @@ void Frame::remove(Widget* widget)
     if (!widget)
         return;
 
-    auto i = std::find_if(children().begin(), children().end(),
+    const auto children_end = std::next(m_subordinates.begin(), m_components_begin);
+    auto i = std::find_if(m_subordinates.begin(), children_end,
                           [widget](const auto & ptr)
     {
         return ptr.get() == widget;
     });
-    if (i != children().end())
+    if (i != children_end)
     {
         // note order here - damage and then unset parent
         (*i)->damage();
         (*i)->m_parent = nullptr;
+        (*i)->reset_color_cache();
         m_subordinates.erase(i);
-        if (i == children().begin())
-            children().begin(m_subordinates.begin());
-        layout();
+        --m_components_begin;
+        update_subordinates_ranges();
+        request_layout();
     }
     else if (widget->m_parent == this)
     {
         widget->m_parent = nullptr;
+        widget->reset_color_cache();
     }
 }
 
@@ -118,12 +119,12 @@ void Frame::remove_at(size_t pos)
     if (pos >= count_children())
         return;
 
-    const auto it = std::next(m_children.begin(), pos);
-    m_subordinates.erase(it);
+    m_subordinates.erase(std::next(m_subordinates.begin(), pos));
+    --m_components_begin;
 
     update_subordinates_ranges();
 
-    layout();
+    request_layout();
 }
 
 void Frame::remove_all_basic()
@@ -133,38 +134,67 @@ void Frame::remove_all_basic()
         // note order here - damage and then unset parent
         i->damage();
         i->m_parent = nullptr;
+        i->reset_color_cache();
     }
 
-    m_subordinates.erase(children().begin(), children().end());
-    m_components_begin = m_subordinates.begin();
+    m_subordinates.erase(m_subordinates.begin(),
+                         std::next(m_subordinates.begin(), m_components_begin));
+    m_components_begin = 0;
     update_subordinates_ranges();
 }
 
 void Frame::remove_all()
 {
     remove_all_basic();
-    layout();
+    request_layout();
 }
 
 Widget* Frame::hit_test(const DisplayPoint& point)
 {
-    for (auto& child : detail::reverse_iterate(m_subordinates))
+    Widget* target = nullptr;
+    if (auto index = spatial_index())
     {
-        if (child->hit(point))
+        // components are on top of children
+        for (auto& component : detail::reverse_iterate(components()))
         {
-            if (child->frame())
+            if (component->hit(point))
             {
-                auto frame = dynamic_cast<Frame*>(child.get());
-                if (frame)
-                    return frame->hit_test(point);
+                target = component.get();
+                break;
             }
-            else
+        }
+
+        if (!target)
+        {
+            const auto p = display_to_local(point) + this->point() -
+                           point_from_subordinate(**children().begin());
+            target = index->top(p, [](Widget*)
+            {
+                return true;
+            });
+        }
+    }
+    else
+    {
+        for (auto& child : detail::reverse_iterate(m_subordinates))
+        {
+            if (child->hit(point))
             {
-                return child.get();
+                target = child.get();
+                break;
             }
         }
     }
 
+    if (target)
+    {
+        // only a Frame has the frame flag
+        if (target->frame())
+            return static_cast<Frame*>(target)->hit_test(point);
+
+        return target;
+    }
+
     if (hit(point))
         return this;
 
@@ -176,8 +206,12 @@ void Frame::walk(const WalkCallback& callback, int level)
     if (!callback(this, level))
         return;
 
-    for (auto& child : children())
+    // the callback may add or remove children
+    for (size_t i = 0; i < m_components_begin; ++i)
+    {
+        auto child = m_subordinates[i];
         child->walk(callback, level + 1);
+    }
 }
 
 void Frame::paint_children_to_file()
@@ -225,8 +259,11 @@ void Frame::on_screen_resized()
 {
     Widget::on_screen_resized();
 
-    for (auto& child : children())
+    for (size_t i = 0; i < m_components_begin; ++i)
+    {
+        auto child = m_subordinates[i];
         child->on_screen_resized();
+    }
 }
 
 }
@@ -17,7 +17,7 @@ namespace experimental
 GaugeLayer::GaugeLayer(const Image& image) noexcept
     : m_image(image)
 {
-    name("GaugeLayer" + std::to_string(m_widgetid));
+    name_prefix("GaugeLayer");
 
     if (!m_image.empty())
         m_box.size(m_image.size());
@@ -57,7 +57,7 @@ NeedleLayer::NeedleLayer(const Image& image,
       m_angle_stop(angle_stop),
       m_clockwise(clockwise)
 {
-    name("NeedleLayer" + std::to_string(m_widgetid));
+    name_prefix("NeedleLayer");
     assert(m_max > m_min);
 }
 
@@ -136,7 +136,7 @@ Rect NeedleLayer::rectangle_of_rotated()
 Gauge::Gauge(const Rect& rect, const Widget::Flags& flags) noexcept
     : Frame(rect, flags)
 {
-    name("Gauge" + std::to_string(m_widgetid));
+    name_prefix("Gauge");
 }
 
 Gauge::Gauge(Frame& parent, const Rect& rect, const Widget::Flags& flags) noexcept
@@ -19,7 +19,7 @@ inline namespace v1
 StaticGrid::StaticGrid(const Rect& rect, const GridSize& size)
     : Frame(rect)
 {
-    name("StaticGrid" + std::to_string(m_widgetid));
+    name_prefix("StaticGrid");
 
     reallocate(size);
 }
@@ -444,7 +444,7 @@ void StaticGrid::deserialize(Serializer::Properties& props)
 SelectableGrid::SelectableGrid(const Rect& rect, const GridSize& size)
     : StaticGrid(rect, size)
 {
-    name("SelectableGrid" + std::to_string(widgetid()));
+    name_prefix("SelectableGrid");
 }
 
 SelectableGrid::SelectableGrid(const GridSize& size)
@@ -81,21 +81,35 @@ void ImageGroup::serialize(Serializer& serializer) const
 bool ImageGroup::deserialize(const std::string& name, const std::string& value)
 {
     Palette::GroupId group;
+    if (!property_group(name, m_suffix, group))
+        return false;
+
+    set(group, Image(value));
+    return true;
+}
 
-    if (name == std::string("normal_") + m_suffix)
+bool ImageGroup::property_group(const std::string& name, const std::string& suffix,
+                                Palette::GroupId& group)
+{
+    // names are "<group>_<suffix>", compared in place to not allocate
+    if (name.size() <= suffix.size() + 1 ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0 ||
+        name[name.size() - suffix.size() - 1] != '_')
+        return false;
+
+    const auto length = name.size() - suffix.size() - 1;
+    if (name.compare(0, length, "normal") == 0)
         group = Palette::GroupId::normal;
-    else if (name == std::string("active_") + m_suffix)
+    else if (name.compare(0, length, "active") == 0)
         group = Palette::GroupId::active;
-    else if (name == std::string("disabled_") + m_suffix)
+    else if (name.compare(0, length, "disabled") == 0)
         group = Palette::GroupId::disabled;
-    else if (name == std::string("checked_") + m_suffix)
+    else if (name.compare(0, length, "checked") == 0)
         group = Palette::GroupId::checked;
     else
         return false;
 
-    set(group, Image(value));
     return true;
 }
-
 }
 }
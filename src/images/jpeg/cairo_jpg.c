@@ -299,26 +299,44 @@ cairo_status_t cairo_image_surface_write_to_jpeg(cairo_surface_t *sfc, const cha
 
 
 /*! This function decompresses a JPEG image from a memory buffer and creates a
- * Cairo image surface.
+ * Cairo image surface, optionally using the DCT scaling of libjpeg to decode
+ * directly at a reduced size. The buffer is not taken over.
  * @param data Pointer to JPEG data (i.e. the full contents of a JPEG file read
  * into this buffer).
  * @param len Length of buffer in bytes.
+ * @param scale_denom Denominator of the scale to decode at: 1 for full size,
+ * or 2, 4 or 8 for a reduced size.
+ * @param width Pointer to a variable receiving the full width of the image,
+ * may be NULL.
+ * @param height Pointer to a variable receiving the full height of the image,
+ * may be NULL.
  * @return Returns a pointer to a cairo_surface_t structure. It should be
- * checked with cairo_surface_status() for errors.
+ * checked with cairo_surface_status() for errors. Its size is the full size
+ * divided by scale_denom, rounded up.
  */
-cairo_surface_t *cairo_image_surface_create_from_jpeg_mem(void *data, size_t len)
+cairo_surface_t *cairo_image_surface_create_from_jpeg_buffer(const void *data, size_t len, unsigned int scale_denom, int *width, int *height)
 {
    struct jpeg_decompress_struct cinfo;
    struct jpeg_error_mgr jerr;
    JSAMPROW row_pointer[1];
    cairo_surface_t *sfc;
+   unsigned char *pixels;
+   int stride;
 
    // initialize jpeg decompression structures
    cinfo.err = jpeg_std_error(&jerr);
    jpeg_create_decompress(&cinfo);
-   jpeg_mem_src(&cinfo, data, len);
+   jpeg_mem_src(&cinfo, (unsigned char*) data, len);
    (void) jpeg_read_header(&cinfo, TRUE);
 
+   if (width)
+      *width = cinfo.image_width;
+   if (height)
+      *height = cinfo.image_height;
+
+   cinfo.scale_num = 1;
+   cinfo.scale_denom = scale_denom ? scale_denom : 1;
+
 #ifdef LIBJPEG_TURBO_VERSION
 #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
    cinfo.out_color_space = JCS_EXT_BGRA;
@@ -340,11 +358,12 @@ cairo_surface_t *cairo_image_surface_create_from_jpeg_mem(void *data, size_t len
       return sfc;
    }
 
-   // loop over all scanlines and fill Cairo image surface
+   // decode scanlines directly into the Cairo image surface
+   pixels = cairo_image_surface_get_data(sfc);
+   stride = cairo_image_surface_get_stride(sfc);
    while (cinfo.output_scanline < cinfo.output_height)
    {
-      unsigned char *row_address = cairo_image_surface_get_data(sfc) +
-         (cinfo.output_scanline * cairo_image_surface_get_stride(sfc));
+      unsigned char *row_address = pixels + (cinfo.output_scanline * stride);
       row_pointer[0] = row_address;
       (void) jpeg_read_scanlines(&cinfo, row_pointer, 1);
 #ifndef LIBJPEG_TURBO_VERSION
@@ -357,6 +376,26 @@ cairo_surface_t *cairo_image_surface_create_from_jpeg_mem(void *data, size_t len
    (void) jpeg_finish_decompress(&cinfo);
    jpeg_destroy_decompress(&cinfo);
 
+   return sfc;
+}
+
+
+/*! This function decompresses a JPEG image from a memory buffer and creates a
+ * Cairo image surface.
+ * @param data Pointer to JPEG data (i.e. the full contents of a JPEG file read
+ * into this buffer).
+ * @param len Length of buffer in bytes.
+ * @return Returns a pointer to a cairo_surface_t structure. It should be
+ * checked with cairo_surface_status() for errors.
+ */
+cairo_surface_t *cairo_image_surface_create_from_jpeg_mem(void *data, size_t len)
+{
+   cairo_surface_t *sfc;
+
+   sfc = cairo_image_surface_create_from_jpeg_buffer(data, len, 1, NULL, NULL);
+   if (cairo_surface_status(sfc) != CAIRO_STATUS_SUCCESS)
+      return sfc;
+
    // set jpeg mime data
    cairo_surface_set_mime_data(sfc, CAIRO_MIME_TYPE_JPEG, data, len, free, data);
 
@@ -39,6 +39,7 @@ typedef ssize_t (*cairo_read_func_len_t)(void* closure, unsigned char* data, uns
 cairo_status_t cairo_image_surface_write_to_jpeg_mem(cairo_surface_t* sfc, unsigned char** data, size_t* len, int quality);
 cairo_status_t cairo_image_surface_write_to_jpeg_stream(cairo_surface_t* sfc, cairo_write_func_t write_func, void* closure, int quality);
 cairo_status_t cairo_image_surface_write_to_jpeg(cairo_surface_t* sfc, const char* filename, int quality);
+cairo_surface_t* cairo_image_surface_create_from_jpeg_buffer(const void* data, size_t len, unsigned int scale_denom, int* width, int* height);
 cairo_surface_t* cairo_image_surface_create_from_jpeg_mem(void* data, size_t len);
 #ifdef USE_CAIRO_READ_FUNC_LEN_T
 cairo_surface_t* cairo_image_surface_create_from_jpeg_stream(cairo_read_func_len_t read_func, void* closure);
@@ -45,6 +45,41 @@ static bool handler_dispatch(Event& event, Event& eevent,
     return false;
 }
 
+/**
+ * Check if a pointer event goes to a widget of the modal window that grabbed
+ * the pointer, without going through the modal window first.
+ */
+static bool modal_mouse_grab(const Event& event, const Widget* modal)
+{
+    auto grab = detail::mouse_grab();
+    if (!grab)
+        return false;
+
+    switch (event.id())
+    {
+    case EventId::raw_pointer_down:
+    case EventId::raw_pointer_up:
+    case EventId::raw_pointer_move:
+    case EventId::pointer_click:
+    case EventId::pointer_dblclick:
+    case EventId::pointer_hold:
+    case EventId::pointer_drag_start:
+    case EventId::pointer_drag:
+    case EventId::pointer_drag_stop:
+        break;
+    default:
+        return false;
+    }
+
+    for (auto widget = grab; widget; widget = widget->parent())
+    {
+        if (widget == modal)
+            return true;
+    }
+
+    return false;
+}
+
 /**
  * @todo No mouse positions should be allowed off the screen box().  This is
  * possible with some input devices currently and we need to limit.  Be careful
@@ -107,7 +142,8 @@ void Input::dispatch(Event& event)
     if (continue_drag)
         eevent = Event(); // hide this event from handler_dispath()
 
-    if (Application::instance().modal_window())
+    if (Application::instance().modal_window() &&
+        !modal_mouse_grab(event, Application::instance().modal_window()))
     {
         // give event to the modal window
         auto target = Application::instance().modal_window();
@@ -36,7 +36,7 @@ Label::Label(const std::string& text, const AlignFlags& text_align) noexcept
 Label::Label(const std::string& text, const Rect& rect, const AlignFlags& text_align) noexcept
     : TextWidget(text, rect, text_align)
 {
-    name("Label" + std::to_string(m_widgetid));
+    name_prefix("Label");
 }
 
 Label::Label(Frame& parent, const std::string& text, const AlignFlags& text_align) noexcept
@@ -69,9 +69,10 @@ void Label::default_draw(const Label& widget, Painter& painter, const Rect&)
     widget.draw_box(painter, Palette::ColorId::label_bg, Palette::ColorId::border);
 
     detail::draw_text(painter,
+                      widget.m_text_mask,
                       widget.content_area(),
                       widget.text(),
-                      widget.font(),
+                      widget.text_font(),
                       TextBox::TextFlags({TextBox::TextFlag::multiline, TextBox::TextFlag::word_wrap}),
                       widget.text_align(),
                       Justification::middle,
@@ -91,7 +92,7 @@ Size Label::min_size_hint() const
 
     if (!m_text.empty())
     {
-        auto s = text_size(m_text);
+        auto s = text_size_hint();
         return s + Widget::min_size_hint();
     }
 
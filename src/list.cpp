@@ -30,7 +30,7 @@ ListBoxBase::ListBoxBase(const ItemArray& items, const Rect& rect) noexcept
       m_view(),
       m_sizer(Orientation::vertical, Justification::start)
 {
-    name("ListBox" + std::to_string(m_widgetid));
+    name_prefix("ListBox");
 
     add_component(m_view);
 
@@ -357,7 +357,7 @@ ListBoxMulti::ListBoxMulti(const Rect& rect) noexcept
 ListBoxMulti::ListBoxMulti(const ItemArray& items, const Rect& rect) noexcept
     : ListBoxBase(items, rect)
 {
-    name("ListBoxMulti" + std::to_string(m_widgetid));
+    name_prefix("ListBoxMulti");
 }
 
 ListBoxMulti::ListBoxMulti(Frame& parent, const ItemArray& items, const Rect& rect) noexcept
@@ -25,7 +25,7 @@ void NotebookTab::select()
 Notebook::Notebook(const Rect& rect) noexcept
     : Frame(rect)
 {
-    name("Notebook" + std::to_string(m_widgetid));
+    name_prefix("Notebook");
 }
 
 Notebook::Notebook(Frame& parent, const Rect& rect) noexcept
@@ -4,20 +4,85 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 #include "egt/object.h"
+#include <algorithm>
+#include <iterator>
 
 namespace egt
 {
 inline namespace v1
 {
 
+size_t Object::bucket(EventId id)
+{
+    auto bits = static_cast<uint32_t>(id);
+    size_t bucket = 0;
+    while (bits > 1 && bucket < EVENT_BUCKETS - 1)
+    {
+        bits >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+void Object::Handlers::index()
+{
+    positions.clear();
+
+    for (size_t bucket = 0; bucket < EVENT_BUCKETS; ++bucket)
+    {
+        offsets[bucket] = positions.size();
+
+        // the last bucket also has the bits after it
+        auto bits = 1u << bucket;
+        if (bucket == EVENT_BUCKETS - 1)
+            bits = ~(bits - 1);
+
+        for (size_t i = 0; i < callbacks.size(); ++i)
+        {
+            const auto& mask = callbacks[i].mask;
+            if (mask.empty() || (static_cast<uint32_t>(mask.raw()) & bits))
+                positions.push_back(i);
+        }
+    }
+
+    offsets[EVENT_BUCKETS] = positions.size();
+}
+
+void Object::Handlers::settle()
+{
+    if (!removed && pending.empty())
+        return;
+
+    if (removed)
+    {
+        callbacks.erase(std::remove_if(callbacks.begin(), callbacks.end(),
+                                       [](const CallbackMeta & meta)
+        {
+            return meta.handle == 0;
+        }), callbacks.end());
+        removed = false;
+    }
+
+    std::move(pending.begin(), pending.end(), std::back_inserter(callbacks));
+    pending.clear();
+    index();
+}
+
 Object::RegisterHandle Object::on_event(const EventCallback& handler,
                                         const FilterFlags& mask)
 {
     if (handler)
     {
-        // TODO: m_handle_counter can wrap, making the handle non-unique
         auto handle = ++m_handle_counter;
-        m_callbacks->emplace_back(handler, mask, handle);
+        if (m_handlers->dispatching)
+        {
+            m_handlers->pending.emplace_back(handler, mask, handle);
+        }
+        else
+        {
+            m_handlers->callbacks.emplace_back(handler, mask, handle);
+            m_handlers->index();
+        }
         return handle;
     }
 
@@ -26,11 +91,46 @@ Object::RegisterHandle Object::on_event(const EventCallback& handler,
 
 void Object::invoke_handlers(Event& event)
 {
-    if (!m_callbacks)
+    if (!m_handlers)
         return;
 
-    for (auto& callback : *m_callbacks)
+    auto& handlers = *m_handlers;
+    const auto b = bucket(event.id());
+
+    /*
+     * Handlers may add or remove handlers, including themselves. Until the
+     * outermost dispatch is done, removed handlers are only marked and added
+     * handlers wait in pending, so no callback is moved or destroyed while
+     * it may be running.
+     */
+    struct Dispatch
+    {
+        explicit Dispatch(Handlers& h) noexcept
+            : handlers(h)
+        {
+            ++handlers.dispatching;
+        }
+
+        ~Dispatch()
+        {
+            if (--handlers.dispatching == 0)
+                handlers.settle();
+        }
+
+        Dispatch(const Dispatch&) = delete;
+        Dispatch& operator=(const Dispatch&) = delete;
+
+        Handlers& handlers;
+    } dispatch(handlers);
+
+    for (auto i = handlers.offsets[b]; i < handlers.offsets[b + 1]; ++i)
     {
+        auto& callback = handlers.callbacks[handlers.positions[i]];
+
+        // removed while dispatching
+        if (!callback.handle)
+            continue;
+
         if (callback.mask.empty() ||
             callback.mask.is_set(event.id()))
         {
@@ -49,25 +149,58 @@ void Object::invoke_handlers(EventId event)
 
 void Object::clear_handlers()
 {
-    if (!m_callbacks)
+    if (!m_handlers)
+        return;
+
+    auto& handlers = *m_handlers;
+    handlers.pending.clear();
+
+    if (handlers.dispatching)
+    {
+        for (auto& callback : handlers.callbacks)
+            callback.handle = 0;
+        handlers.removed = !handlers.callbacks.empty();
         return;
+    }
 
-    m_callbacks->clear();
+    handlers.callbacks.clear();
+    handlers.index();
 }
 
 void Object::remove_handler(RegisterHandle handle)
 {
-    if (!m_callbacks)
+    if (!m_handlers || !handle)
         return;
 
-    const auto i = std::find_if(m_callbacks->begin(), m_callbacks->end(),
-                                [handle](const CallbackMeta & meta)
+    auto& handlers = *m_handlers;
+    const auto matches = [handle](const CallbackMeta & meta)
     {
         return meta.handle == handle;
-    });
+    };
+
+    auto& pending = handlers.pending;
+    const auto p = std::find_if(pending.begin(), pending.end(), matches);
+    if (p != pending.end())
+    {
+        pending.erase(p);
+        return;
+    }
+
+    auto& callbacks = handlers.callbacks;
+    const auto i = std::find_if(callbacks.begin(), callbacks.end(), matches);
+    if (i == callbacks.end())
+        return;
+
+    if (handlers.dispatching)
+    {
+        // the callback may be running, so only mark it
+        i->handle = 0;
+        handlers.removed = true;
+        return;
+    }
 
-    if (i != m_callbacks->end())
-        m_callbacks->erase(i);
+    callbacks.erase(i);
+    handlers.index();
 }
 
 }
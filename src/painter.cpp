@@ -11,9 +11,9 @@
 #include "egt/image.h"
 #include "egt/painter.h"
 #include "egt/surface.h"
+#include <array>
 #include <cairo.h>
 #include <sstream>
-#include <string.h>
 
 namespace egt
 {
@@ -402,10 +402,32 @@ Font::FontExtents Painter::extents() const
     return font_extents;
 }
 
-Font::TextExtents Painter::extents(const std::string& text) const
+/*
+ * Same as cairo_text_extents(), but the text does not need to be null
+ * terminated and short strings are converted to glyphs on the stack.
+ */
+static void utf8_text_extents(cairo_t* cr, std::string_view text, cairo_text_extents_t& te)
+{
+    te = {};
+
+    std::array<cairo_glyph_t, 64> buffer;
+    cairo_glyph_t* glyphs = buffer.data();
+    int num_glyphs = buffer.size();
+
+    if (cairo_scaled_font_text_to_glyphs(cairo_get_scaled_font(cr), 0, 0,
+                                         text.data(), text.size(),
+                                         &glyphs, &num_glyphs,
+                                         nullptr, nullptr, nullptr) == CAIRO_STATUS_SUCCESS)
+        cairo_glyph_extents(cr, glyphs, num_glyphs, &te);
+
+    if (glyphs != buffer.data())
+        cairo_glyph_free(glyphs);
+}
+
+Font::TextExtents Painter::extents(std::string_view text) const
 {
     cairo_text_extents_t te;
-    cairo_text_extents(*m_cr, text.c_str(), &te);
+    utf8_text_extents(*m_cr, text, te);
 
     Font::TextExtents text_extents;
     text_extents.x_bearing = te.x_bearing;
@@ -417,14 +439,14 @@ Font::TextExtents Painter::extents(const std::string& text) const
     return text_extents;
 }
 
-Size Painter::text_size(const std::string& text)
+Size Painter::text_size(std::string_view text)
 {
     /*
      * cairo_text_extents deals with glyphs and doesn't handle multilines
      * strings so the text size has to be computed manually.
      * The line recommended height is used here as adding the line height
-     * returned by the text extents won't work. getline removes the line return
-     * sequence whose glyph is bigger than letters.
+     * returned by the text extents won't work. The line return sequence is
+     * not measured as its glyph is bigger than letters.
      */
     cairo_font_extents_t fontext;
     cairo_font_extents(*m_cr, &fontext);
@@ -433,27 +455,20 @@ Size Painter::text_size(const std::string& text)
     unsigned int n = 0;
     double line_max_width = 0;
 
-    char* lines = strdup(text.c_str());
-    char* line = lines;
-    while (line)
+    while (true)
     {
-        char* eol = strchr(line, '\n');
-        char* next = nullptr;
-
-        if (eol)
-        {
-            *eol = '\0';
-            next = eol + 1;
-        }
+        const auto eol = text.find('\n');
 
         cairo_text_extents_t textext;
-        cairo_text_extents(*m_cr, line, &textext);
+        utf8_text_extents(*m_cr, text.substr(0, eol), textext);
         line_max_width = std::max(line_max_width, textext.width);
         ++n;
 
-        line = next;
+        if (eol == std::string_view::npos)
+            break;
+
+        text.remove_prefix(eol + 1);
     }
-    free(lines);
 
     return {static_cast<Size::DimType>(std::floor(line_max_width + 1.0)),
             static_cast<Size::DimType>(std::floor(n * line_recommended_height + 1.0))};
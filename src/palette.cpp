@@ -20,11 +20,13 @@ static std::unique_ptr<Palette> the_global_palette;
 void reset_global_palette()
 {
     the_global_palette.reset(nullptr);
+    detail::palette_changed();
 }
 
 void global_palette(std::unique_ptr<Palette>&& palette)
 {
     the_global_palette = std::move(palette);
+    detail::palette_changed();
 }
 
 const Palette* global_palette()
@@ -34,6 +36,21 @@ const Palette* global_palette()
 
 namespace detail
 {
+
+static uint32_t the_palette_generation{1};
+
+uint32_t palette_generation()
+{
+    return the_palette_generation;
+}
+
+void palette_changed()
+{
+    // skip 0, so that it never matches a generation that was never set
+    if (++the_palette_generation == 0)
+        ++the_palette_generation;
+}
+
 // constexpr version of std::find()
 template<class T, class Key>
 constexpr T find(T begin, T end, const Key& first)
@@ -49,9 +66,24 @@ constexpr T find(T begin, T end, const Key& first)
 }
 }
 
+Palette& Palette::operator=(const Palette& rhs)
+{
+    m_colors = rhs.m_colors;
+    detail::palette_changed();
+    return *this;
+}
+
+Palette& Palette::operator=(Palette&& rhs) noexcept
+{
+    m_colors = std::move(rhs.m_colors);
+    detail::palette_changed();
+    return *this;
+}
+
 Palette& Palette::operator=(const PatternArray& colors)
 {
     m_colors = colors;
+    detail::palette_changed();
     return *this;
 }
 
@@ -86,6 +118,8 @@ void Palette::set(ColorId id, GroupId group, const Pattern& color)
         m_colors.back().first = group;
         m_colors.back().second.emplace_back(id, color);
     }
+
+    detail::palette_changed();
 }
 
 void Palette::set(ColorId id, const Pattern& color, GroupId group)
@@ -102,11 +136,14 @@ void Palette::clear(ColorId id, GroupId group)
         if (c != g->second.end())
             g->second.erase(c);
     }
+
+    detail::palette_changed();
 }
 
 void Palette::clear()
 {
     m_colors.clear();
+    detail::palette_changed();
 }
 
 bool Palette::exists(ColorId id, GroupId group) const
@@ -16,7 +16,7 @@ Picture::Picture(const std::string& uri,
                  const Rect& rect) noexcept
     : Widget(rect)
 {
-    name("Picture" + std::to_string(m_widgetid));
+    name_prefix("Picture");
 
     align(flags);
     fill_flags(Theme::FillFlag::blend);
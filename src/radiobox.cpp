@@ -18,7 +18,7 @@ RadioBox::RadioBox(const std::string& text,
                    const Rect& rect) noexcept
     : Switch(text, rect)
 {
-    name("RadioBox" + std::to_string(m_widgetid));
+    name_prefix("RadioBox");
 }
 
 RadioBox::RadioBox(Frame& parent,
@@ -8,11 +8,15 @@
 #endif
 
 #include "detail/egtlog.h"
+#include "detail/mappedfile.h"
+#include "detail/resourcebundle.h"
 #include "egt/detail/image.h"
 #include "egt/detail/meta.h"
 #include "egt/resource.h"
+#include <algorithm>
 #include <cstring>
 #include <memory>
+#include <tuple>
 
 #ifdef HAVE_ZLIB
 #include <zlib.h>
@@ -23,7 +27,6 @@ namespace egt
 inline namespace v1
 {
 
-// NOLINTNEXTLINE(hicpp-special-member-functions, cppcoreguidelines-special-member-functions)
 struct ResourceManager::ResourceItem
 {
     ResourceItem() = delete;
@@ -39,21 +42,16 @@ struct ResourceManager::ResourceItem
           m_len(m_data_copy.size())
     {}
 
-    ResourceItem(const ResourceItem& rhs)
-        : m_data_copy(rhs.m_data_copy)
-    {
-        if (!m_data_copy.empty())
-        {
-            m_data = m_data_copy.data();
-            m_len = m_data_copy.size();
-        }
-        else
-        {
-            m_data = rhs.m_data;
-            m_len = rhs.m_len;
-        }
-    }
+    /*
+     * zlib compressed data of a known uncompressed size.
+     */
+    ResourceItem(const unsigned char* data, size_t len, size_t raw_len) noexcept
+        : m_data(data),
+          m_len(len),
+          m_raw_len(raw_len)
+    {}
 
+    ResourceItem(const ResourceItem&) = delete;
     ResourceItem& operator=(const ResourceItem&) = delete;
     ResourceItem(ResourceItem&&) = default;
     ResourceItem& operator=(ResourceItem&&) = default;
@@ -81,6 +79,12 @@ private:
             return;
         m_inflated = true;
 
+        if (m_raw_len)
+        {
+            uncompress_known_size();
+            return;
+        }
+
         auto mimetype = detail::get_mime_type(m_data, m_len);
         if (mimetype != "application/gzip")
             return;
@@ -98,28 +102,35 @@ private:
         stream.next_in = (Bytef*)m_data;
         stream.avail_in = m_len;
 
-        const size_t BUFSIZE = 8 * 1024;
-        unsigned char buffer[BUFSIZE];
+        /*
+         * The gzip trailer holds the uncompressed size modulo 2^32, so the
+         * data is inflated straight into a buffer of the final size. The
+         * buffer only grows if the trailer does not tell the whole story.
+         */
+        const auto trailer = m_data + m_len - 4;
+        const size_t isize = trailer[0] | (trailer[1] << 8) |
+                             (trailer[2] << 16) | (static_cast<uint32_t>(trailer[3]) << 24);
+        m_buf.resize(isize ? isize : m_len * 4);
+
         int res;
         do
         {
-            stream.next_out = reinterpret_cast<Bytef*>(buffer);
-            stream.avail_out = BUFSIZE;
-
-            res = inflate(&stream, Z_NO_FLUSH);
+            if (stream.total_out == m_buf.size())
+                m_buf.resize(m_buf.size() * 2);
 
-            if (m_buf.size() < stream.total_out)
-                m_buf.insert(m_buf.end(),
-                             buffer,
-                             buffer + stream.total_out - m_buf.size());
+            stream.next_out = m_buf.data() + stream.total_out;
+            stream.avail_out = m_buf.size() - stream.total_out;
 
+            res = inflate(&stream, Z_NO_FLUSH);
         } while (res == Z_OK);
 
+        m_buf.resize(stream.total_out);
         inflateEnd(&stream);
 
         if (res != Z_STREAM_END)
         {
             detail::warn("failed to finish zlib inflate: {}", res);
+            m_buf.clear();
             return;
         }
 
@@ -129,17 +140,43 @@ private:
 #endif
     }
 
+#ifdef HAVE_ZLIB
+    void uncompress_known_size()
+    {
+        m_buf.resize(m_raw_len);
+        uLongf len = m_raw_len;
+        const auto res = uncompress(m_buf.data(), &len, m_data, m_len);
+        if (res != Z_OK || len != m_raw_len)
+        {
+            detail::warn("failed to uncompress resource: {}", res);
+            m_buf.clear();
+        }
+
+        m_data = m_buf.data();
+        m_len = m_buf.size();
+    }
+#endif
+
     std::vector<unsigned char> m_data_copy;
     const unsigned char* m_data{nullptr};
     size_t m_len{0};
+    size_t m_raw_len{0};
     std::vector<unsigned char> m_buf;
 #ifdef HAVE_ZLIB
     bool m_inflated {false};
 #endif
 };
 
+struct ResourceManager::Bundle
+{
+    std::unique_ptr<detail::MappedFile> file;
+    detail::ResourceBundle index;
+};
+
 ResourceManager::ResourceManager() = default;
 
+ResourceManager::~ResourceManager() noexcept = default;
+
 ResourceManager& ResourceManager::instance()
 {
     static const std::unique_ptr<ResourceManager> i(new ResourceManager());
@@ -149,35 +186,91 @@ ResourceManager& ResourceManager::instance()
 bool ResourceManager::exists(const char* name) const
 {
     const auto i = m_resources.find(name);
-    return i != m_resources.end();
+    return i != m_resources.end() || in_bundle(name);
+}
+
+bool ResourceManager::in_bundle(const char* name) const
+{
+    if (m_bundles.empty() || m_hidden.find(name) != m_hidden.end())
+        return false;
+
+    detail::ResourceBundle::Entry entry;
+    for (const auto& bundle : m_bundles)
+    {
+        if (bundle->index.find(name, entry))
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * Resources of bundles are only turned into items when they are first used,
+ * so registering a bundle costs nothing per resource.
+ */
+ResourceManager::ResourceItem* ResourceManager::find(const char* name)
+{
+    const auto i = m_resources.find(name);
+    if (i != m_resources.end())
+        return &i->second;
+
+    if (m_bundles.empty() || m_hidden.find(name) != m_hidden.end())
+        return nullptr;
+
+    detail::ResourceBundle::Entry entry;
+    for (const auto& bundle : m_bundles)
+    {
+        if (!bundle->index.find(name, entry))
+            continue;
+
+        switch (entry.compression)
+        {
+        case detail::ResourceBundle::Compression::none:
+            return &m_resources.emplace(std::piecewise_construct,
+                                        std::forward_as_tuple(name),
+                                        std::forward_as_tuple(entry.data, entry.size)).first->second;
+#ifdef HAVE_ZLIB
+        case detail::ResourceBundle::Compression::zlib:
+            return &m_resources.emplace(std::piecewise_construct,
+                                        std::forward_as_tuple(name),
+                                        std::forward_as_tuple(entry.data, entry.size,
+                                                entry.raw_size)).first->second;
+#endif
+        default:
+            detail::warn("unsupported compression for resource: {}", name);
+            return nullptr;
+        }
+    }
+
+    return nullptr;
 }
 
 void ResourceManager::clear()
 {
     m_resources.clear();
+    m_bundles.clear();
+    m_hidden.clear();
 }
 
 void ResourceManager::clear(const char* name)
 {
-    const auto i = m_resources.find(name);
-    if (i != m_resources.end())
-        m_resources.erase(i);
+    remove(name);
 }
 
 size_t ResourceManager::size(const char* name)
 {
-    const auto i = m_resources.find(name);
-    if (i != m_resources.end())
-        return i->second.len();
+    auto item = find(name);
+    if (item)
+        return item->len();
 
     return 0;
 }
 
 const unsigned char* ResourceManager::data(const char* name)
 {
-    const auto i = m_resources.find(name);
-    if (i != m_resources.end())
-        return i->second.data();
+    auto item = find(name);
+    if (item)
+        return item->data();
 
     return nullptr;
 }
@@ -185,13 +278,13 @@ const unsigned char* ResourceManager::data(const char* name)
 bool ResourceManager::read(const char* name, unsigned char* data,
                            size_t length, size_t offset)
 {
-    const auto i = m_resources.find(name);
-    if (i != m_resources.end())
+    auto item = find(name);
+    if (item)
     {
-        if ((offset + length) > i->second.len())
+        if ((offset + length) > item->len())
             throw std::runtime_error("out of bounds read on resource");
 
-        memcpy(data, i->second.data() + offset, length);
+        memcpy(data, item->data() + offset, length);
         return true;
     }
 
@@ -200,22 +293,22 @@ bool ResourceManager::read(const char* name, unsigned char* data,
 
 void ResourceManager::stream_reset(const char* name)
 {
-    const auto i = m_resources.find(name);
-    if (i != m_resources.end())
-        i->second.index = 0;
+    auto item = find(name);
+    if (item)
+        item->index = 0;
 }
 
 bool ResourceManager::stream_read(const char* name, unsigned char* data,
                                   size_t length)
 {
-    const auto i = m_resources.find(name);
-    if (i != m_resources.end())
+    auto item = find(name);
+    if (item)
     {
-        if ((i->second.index + length) > i->second.len())
+        if ((item->index + length) > item->len())
             throw std::runtime_error("read past end of data on resource");
 
-        memcpy(data, i->second.data() + i->second.index, length);
-        i->second.index += length;
+        memcpy(data, item->data() + item->index, length);
+        item->index += length;
 
         return true;
     }
@@ -235,7 +328,25 @@ std::vector<T1> extract_keys(std::map<T1, T2> const& input_map)
 
 ResourceManager::ItemArray ResourceManager::list() const
 {
-    return extract_keys(m_resources);
+    auto result = extract_keys(m_resources);
+    if (m_bundles.empty())
+        return result;
+
+    detail::ResourceBundle::Entry entry;
+    for (const auto& bundle : m_bundles)
+    {
+        for (size_t slot = 0; slot < bundle->index.count(); ++slot)
+        {
+            if (bundle->index.entry(slot, entry) &&
+                m_hidden.find(entry.name) == m_hidden.end())
+                result.emplace_back(entry.name);
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+
+    return result;
 }
 
 void ResourceManager::add(const char* name, const unsigned char* data, size_t len)
@@ -243,8 +354,9 @@ void ResourceManager::add(const char* name, const unsigned char* data, size_t le
     if (exists(name))
         detail::warn("resource added with duplicate name: {}", name);
 
-    ResourceItem r(data, len);
-    m_resources.insert(std::make_pair(name, r));
+    m_resources.emplace(std::piecewise_construct,
+                        std::forward_as_tuple(name),
+                        std::forward_as_tuple(data, len));
 }
 
 void ResourceManager::add(const char* name, const std::vector<unsigned char>& data)
@@ -252,8 +364,30 @@ void ResourceManager::add(const char* name, const std::vector<unsigned char>& da
     if (exists(name))
         detail::warn("resource added with duplicate name: {}", name);
 
-    ResourceItem r(data);
-    m_resources.insert(std::make_pair(name, r));
+    m_resources.emplace(std::piecewise_construct,
+                        std::forward_as_tuple(name),
+                        std::forward_as_tuple(data));
+}
+
+void ResourceManager::add_bundle(const std::string& filename)
+{
+    auto bundle = std::make_unique<Bundle>();
+    bundle->file = std::make_unique<detail::MappedFile>(filename);
+    if (!bundle->index.open(bundle->file->data(), bundle->file->size()))
+        throw std::runtime_error("invalid resource bundle: " + filename);
+
+    EGTLOG_DEBUG("resource bundle {} has {} resources", filename, bundle->index.count());
+
+    m_bundles.emplace_back(std::move(bundle));
+}
+
+void ResourceManager::add_bundle(const unsigned char* data, size_t len)
+{
+    auto bundle = std::make_unique<Bundle>();
+    if (!bundle->index.open(data, len))
+        throw std::runtime_error("invalid resource bundle");
+
+    m_bundles.emplace_back(std::move(bundle));
 }
 
 void ResourceManager::remove(const char* name)
@@ -261,6 +395,12 @@ void ResourceManager::remove(const char* name)
     const auto i = m_resources.find(name);
     if (i != m_resources.end())
         m_resources.erase(i);
+
+    /*
+     * Bundles are read-only, so their resources are hidden instead.
+     */
+    if (in_bundle(name))
+        m_hidden.emplace(name);
 }
 
 }
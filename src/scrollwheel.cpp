@@ -116,7 +116,7 @@ void Scrollwheel::init(bool in_deserialize)
 {
     if (!in_deserialize)
     {
-        name("Scrollwheel" + std::to_string(m_widgetid));
+        name_prefix("Scrollwheel");
 
         m_grid.horizontal_space(1);
         m_grid.vertical_space(1);
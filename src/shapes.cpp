@@ -17,7 +17,7 @@ CircleWidget::CircleWidget(const Circle& circle)
     : Widget(circle.rect()),
       m_radius(circle.radius())
 {
-    name("CircleWidget" + std::to_string(m_widgetid));
+    name_prefix("CircleWidget");
     fill_flags(Theme::FillFlag::blend);
 }
 
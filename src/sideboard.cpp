@@ -67,6 +67,10 @@ SideBoard::SideBoard(Serializer::Properties& props, bool is_derived) noexcept
 
 void SideBoard::initialize()
 {
+    // no need to animate while hidden
+    m_oanim.target(this);
+    m_canim.target(this);
+
     reset_animations();
 
     switch (m_position)
@@ -95,6 +95,7 @@ void BoxSizer::layout()
     resize(rect);
 
     std::vector<detail::LayoutRect> rects;
+    rects.reserve(count_children());
 
     for (auto& child : children())
     {
@@ -106,10 +107,11 @@ void BoxSizer::layout()
 
         if (child->autoresize())
         {
-            if (min.width() < child->min_size_hint().width())
-                min.width(child->min_size_hint().width());
-            if (min.height() < child->min_size_hint().height())
-                min.height(child->min_size_hint().height());
+            const auto hint = child->min_size_hint();
+            if (min.width() < hint.width())
+                min.width(hint.width());
+            if (min.height() < hint.height())
+                min.height(hint.height());
         }
 
         child->layout();
@@ -148,7 +148,7 @@ void SoftwareSprite::show_frame(int index)
 Sprite::Sprite(WindowHint hint)
     : Window(PixelFormat::argb8888, hint)
 {
-    name("Sprite" + std::to_string(m_widgetid));
+    name_prefix("Sprite");
     fill_flags().clear();
 }
 
@@ -157,7 +157,7 @@ Sprite::Sprite(const Image& image, const Size& frame_size,
                WindowHint hint)
     : Window(Rect({}, image.size()), PixelFormat::argb8888, hint)
 {
-    name("Sprite" + std::to_string(m_widgetid));
+    name_prefix("Sprite");
     fill_flags().clear();
     create_impl(image, frame_size, frame_count, frame_point);
 }
@@ -7,6 +7,7 @@
 #include "egt/svgdeserial.h"
 #include "egt/text.h"
 #include "detail/erawimage.h"
+#include "detail/erawtiled.h"
 #include "detail/eraw.h"
 
 namespace egt
@@ -23,6 +24,15 @@ SVGDeserial::SVGDeserial(TopWindow& parent) noexcept
 
 Surface SVGDeserial::DeSerialize(const unsigned char* buf, size_t len, std::shared_ptr<egt::Rect>& rect)
 {
+    if (detail::ErawTiledImage::is_tiled(buf, len))
+    {
+        detail::ErawTiledImage tiled;
+        if (!tiled.open(buf, len))
+            return {};
+        *rect = Rect(tiled.origin(), tiled.size());
+        return tiled.decode();
+    }
+
     return detail::ErawImage::load(buf, len, rect);
 }
 
@@ -63,6 +73,7 @@ std::shared_ptr<AnimationSequence> SVGDeserial::RotateAnimation(std::shared_ptr<
     {
         widget->value(v);
     });
+    animationup->target(widget.get());
 
     auto animationdown =
         std::make_shared<PropertyAnimator>(widget->max(), widget->min(), duration, easeout);
@@ -70,6 +81,7 @@ std::shared_ptr<AnimationSequence> SVGDeserial::RotateAnimation(std::shared_ptr<
     {
         widget->value(v);
     });
+    animationdown->target(widget.get());
 
     auto sequence = std::make_shared<AnimationSequence>(true);
     sequence->add(animationup);
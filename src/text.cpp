@@ -11,7 +11,6 @@
 #include "detail/utf8text.h"
 #include "egt/detail/alignment.h"
 #include "egt/detail/enum.h"
-#include "egt/detail/layout.h"
 #include "egt/detail/string.h"
 #include "egt/frame.h"
 #include "egt/input.h"
@@ -19,6 +18,8 @@
 #include "egt/serialize.h"
 #include "egt/text.h"
 #include "layout.h"
+#include <algorithm>
+#include <limits>
 
 #ifdef ENABLE_VIRTUALKEYBOARD
 #include "egt/virtualkeyboard.h"
@@ -76,144 +77,357 @@ TextRect TextRect::split(size_t pos, const Painter& painter) noexcept
     return tail;
 }
 
-void TextBox::tokenize(TextRects& rects)
+/*
+ * Get the end of the token at offset: a word or a single delimiter when
+ * wrapping at word boundaries, otherwise a single code point.
+ */
+static size_t token_end(const std::string& text, size_t offset, bool words)
 {
-    auto& painter = detail::dummy_painter();
-    const auto& fe = m_fe;
-
-    // tokenize based on words or code points
     static const std::string delimiters = " \t\n\r";
-    std::vector<std::string> tokens;
 
-    tokens.reserve(m_text.length());
-
-    bool multiline = text_flags().is_set(TextBox::TextFlag::multiline);
-    if (multiline && text_flags().is_set(TextBox::TextFlag::word_wrap))
+    if (words)
     {
-        detail::tokenize_with_delimiters(m_text.cbegin(),
-                                         m_text.cend(),
-                                         delimiters.cbegin(),
-                                         delimiters.cend(),
-                                         tokens);
+        if (delimiters.find(text[offset]) != std::string::npos)
+            return offset + 1;
+
+        const auto end = text.find_first_of(delimiters, offset);
+        return end == std::string::npos ? text.size() : end;
     }
-    else
-    {
-        for (detail::utf8_const_iterator ch(m_text.begin(), m_text.begin(), m_text.end());
-             ch != detail::utf8_const_iterator(m_text.end(), m_text.begin(), m_text.end()); ++ch)
-        {
-            auto t = detail::utf8_char_to_string(ch.base(), m_text.cend());
 
-            if (!multiline && t == "\n")
-                break;
+    auto it = text.cbegin() + offset;
+    utf8::next(it, text.cend());
+    return std::distance(text.cbegin(), it);
+}
 
-            tokens.emplace_back(t);
-        }
-    }
+/*
+ * This is the layout a wrapping flex container would compute with one item
+ * per token, but done one line at a time so that it can be resumed from any
+ * line of a previous layout.
+ */
+bool TextBox::layout_line(TextLine& line, const Point& point,
+                          DefaultDim max_width, TextRects& rects)
+{
+    auto& painter = detail::dummy_painter();
+    const auto& fe = m_fe;
+
+    const bool multiline = text_flags().is_set(TextBox::TextFlag::multiline);
+    const bool words = multiline && text_flags().is_set(TextBox::TextFlag::word_wrap);
 
-    uint32_t default_behave = 0;
-    uint32_t behave = default_behave;
+    uint32_t behave = (line.paragraph && line.offset) ? LAY_BREAK : 0;
+    bool empty_line = line.paragraph;
 
-    bool empty_line = true;
-    for (const auto& t : tokens)
+    line.length = 0;
+    line.size = 0;
+    line.width = 0;
+    line.newline = false;
+
+    auto offset = line.offset;
+    while (offset < m_text.size())
     {
-        Font::TextExtents te;
+        const auto end = token_end(m_text, offset, words);
+        const auto t = std::string_view(m_text).substr(offset, end - offset);
 
         if (t == "\n")
         {
+            if (!multiline)
+                break;
+
             TextRect::TextRectFlags flags = {};
             if (!empty_line)
                 flags.set(TextRect::TextRectFlag::eonel);
 
+            Font::TextExtents te;
             memset(&te, 0, sizeof(te));
             te.width = 1;
             te.height = fe.height;
             te.x_advance = 1;
-            rects.emplace_back(behave, Rect(0, 0, te.x_advance, fe.height), t, te, flags);
-            behave |= LAY_BREAK;
-            empty_line = true;
+            rects.emplace_back(behave,
+                               Rect(point.x() + line.width, point.y(), te.x_advance, fe.height),
+                               std::string(t), te, flags);
+
+            // a newline alone on its line is laid out like any other token
+            if (empty_line)
+                line.width += rects.back().rect().width();
+
+            line.newline = true;
         }
         else
         {
-            te = painter.extents(t);
-            rects.emplace_back(behave, Rect(0, 0, te.x_advance, fe.height), t, te);
-            behave = default_behave;
+            const auto te = painter.extents(t);
+            Rect rect(point.x() + line.width, point.y(), te.x_advance, fe.height);
+
+            // the first token of a line always fits
+            if (line.length && line.width + rect.width() > max_width)
+                break;
+
+            rects.emplace_back(behave, rect, std::string(t), te);
+            line.width += rect.width();
+            behave = 0;
             empty_line = false;
         }
+
+        if (!line.length)
+        {
+            rects.back().mark_beginning_of_line();
+            line.first = std::prev(rects.end());
+        }
+
+        line.length += words ? utf8::distance(m_text.cbegin() + offset, m_text.cbegin() + end) : 1;
+        line.size += end - offset;
+        offset = end;
+
+        if (line.newline)
+            break;
     }
+
+    return line.length > 0;
 }
 
-void TextBox::compute_layout(TextRects& rects)
+Point TextBox::layout_offset() const
 {
-    const auto boundaries = text_boundaries();
-    lay_context ctx;
-    lay_init_context(&ctx);
+    const auto size = text_area().size();
+    Point offset;
 
-    auto cleanup = detail::on_scope_exit([&ctx]()
+    /*
+     * Unless expanded, the lines are laid out in a block as wide as the
+     * widest line and as high as the number of paragraphs, aligned in the
+     * text boundaries.
+     */
+    if (!text_align().is_set(AlignFlag::expand_horizontal))
     {
-        lay_destroy_context(&ctx);
-    });
+        const auto width = m_line_widths.empty() ? 0 : m_line_widths.rbegin()->first;
 
-    lay_reserve_items_capacity(&ctx, rects.size() + 2);
+        if (text_align().is_set(AlignFlag::right))
+            offset.x(size.width() - width);
+        else if (!text_align().is_set(AlignFlag::left))
+            offset.x((size.width() - width) / 2);
+    }
 
-    lay_id outer_parent = lay_item(&ctx);
-    lay_id inner_parent = lay_item(&ctx);
+    if (!text_align().is_set(AlignFlag::expand_vertical))
+    {
+        const auto height = line_height() * static_cast<DefaultDim>(m_paragraphs);
 
-    lay_set_size_xy(&ctx, outer_parent, boundaries.width(), boundaries.height());
+        if (text_align().is_set(AlignFlag::bottom))
+            offset.y(size.height() - height);
+        else if (!text_align().is_set(AlignFlag::top))
+            offset.y((size.height() - height) / 2);
+    }
 
-    uint32_t contains = detail::justify_to_contains(Justification::start, Orientation::flex);
-    lay_set_contain(&ctx, inner_parent, contains);
+    return offset;
+}
 
-    uint32_t dbehave = detail::align_to_behave(text_align());
-    lay_set_behave(&ctx, inner_parent, dbehave);
-    lay_insert(&ctx, outer_parent, inner_parent);
+Point TextBox::line_origin(size_t index) const
+{
+    return m_layout_origin + Point(0, line_height() * static_cast<DefaultDim>(index));
+}
 
-    for (const auto& r : rects)
+void TextBox::settle_lines(size_t first, size_t last)
+{
+    last = std::min(last, m_lines.size());
+    for (auto i = first; i < last; ++i)
     {
-        if (r.end_of_non_empty_line())
+        auto& line = m_lines[i];
+        const auto origin = line_origin(i);
+        if (line.origin == origin)
             continue;
 
-        lay_id c = lay_item(&ctx);
-        lay_set_size_xy(&ctx, c, r.rect().width(), r.rect().height());
-        lay_set_behave(&ctx, c, r.behave());
-        lay_insert(&ctx, inner_parent, c);
+        const auto delta = origin - line.origin;
+        const auto end = i + 1 < m_lines.size() ? m_lines[i + 1].first : m_rects.end();
+        for (auto r = line.first; r != end; ++r)
+            r->point(r->rect().point() + delta);
+
+        line.origin = origin;
+    }
+}
+
+void TextBox::count_lines(TextLines::const_iterator begin, TextLines::const_iterator end, int count)
+{
+    for (auto line = begin; line != end; ++line)
+    {
+        auto& lines = m_line_widths[line->width];
+        lines += count;
+        if (!lines)
+            m_line_widths.erase(line->width);
+
+        if (line->paragraph)
+            m_paragraphs += count;
+    }
+}
+
+DefaultDim TextBox::wrap_width() const
+{
+    // the block of lines is only as wide as the text area when expanded
+    if (text_align().is_set(AlignFlag::expand_horizontal))
+        return text_area().width();
+
+    return std::numeric_limits<DefaultDim>::max();
+}
+
+DefaultDim TextBox::line_height() const
+{
+    return m_fe.height;
+}
+
+TextBox::TextLines::const_iterator TextBox::find_line(size_t pos) const
+{
+    auto line = std::lower_bound(m_lines.cbegin(), m_lines.cend(), pos,
+                                 [](const TextLine & l, size_t p)
+    {
+        return l.pos + l.length < p;
+    });
+
+    if (line == m_lines.cend() && !m_lines.empty())
+        --line;
+
+    return line;
+}
+
+void TextBox::relayout_text(size_t pos, size_t removed, size_t inserted)
+{
+    if (m_lines.empty() ||
+        m_state != State(&font(), flags(), text_align(), text_flags()))
+    {
+        // the previous layout is compared where it is
+        settle_lines(0, m_lines.size());
+
+        TextRects rects;
+        TextLines lines;
+        prepare_text(rects, lines);
+        tag_text(m_rects, rects);
+        m_rects.swap(rects);
+        m_lines.swap(lines);
+        return;
     }
 
-    lay_run_context(&ctx);
+    detail::dummy_painter().set(font());
 
-    DefaultDim line_y = boundaries.y() - 1;
-    bool next_is_beginning_of_line = true;
+    const bool words = text_flags().is_set(TextBox::TextFlag::multiline) &&
+                       text_flags().is_set(TextBox::TextFlag::word_wrap);
 
-    auto it = rects.begin();
-    auto child = lay_first_child(&ctx, inner_parent);
-    while (child != LAY_INVALID_ID)
+    // last line starting before the edit
+    size_t first = std::upper_bound(m_lines.cbegin(), m_lines.cend(), pos,
+                                    [](size_t p, const TextLine & line)
     {
-        lay_vec4 r = lay_get_rect(&ctx, child);
-        auto x = boundaries.x() + r[0];
-        auto y = boundaries.y() + r[1];
-        it->point(Point(x, y));
-        x += it->rect().width();
+        return p < line.pos;
+    }) - m_lines.cbegin();
+    if (first)
+        --first;
+
+    auto it = m_text.cbegin() + m_lines[first].offset;
+    utf8::advance(it, pos - m_lines[first].pos, m_text.cend());
+    const size_t edit_offset = std::distance(m_text.cbegin(), it);
+
+    /*
+     * The previous line may now end differently if the first token of this
+     * one reaches the edit, unless a newline ends it.
+     */
+    while (first && !m_lines[first].paragraph &&
+           token_end(m_text, m_lines[first].offset, words) >= edit_offset)
+        --first;
 
-        if (line_y != y || next_is_beginning_of_line)
+    const auto height = line_height();
+    const auto max_width = wrap_width();
+
+    TextRects rects;
+    TextLines lines;
+    TextLine line = m_lines[first];
+    auto last = first;
+    bool converged = false;
+
+    for (;;)
+    {
+        /*
+         * Past the edit, the text is unchanged and so is the layout once a
+         * line starts where one previously started.
+         */
+        if (line.pos >= pos + inserted)
         {
-            next_is_beginning_of_line = false;
-            it->mark_beginning_of_line();
-            line_y = y;
+            const auto old_pos = line.pos - inserted + removed;
+            while (last < m_lines.size() && m_lines[last].pos < old_pos)
+                ++last;
+
+            if (last < m_lines.size() &&
+                m_lines[last].pos == old_pos &&
+                m_lines[last].paragraph == line.paragraph)
+            {
+                converged = true;
+                break;
+            }
         }
 
-        if (it->text() == "\n")
-            next_is_beginning_of_line = true;
+        const auto point = line_origin(first + lines.size());
+        if (!layout_line(line, point, max_width, rects))
+            break;
+
+        line.origin = point;
+        lines.push_back(line);
+
+        line.pos += line.length;
+        line.offset += line.size;
+        line.paragraph = line.newline;
+    }
+
+    if (!converged)
+        last = m_lines.size();
+
+    const auto next = converged ? m_lines[last].first : m_rects.end();
 
-        lay_item_t* pchild = lay_get_item(&ctx, child);
-        child = pchild->next_sibling;
-        ++it;
+    settle_lines(first, last);
+    TextRects prev;
+    prev.splice(prev.end(), m_rects, m_lines[first].first, next);
+    tag_text(prev, rects);
+    m_rects.splice(next, rects);
 
-        if (it != rects.end() && it->end_of_non_empty_line())
+    if (converged)
+    {
+        const auto shift = height * (static_cast<DefaultDim>(lines.size()) -
+                                     static_cast<DefaultDim>(last - first));
+        const auto offset = line.offset - m_lines[last].offset;
+
+        for (auto l = m_lines.begin() + last; l != m_lines.end(); ++l)
         {
-            it->point(Point(x, y));
-            next_is_beginning_of_line = true;
-            ++it;
+            l->pos = l->pos + inserted - removed;
+            l->offset += offset;
+        }
+
+        // the following lines moved up or down, their TextRects follow lazily
+        if (shift)
+        {
+            const auto area = text_area();
+            const auto y = m_layout_origin.y() +
+                           height * static_cast<DefaultDim>(std::min(last, first + lines.size()));
+            if (y < area.bottom())
+                damage_text(Rect(area.x(), y, area.width(), area.bottom() - y));
         }
     }
+
+    count_lines(m_lines.begin() + first, m_lines.begin() + last, -1);
+    m_lines.erase(m_lines.begin() + first, m_lines.begin() + last);
+    m_lines.insert(m_lines.begin() + first, lines.begin(), lines.end());
+    count_lines(lines.begin(), lines.end(), 1);
+
+    const auto origin = text_boundaries().point() + layout_offset();
+    if (origin != m_layout_origin)
+    {
+        translate_text(origin - m_layout_origin);
+        damage_text(text_area());
+    }
+}
+
+void TextBox::translate_text(const Point& delta)
+{
+    // the TextRects follow when they are used, see settle_lines()
+    m_layout_origin += delta;
+}
+
+void TextBox::index_lines()
+{
+    auto line = m_lines.begin();
+    for (auto it = m_rects.begin(); it != m_rects.end() && line != m_lines.end(); ++it)
+    {
+        if (it->beginning_of_line())
+            (line++)->first = it;
+    }
 }
 
 void TextBox::consolidate(TextRects& rects)
@@ -651,9 +865,30 @@ void TextBox::draw_text(Painter& painter, const Rect& rect)
     painter.clip();
     painter.set(font());
 
+    /*
+     * Lines all have the same height, so the ones crossing the clip are
+     * found from their index instead of walking the whole text.
+     */
+    size_t first = 0;
+    size_t last = m_lines.size();
+    const auto height = line_height();
+    if (height > 0)
+    {
+        const auto top = clip.top() - m_layout_origin.y();
+        const auto bottom = clip.bottom() - m_layout_origin.y();
+        first = top > 0 ? top / height : 0;
+        last = bottom > 0 ? (bottom + height - 1) / height : 0;
+    }
+
+    settle_lines(first, last);
+
+    auto begin = first < m_lines.size() ? m_lines[first].first : m_rects.end();
+    auto end = last < m_lines.size() ? m_lines[last].first : m_rects.end();
+
     const auto& fe = m_fe;
-    for (const auto& r : m_rects)
+    for (auto it = begin; it != end; ++it)
     {
+        const auto& r = *it;
         if (r.text() != "\n")
         {
             if (!r.rect().intersect(rect))
@@ -684,14 +919,41 @@ void TextBox::draw_text(Painter& painter, const Rect& rect)
     }
 }
 
-void TextBox::prepare_text(TextRects& rects)
+void TextBox::prepare_text(TextRects& rects, TextLines& lines)
 {
     m_fe = detail::dummy_painter().set(font()).extents();
+    m_state = State(&font(), flags(), text_align(), text_flags());
 
     rects.clear();
+    lines.clear();
+
+    const auto height = line_height();
+    const auto max_width = wrap_width();
+
+    TextLine line;
+    line.paragraph = true;
+    while (layout_line(line, Point(0, height * static_cast<DefaultDim>(lines.size())),
+                       max_width, rects))
+    {
+        line.origin = Point(0, height * static_cast<DefaultDim>(lines.size()));
+        lines.push_back(line);
+
+        line.pos += line.length;
+        line.offset += line.size;
+        line.paragraph = line.newline;
+    }
+
+    // these lines replace m_lines
+    m_line_widths.clear();
+    m_paragraphs = 0;
+    count_lines(lines.begin(), lines.end(), 1);
+
+    m_layout_origin = text_boundaries().point() + layout_offset();
+    for (auto& r : rects)
+        r.point(r.rect().point() + m_layout_origin);
+    for (auto& l : lines)
+        l.origin += m_layout_origin;
 
-    tokenize(rects);
-    compute_layout(rects);
     set_selection(rects);
 }
 
@@ -708,8 +970,21 @@ void TextBox::get_cursor_rect()
     Point p(boundaries.point() + Point(-CURSOR_X_MARGIN, 0));
     Size s(CURSOR_RECT_WIDTH, fe.height);
 
+    // start from the line of the cursor
     size_t pos = 0;
-    for (auto itr = m_rects.cbegin(); itr != m_rects.cend(); ++itr)
+    auto itr = m_rects.cend();
+    const auto line = find_line(m_cursor_pos);
+    if (line != m_lines.cend())
+    {
+        // the cursor may be at the beginning of the next line
+        const size_t index = line - m_lines.cbegin();
+        settle_lines(index, index + 2);
+
+        pos = line->pos;
+        itr = line->first;
+    }
+
+    for (; itr != m_rects.cend(); ++itr)
     {
         const auto& r = *itr;
 
@@ -747,9 +1022,7 @@ void TextBox::get_cursor_rect()
 
         auto it = r.text().begin();
         utf8::advance(it, m_cursor_pos - pos, r.text().end());
-        std::string str(r.text().begin(), it);
-
-        const auto te = painter.extents(str);
+        const auto te = painter.extents(std::string_view(r.text()).substr(0, it - r.text().begin()));
 
         p = r.rect().point();
         p.x(p.x() + te.x_advance - CURSOR_X_MARGIN);
@@ -762,7 +1035,7 @@ void TextBox::get_cursor_rect()
 
 void TextBox::refresh_text_area()
 {
-    prepare_text(m_rects);
+    prepare_text(m_rects, m_lines);
     get_cursor_rect();
     invalidate_text_rect();
     update_sliders();
@@ -797,7 +1070,8 @@ void TextBox::init_sliders()
     auto redraw = [this]()
     {
         damage();
-        prepare_text(m_rects);
+        // scrolling only moves the text
+        translate_text(text_boundaries().point() + layout_offset() - m_layout_origin);
         get_cursor_rect();
         invalidate_text_rect();
     };
@@ -1058,7 +1332,7 @@ TextBox::TextBox(const std::string& text,
 m_timer(std::chrono::seconds(1)),
 m_text_flags(flags)
 {
-    name("TextBox" + std::to_string(m_widgetid));
+    name_prefix("TextBox");
     initialize();
 
     insert(text);
@@ -1417,6 +1691,9 @@ void TextBox::text(const std::string& str)
 void TextBox::clear()
 {
     m_rects.clear();
+    m_lines.clear();
+    m_line_widths.clear();
+    m_paragraphs = 0;
     selection_clear();
     cursor_begin();
     TextWidget::clear();
@@ -1437,6 +1714,7 @@ void TextBox::max_length(size_t len)
                 auto i = m_text.begin();
                 utf8::advance(i, m_max_len, m_text.end());
                 m_text.erase(i, m_text.end());
+                refresh_text_area();
                 on_text_changed.invoke();
             }
         }
@@ -1459,10 +1737,10 @@ size_t TextBox::width_to_len(const std::string& str) const
 
     size_t len = 0;
     float total = 0;
-    for (detail::utf8_const_iterator ch(str.begin(), str.begin(), str.end());
-         ch != detail::utf8_const_iterator(str.end(), str.begin(), str.end()); ++ch)
+    for (size_t pos = 0; pos < str.size();)
     {
-        const auto txt = detail::utf8_char_to_string(ch.base(), str.cend());
+        const auto txt = detail::utf8_char_view(str, pos);
+        pos += txt.size();
         const auto te = painter.extents(txt);
         if (total + static_cast<float>(te.x_advance) > b.width())
             return len;
@@ -1522,14 +1800,10 @@ size_t TextBox::insert(const std::string& str)
         utf8::advance(end, len, str.end());
         m_text.insert(i, str.begin(), end);
         selection_clear();
+        relayout_text(m_cursor_pos, 0, len);
 
         on_text_changed.invoke();
 
-        TextRects rects;
-        prepare_text(rects);
-        tag_text(m_rects, rects);
-        m_rects = std::move(rects);
-
         cursor_forward(len);
         continue_show_cursor();
         invalidate_text_rect();
@@ -1606,6 +1880,7 @@ void TextBox::selection_damage()
 {
     detail::dummy_painter().set(font());
 
+    settle_lines(0, m_lines.size());
     consolidate(m_rects);
     TextRects rects(m_rects);
     clear_selection(rects);
@@ -1613,6 +1888,7 @@ void TextBox::selection_damage()
     set_selection(rects);
     tag_text_selection(m_rects, rects);
     m_rects = std::move(rects);
+    index_lines();
 }
 
 void TextBox::selection(size_t pos, size_t length)
@@ -1717,20 +1993,17 @@ void TextBox::selection_delete()
 {
     if (m_select_len)
     {
+        const auto length = m_select_len;
         auto i = m_text.begin();
         utf8::advance(i, m_select_start, m_text.end());
         auto l = i;
-        utf8::advance(l, m_select_len, m_text.end());
+        utf8::advance(l, length, m_text.end());
 
         m_text.erase(i, l);
         selection_clear();
+        relayout_text(m_select_start, length, 0);
         on_text_changed.invoke();
 
-        TextRects rects;
-        prepare_text(rects);
-        tag_text(m_rects, rects);
-        m_rects = std::move(rects);
-
         cursor_set(m_select_start);
         invalidate_text_rect();
         update_sliders();
@@ -1806,10 +2079,33 @@ void TextBox::hide_cursor()
 
 size_t TextBox::point2pos(const Point& p) const
 {
-    size_t pos = 0;
-    for (const auto& r : m_rects)
+    if (m_lines.empty())
+        return 0;
+
+    // skip the lines above the point
+    size_t index = 0;
+    const auto height = line_height();
+    const auto y = p.y() - m_layout_origin.y() - height;
+    if (y > 0 && height > 0)
+        index = std::min<size_t>((y + height - 1) / height, m_lines.size() - 1);
+
+    /*
+     * This is const, so the TextRects are not moved to their line: the point
+     * is moved by as much as they lag behind instead.
+     */
+    auto delta = line_origin(index) - m_lines[index].origin;
+
+    size_t pos = m_lines[index].pos;
+    for (auto it = m_lines[index].first; it != m_rects.end(); ++it)
     {
-        const auto& rect = r.rect();
+        if (index + 1 < m_lines.size() && it == m_lines[index + 1].first)
+        {
+            ++index;
+            delta = line_origin(index) - m_lines[index].origin;
+        }
+
+        const auto& r = *it;
+        const auto rect = r.rect() + delta;
 
         if (rect.bottom() < p.y())
         {
@@ -1861,7 +2157,15 @@ size_t TextBox::beginning_of_line(size_t cursor_pos) const
     size_t pos = 0;
     size_t bol = pos;
 
-    for (auto it = m_rects.cbegin(); it != m_rects.cend(); ++it)
+    auto it = m_rects.cend();
+    const auto line = find_line(cursor_pos);
+    if (line != m_lines.cend())
+    {
+        pos = line->pos;
+        it = line->first;
+    }
+
+    for (; it != m_rects.cend(); ++it)
     {
         if (it->beginning_of_line())
             bol = pos;
@@ -1892,7 +2196,15 @@ size_t TextBox::end_of_line(size_t cursor_pos) const
     size_t pos = 0;
     size_t eol = pos;
 
-    for (auto it = m_rects.cbegin(); it != m_rects.cend(); ++it)
+    auto it = m_rects.cend();
+    const auto line = find_line(cursor_pos);
+    if (line != m_lines.cend())
+    {
+        pos = line->pos;
+        it = line->first;
+    }
+
+    for (; it != m_rects.cend(); ++it)
     {
         auto next = std::next(it);
 
@@ -1960,12 +2272,18 @@ Rect TextBox::text_rect() const
     {
         m_text_rect.clear();
 
-        for (const auto& rect : m_rects)
+        const auto height = line_height();
+        for (size_t i = 0; i < m_lines.size(); ++i)
         {
-            if (rect.text() == "\n")
+            const auto& line = m_lines[i];
+
+            // a newline alone on its line does not count
+            if (line.newline && line.length == 1)
                 continue;
 
-            const auto& r = rect.rect();
+            const Rect r(m_layout_origin.x(),
+                         m_layout_origin.y() + height * static_cast<DefaultDim>(i),
+                         line.width, height);
 
             if (m_text_rect.empty())
                 m_text_rect = r;
@@ -1996,11 +2314,7 @@ Size TextBox::min_size_hint() const
     if (!m_min_size.empty())
         return m_min_size;
 
-    auto text = m_text;
-    if (text.empty())
-        text = "Hello World";
-
-    auto s = text_size(text);
+    auto s = m_text.empty() ? text_size("Hello World") : text_size_hint();
     s += Widget::min_size_hint() + Size(0, CURSOR_Y_OFFSET * 2.);
 
     if (text_flags().is_set(TextBox::TextFlag::horizontal_scrollable))
@@ -8,7 +8,12 @@
 #include "egt/painter.h"
 #include "egt/serialize.h"
 #include "egt/textwidget.h"
-#include <deque>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <list>
+#include <string_view>
+#include <unordered_map>
 
 namespace egt
 {
@@ -33,6 +38,8 @@ TextWidget::TextWidget(Serializer::Properties& props, bool is_derived) noexcept
         deserialize_leaf(props);
 }
 
+TextWidget::~TextWidget() noexcept = default;
+
 void TextWidget::clear()
 {
     if (!m_text.empty())
@@ -58,85 +65,301 @@ size_t TextWidget::len() const
     return detail::utf8len(m_text);
 }
 
-Font TextWidget::scale_font(const Size& target, const std::string& text, const Font& font)
+/*
+ * Last size found by scale_font() for a font, a target, and a text length.
+ */
+struct ScaleFontCache
+{
+    struct Key
+    {
+        uint32_t font;
+        DefaultDim width;
+        DefaultDim height;
+        size_t length;
+
+        bool operator==(const Key& rhs) const
+        {
+            return font == rhs.font && width == rhs.width &&
+                   height == rhs.height && length == rhs.length;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            size_t seed = key.font;
+            for (const size_t value : {static_cast<size_t>(key.width),
+                                       static_cast<size_t>(key.height),
+                                       key.length})
+                seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+    };
+
+    void add(const Key& key, Font::Size size)
+    {
+        static constexpr auto MAX_CACHE_ITEMS = 256;
+        if (sizes.size() >= MAX_CACHE_ITEMS)
+            sizes.clear();
+        sizes[key] = size;
+    }
+
+    std::unordered_map<Key, Font::Size, KeyHash> sizes;
+};
+
+static ScaleFontCache scale_font_cache;
+
+Font TextWidget::scale_font(const Size& target, std::string_view text, const Font& font)
 {
     auto& painter = detail::dummy_painter();
 
     auto nfont = font;
-    while (true)
+    auto fits = [&](Font::Size size)
     {
+        nfont.size(size);
         painter.set(nfont);
-
         const auto textext = painter.extents(text);
+        return textext.width - textext.x_bearing < target.width() &&
+               textext.height - textext.y_bearing < target.height();
+    };
 
-        if (textext.width - textext.x_bearing < target.width() &&
-            textext.height - textext.y_bearing < target.height())
-            return nfont;
+    painter.set(font);
+    const auto textext = painter.extents(text);
+    const auto text_width = textext.width - textext.x_bearing;
+    const auto text_height = textext.height - textext.y_bearing;
+    if (text_width < target.width() && text_height < target.height())
+        return font;
 
-        nfont.size(nfont.size() - 1);
-        if (nfont.size() < 1)
-            return font;
+    /*
+     * Look for the smallest step in [1, steps] whose size fits, steps being
+     * the last step before the size goes below 1.
+     */
+    const auto steps = static_cast<int>(std::floor(font.size() - 1));
+    if (steps < 1)
+        return font;
+
+    // text extents grow about linearly with the font size
+    const auto ratio = std::min(target.width() / text_width,
+                                target.height() / text_height);
+    auto guess = ratio > 0 && ratio < 1 ?
+                 static_cast<int>(std::ceil(font.size() * (1 - ratio))) : 1;
+
+    const ScaleFontCache::Key key{font.id(), target.width(), target.height(), detail::utf8len(text)};
+    const auto i = scale_font_cache.sizes.find(key);
+    if (i != scale_font_cache.sizes.end())
+        guess = static_cast<int>(std::lround(font.size() - i->second));
+
+    guess = detail::clamp(guess, 1, steps);
+
+    // the answer is in [low, high], high being a step that fits or steps + 1
+    auto low = 1;
+    auto high = steps + 1;
+    auto step = guess;
+    while (low < high)
+    {
+        if (fits(font.size() - step))
+            high = step;
+        else
+            low = step + 1;
+
+        // a good guess is usually one step off, so try its neighbor first
+        if (step == guess)
+            step = high == step ? step - 1 : step + 1;
+        if (step < low || step >= high)
+            step = low + (high - low) / 2;
     }
+
+    if (low > steps)
+        return font;
+
+    scale_font_cache.add(key, font.size() - low);
+    nfont.size(font.size() - low);
     return nfont;
 }
 
-struct SizeCache
+const Font& TextWidget::text_font() const
 {
-    struct SizeItem
+    if (!m_auto_fit)
+        return font();
+
+    const auto target = content_area().size();
+    size_t key = font().id();
+    for (const size_t value : {static_cast<size_t>(target.width()),
+                               static_cast<size_t>(target.height()),
+                               std::hash<std::string>()(m_text)})
+        key ^= value + 0x9e3779b9 + (key << 6) + (key >> 2);
+
+    if (!m_fit_font || key != m_fit_key)
     {
-        std::string text;
-        Font font;
+        m_fit_font = std::make_unique<Font>(scale_font(target, m_text, font()));
+        m_fit_key = key;
+    }
+
+    return *m_fit_font;
+}
+
+namespace detail
+{
+
+/*
+ * Least recently used text sizes, hashed by font id and text.
+ *
+ * The text is kept to tell hash collisions apart, so looking up a size does
+ * not allocate anything.
+ */
+struct TextSizeCache
+{
+    struct Key
+    {
+        uint32_t font;
+        size_t hash;
+
+        bool operator==(const Key& rhs) const
+        {
+            return font == rhs.font && hash == rhs.hash;
+        }
     };
 
-    std::deque<std::pair<SizeItem, Size>>::iterator find(const std::string& text, const Font& font)
+    struct KeyHash
     {
-        for (auto i = cache.begin(); i != cache.end(); ++i)
+        size_t operator()(const Key& key) const
         {
-            if (i->first.text == text && i->first.font == font)
-                return i;
+            return key.hash ^ (key.font + 0x9e3779b9 + (key.hash << 6) + (key.hash >> 2));
         }
+    };
 
-        return cache.end();
+    struct Entry
+    {
+        Key key;
+        std::string text;
+        Size size;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    TextSizeCache()
+    {
+        stats.capacity = 256;
+        if (const auto value = std::getenv("EGT_TEXT_SIZE_CACHE"))
+            stats.capacity = std::strtoul(value, nullptr, 10);
     }
 
-    std::deque<std::pair<SizeItem, Size>>::iterator end()
+    const Size* find(const Key& key, std::string_view text)
     {
-        return cache.end();
+        const auto i = index.find(key);
+        if (i == index.end() || i->second->text != text)
+        {
+            ++stats.misses;
+            return nullptr;
+        }
+
+        ++stats.hits;
+        entries.splice(entries.begin(), entries, i->second);
+        return &i->second->size;
     }
 
-    void add(const std::pair<SizeItem, Size>& item)
+    void add(const Key& key, std::string_view text, const Size& size)
     {
         static constexpr auto MAX_CACHE_ITEM_SIZE = 1024;
-        if (item.first.text.size() < MAX_CACHE_ITEM_SIZE)
+        if (!stats.capacity || text.size() >= MAX_CACHE_ITEM_SIZE)
+            return;
+
+        // a hash collision replaces the older text
+        const auto i = index.find(key);
+        if (i != index.end())
         {
-            cache.emplace_back(item);
+            entries.erase(i->second);
+            index.erase(i);
+        }
 
-            static constexpr auto MAX_CACHE_ITEMS = 128;
-            while (cache.size() > MAX_CACHE_ITEMS)
-                cache.pop_front();
+        entries.push_front(Entry{key, std::string(text), size});
+        index.emplace(key, entries.begin());
+        trim();
+    }
+
+    void trim()
+    {
+        while (entries.size() > stats.capacity)
+        {
+            index.erase(entries.back().key);
+            entries.pop_back();
+            ++stats.evictions;
         }
     }
 
-private:
-    std::deque<std::pair<SizeItem, Size>> cache;
+    void clear()
+    {
+        index.clear();
+        entries.clear();
+        const auto capacity = stats.capacity;
+        stats = {};
+        stats.capacity = capacity;
+    }
+
+    EntryList entries;
+    std::unordered_map<Key, EntryList::iterator, KeyHash> index;
+    TextSizeCacheStats stats;
 };
 
-static SizeCache size_cache;
+static TextSizeCache& size_cache()
+{
+    static TextSizeCache cache;
+    return cache;
+}
+
+void text_size_cache_capacity(size_t capacity)
+{
+    auto& cache = size_cache();
+    cache.stats.capacity = capacity;
+    cache.trim();
+}
+
+TextSizeCacheStats text_size_cache_stats()
+{
+    auto stats = size_cache().stats;
+    stats.size = size_cache().entries.size();
+    return stats;
+}
+
+void text_size_cache_clear()
+{
+    size_cache().clear();
+}
+
+}
 
-Size TextWidget::text_size(const std::string& text) const
+Size TextWidget::text_size(std::string_view text) const
 {
-    auto i = size_cache.find(text, this->font());
-    if (i != size_cache.end())
-        return i->second;
+    auto& cache = detail::size_cache();
+    const detail::TextSizeCache::Key key{this->font().id(), std::hash<std::string_view>()(text)};
+
+    if (const auto size = cache.find(key, text))
+        return *size;
 
     auto& painter = detail::dummy_painter();
     painter.set(this->font());
 
     auto size = painter.text_size(text);
-    size_cache.add(std::make_pair(SizeCache::SizeItem{text, this->font()}, size));
+    cache.add(key, text, size);
     return size;
 }
 
+Size TextWidget::text_size_hint() const
+{
+    size_t key = font().id();
+    key ^= std::hash<std::string>()(m_text) + 0x9e3779b9 + (key << 6) + (key >> 2);
+
+    if (!m_text_size_valid || key != m_text_size_key)
+    {
+        m_text_size_hint = text_size(m_text);
+        m_text_size_key = key;
+        m_text_size_valid = true;
+    }
+
+    return m_text_size_hint;
+}
+
 void TextWidget::serialize(Serializer& serializer) const
 {
     Widget::serialize(serializer);
@@ -144,6 +367,8 @@ void TextWidget::serialize(Serializer& serializer) const
         serializer.add_property("text", text());
     if (!text_align().empty())
         serializer.add_property("text_align", text_align());
+    if (auto_fit())
+        serializer.add_property("auto_fit", auto_fit());
 }
 
 void TextWidget::deserialize(Serializer::Properties& props)
@@ -154,6 +379,8 @@ void TextWidget::deserialize(Serializer::Properties& props)
             text(std::get<1>(p));
         else if (std::get<0>(p) == "text_align")
             text_align(AlignFlags(std::get<1>(p)));
+        else if (std::get<0>(p) == "auto_fit")
+            auto_fit(detail::from_string(std::get<1>(p)));
         else
             return false;
 
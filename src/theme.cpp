@@ -39,6 +39,8 @@ void global_theme(std::unique_ptr<Theme>&& theme)
 
     if (the_global_theme)
         the_global_theme->apply();
+
+    detail::palette_changed();
 }
 
 static Pattern pattern(const Color& color)
@@ -28,7 +28,7 @@ void ShamrockTheme::init_draw()
         detail::draw_text(painter,
                           widget.content_area(),
                           widget.text(),
-                          widget.font(),
+                          widget.text_font(),
         {TextBox::TextFlag::multiline, TextBox::TextFlag::word_wrap},
         widget.text_align(),
         Justification::middle,
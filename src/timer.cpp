@@ -5,6 +5,7 @@
  */
 #include "detail/asioallocator.h"
 #include "egt/app.h"
+#include "egt/detail/timerwheel.h"
 #include "egt/eventloop.h"
 #include "egt/timer.h"
 
@@ -16,6 +17,26 @@ inline namespace v1
 struct Timer::TimerImpl
 {
     detail::HandlerAllocator allocator;
+
+    /// Entry of the timer in the timer wheel, when it is enabled.
+    detail::TimerWheel::Entry entry;
+
+    /**
+     * Start the timer on the timer wheel.
+     *
+     * @return false if the timer wheel is not enabled.
+     */
+    bool wheel_start(std::chrono::milliseconds duration,
+                     detail::TimerWheel::Callback callback)
+    {
+        auto wheel = Application::instance().event().timer_wheel();
+        if (!wheel)
+            return false;
+
+        entry.callback = std::move(callback);
+        wheel->schedule(entry, duration);
+        return true;
+    }
 };
 
 Timer::Timer() noexcept
@@ -35,9 +56,15 @@ Timer::Timer(std::chrono::milliseconds duration) noexcept
 
 void Timer::start()
 {
+    m_running = false;
+    if (m_impl->wheel_start(m_duration, [this]() { internal_timer_callback({}); }))
+    {
+        m_running = true;
+        return;
+    }
+
     // error::operation_aborted occurs when expires_from_now() is called on the
     // timer while it is pending, we handle this ourselves with m_running
-    m_running = false;
     m_timer.expires_after(m_duration);
     m_running = true;
 #ifdef USE_PRIORITY_QUEUE
@@ -84,6 +111,8 @@ void Timer::do_cancel()
 {
     m_running = false;
     m_timer.cancel();
+    if (m_impl)
+        m_impl->entry.cancel();
 }
 
 void Timer::internal_timer_callback(const asio::error_code& error)
@@ -162,9 +191,15 @@ Timer::~Timer() noexcept
 
 void PeriodicTimer::start()
 {
+    m_running = false;
+    if (m_impl->wheel_start(m_duration, [this]() { internal_timer_callback({}); }))
+    {
+        m_running = true;
+        return;
+    }
+
     // error::operation_aborted occurs when expires_from_now() is called on the
     // timer while it is pending, we handle this ourselves with m_running
-    m_running = false;
     m_timer.expires_after(m_duration);
     m_running = true;
 
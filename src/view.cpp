@@ -28,7 +28,7 @@ ScrolledView::ScrolledView(const Rect& rect,
       m_horizontal_policy(horizontal_policy),
       m_vertical_policy(vertical_policy)
 {
-    name("ScrolledView" + std::to_string(m_widgetid));
+    name_prefix("ScrolledView");
 
     // scrolled views are not transparent by default
     fill_flags(Theme::FillFlag::solid);
@@ -136,17 +136,31 @@ void ScrolledView::draw(Painter& painter, const Rect& rect)
         auto r = Rect::intersection(rect, content);
         auto crect = to_child(r) - m_offset;
 
-        for (auto& child : children())
+        const auto draw_child = [this, &painter, &crect](Widget * child)
         {
             if (!child->visible())
-                continue;
+                return;
 
             // don't draw plane frame as child - this is
             // specifically handled by event loop
             if (child->plane_window())
-                continue;
+                return;
 
-            draw_subordinate(painter, crect, child.get());
+            draw_subordinate(painter, crect, child);
+        };
+
+        if (auto index = spatial_index())
+        {
+            // only visit the children in the damaged rectangle
+            std::vector<Widget*> widgets;
+            index->query(crect, widgets);
+            for (auto child : widgets)
+                draw_child(child);
+        }
+        else
+        {
+            for (auto& child : children())
+                draw_child(child.get());
         }
     }
 
@@ -138,7 +138,7 @@ void VirtualKeyboard::initialize(const std::vector<PanelKeys>& keys)
 VirtualKeyboard::VirtualKeyboard(const std::vector<PanelKeys>& keys, const Rect& rect)
     : Frame(rect)
 {
-    name("VirtualKeyboard" + std::to_string(m_widgetid));
+    name_prefix("VirtualKeyboard");
     initialize(keys);
 }
 
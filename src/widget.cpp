@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 #include "detail/egtlog.h"
+#include "egt/animation.h"
 #include "egt/detail/alignment.h"
 #include "egt/detail/enum.h"
 #include "egt/detail/math.h"
@@ -18,9 +19,12 @@
 #include "egt/surface.h"
 #include "egt/types.h"
 #include "egt/widget.h"
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include "detail/dump.h"
 
@@ -90,6 +94,41 @@ Widget::Widget(Frame& parent, const Rect& rect, const Widget::Flags& flags) noex
     parent.add(*this);
 }
 
+/**
+ * Targets of the last pointer events, for a few widgets down the hierarchy.
+ *
+ * A stream of pointer moves usually goes to the same widgets, so this saves
+ * looking through the subordinates of each of them again. Entries are only
+ * valid for the generation they were added in, which changes when any
+ * subordinate is added, removed, or reordered. Moving or resizing a
+ * subordinate only updates the entry of its parent.
+ */
+struct HitCache
+{
+    struct Entry
+    {
+        const Widget* parent{nullptr};
+        Widget* target{nullptr};
+        /// point_from_subordinate() of the target.
+        Point offset;
+        uint32_t generation{0};
+        /// No subordinate above the target overlaps it.
+        bool exclusive{false};
+    };
+
+    std::array<Entry, 16> entries{};
+    size_t next{0};
+    uint32_t generation{1};
+};
+
+static HitCache hit_cache;
+
+static void invalidate_hit_cache()
+{
+    if (++hit_cache.generation == 0)
+        ++hit_cache.generation;
+}
+
 void Widget::handle(Event& event)
 {
     if (event.quit())
@@ -129,21 +168,57 @@ void Widget::handle(Event& event)
         {
             const auto p = display_to_local(event.pointer().point) + point();
 
-            for (auto& subordinate : detail::reverse_iterate(m_subordinates))
+            // a stream of pointer events usually goes to the same target
+            Widget* target = cached_target(p);
+            if (!target)
             {
-                if (!subordinate->can_handle_event())
-                    continue;
-
-                const auto p2 = p - point_from_subordinate(*subordinate);
-                if (subordinate->box().intersect(p2))
+                if (auto index = spatial_index())
                 {
-                    subordinate->handle(event);
-                    if (event.postponed_quit())
-                        event.stop();
-                    break;
+                    // components are on top of children
+                    for (auto& component : detail::reverse_iterate(components()))
+                    {
+                        if (component->can_handle_event() &&
+                            component->box().intersect(p - point_from_subordinate(*component)))
+                        {
+                            target = component.get();
+                            break;
+                        }
+                    }
+
+                    if (!target)
+                    {
+                        const auto p2 = p - point_from_subordinate(**children().begin());
+                        target = index->top(p2, [](Widget * widget)
+                        {
+                            return widget->can_handle_event();
+                        });
+                    }
+                }
+                else
+                {
+                    for (auto& subordinate : detail::reverse_iterate(m_subordinates))
+                    {
+                        if (!subordinate->can_handle_event())
+                            continue;
+
+                        const auto p2 = p - point_from_subordinate(*subordinate);
+                        if (subordinate->box().intersect(p2))
+                        {
+                            target = subordinate.get();
+                            break;
+                        }
+                    }
                 }
             }
 
+            if (target)
+            {
+                cache_target(target);
+                target->handle(event);
+                if (event.postponed_quit())
+                    event.stop();
+            }
+
             break;
         }
 
@@ -151,8 +226,13 @@ void Widget::handle(Event& event)
         case EventId::keyboard_up:
         case EventId::keyboard_repeat:
         {
-            for (auto& subordinate : detail::reverse_iterate(m_subordinates))
+            // handlers may add or remove subordinates
+            for (auto i = m_subordinates.size(); i-- > 0;)
             {
+                if (i >= m_subordinates.size())
+                    continue;
+
+                auto subordinate = m_subordinates[i].get();
                 if (!subordinate->can_handle_event())
                     continue;
 
@@ -250,6 +330,7 @@ void Widget::resize(const Size& size)
     {
         damage();
         m_box.size(size);
+        update_parent_spatial_index();
         damage();
 
         // If resize comes from the user
@@ -259,7 +340,7 @@ void Widget::resize(const Size& size)
         parent_layout();
 
         if (!m_subordinates.empty())
-            layout();
+            request_layout();
     }
 }
 
@@ -276,6 +357,7 @@ void Widget::move(const Point& point)
     {
         damage();
         m_box.point(point);
+        update_parent_spatial_index();
         damage();
 
         // If move comes from the user
@@ -466,6 +548,8 @@ void Widget::damage(const Rect& rect)
     if (!visible())
         return;
 
+    detail::animation_damaged(this);
+
     // damage propagates up to widget with screen
     if (!has_screen())
     {
@@ -520,6 +604,7 @@ Palette::GroupId Widget::group() const
 void Widget::palette(const Palette& palette)
 {
     m_palette = std::make_unique<Palette>(palette);
+    reset_color_cache();
     damage();
 }
 
@@ -528,6 +613,7 @@ void Widget::reset_palette()
     if (m_palette)
     {
         m_palette.reset();
+        reset_color_cache();
         damage();
     }
 }
@@ -538,6 +624,39 @@ const Pattern& Widget::color(Palette::ColorId id) const
 }
 
 const Pattern& Widget::color(Palette::ColorId id, Palette::GroupId group) const
+{
+    const auto generation = detail::palette_generation();
+
+    if (!m_color_cache)
+        m_color_cache = std::make_unique<ColorCache>();
+
+    if (m_color_cache->generation == generation)
+    {
+        for (const auto& entry : m_color_cache->entries)
+        {
+            if (entry.id == id && entry.group == group)
+                return entry.color;
+        }
+    }
+    else
+    {
+        m_color_cache->entries.clear();
+        m_color_cache->generation = generation;
+    }
+
+    m_color_cache->entries.push_front({id, group, resolve_color(id, group)});
+    return m_color_cache->entries.front().color;
+}
+
+void Widget::reset_color_cache()
+{
+    m_color_cache.reset();
+
+    for (auto& subordinate : m_subordinates)
+        subordinate->reset_color_cache();
+}
+
+const Pattern& Widget::resolve_color(Palette::ColorId id, Palette::GroupId group) const
 {
     if (m_palette)
     {
@@ -581,24 +700,50 @@ Image* Widget::background(bool allow_fallback) const
 
 Image* Widget::background(Palette::GroupId group, bool allow_fallback) const
 {
-    return m_backgrounds.get(group, allow_fallback);
+    if (!m_extra)
+        return nullptr;
+
+    return m_extra->backgrounds.get(group, allow_fallback);
 }
 
 void Widget::background(const Image& image,
                         Palette::GroupId group)
 {
-    m_backgrounds.set(group, image);
+    extra().backgrounds.set(group, image);
     if (group == this->group())
         damage();
 }
 
 void Widget::reset_background(Palette::GroupId group)
 {
-    auto changed = m_backgrounds.reset(group);
+    if (!m_extra)
+        return;
+
+    auto changed = m_extra->backgrounds.reset(group);
     if (changed && group == this->group())
         damage();
 }
 
+Widget::Extra& Widget::extra()
+{
+    if (!m_extra)
+        m_extra = std::make_unique<Extra>();
+    return *m_extra;
+}
+
+void Widget::name_prefix(const char* prefix)
+{
+    m_name_prefix = prefix;
+}
+
+std::string Widget::default_name() const
+{
+    if (!m_name_prefix)
+        return {};
+
+    return m_name_prefix + std::to_string(m_widgetid);
+}
+
 const Palette& Widget::palette() const
 {
     if (m_palette)
@@ -668,6 +813,8 @@ Size Widget::min_size_hint() const
 
 void Widget::paint(Painter& painter)
 {
+    flush_layout_requests();
+
     Painter::AutoSaveRestore sr(painter);
 
     auto save = painter.set_subordinate_filter(nullptr);
@@ -769,13 +916,8 @@ void Widget::zorder_down(const Widget* widget)
         (*i)->damage();
         (*to)->damage();
         std::iter_swap(i, to);
-        if (to == begin)
-        {
-            if (widget->component())
-                m_components_begin = to;
-            update_subordinates_ranges();
-        }
-        layout();
+        invalidate_spatial_index();
+        request_layout();
     }
 }
 
@@ -798,13 +940,8 @@ void Widget::zorder_up(const Widget* widget)
             (*i)->damage();
             (*to)->damage();
             std::iter_swap(i, to);
-            if (i == begin)
-            {
-                if (widget->component())
-                    m_components_begin = i;
-                update_subordinates_ranges();
-            }
-            layout();
+            invalidate_spatial_index();
+            request_layout();
         }
     }
 }
@@ -826,11 +963,9 @@ void Widget::zorder_bottom(const Widget* widget)
 
     if (i != end && i != begin)
     {
-        m_subordinates.splice(begin, m_subordinates, i, std::next(i));
-        if (widget->component())
-            m_components_begin = i;
-        update_subordinates_ranges();
-        layout();
+        std::rotate(begin, i, std::next(i));
+        invalidate_spatial_index();
+        request_layout();
     }
 }
 
@@ -850,14 +985,9 @@ void Widget::zorder_top(const Widget* widget)
     });
     if (i != end && i != std::prev(end))
     {
-        m_subordinates.splice(end, m_subordinates, i, std::next(i));
-        if (i == begin)
-        {
-            if (widget->component())
-                m_components_begin = std::next(i);
-            update_subordinates_ranges();
-        }
-        layout();
+        std::rotate(i, std::next(i), end);
+        invalidate_spatial_index();
+        request_layout();
     }
 }
 
@@ -895,16 +1025,12 @@ void Widget::zorder(const Widget* widget, size_t rank)
         {
             auto j = std::next(begin, rank);
             if (rank > old_rank)
-                std::advance(j, 1);
+                std::rotate(i, std::next(i), std::next(j));
+            else
+                std::rotate(j, i, std::next(i));
 
-            m_subordinates.splice(j, m_subordinates, i, std::next(i));
-            if (i == begin || j == begin)
-            {
-                if (widget->component())
-                    m_components_begin = i;
-                update_subordinates_ranges();
-            }
-            layout();
+            invalidate_spatial_index();
+            request_layout();
         }
     }
 }
@@ -976,12 +1102,14 @@ void Widget::layout()
 
         auto area = content_area();
 
-        for (auto& subordinate : m_subordinates)
+        // layout() of a subordinate may add or remove subordinates
+        for (size_t i = 0; i < m_subordinates.size(); ++i)
         {
             auto bounding = to_subordinate(area);
             if (bounding.empty())
                 continue;
 
+            auto subordinate = m_subordinates[i];
             subordinate->layout();
 
             const auto orig = subordinate->align().is_set(AlignFlag::keep_ratio) ?
@@ -1033,7 +1161,7 @@ std::string Widget::type() const
 
 void Widget::init(void)
 {
-    m_components_begin = m_subordinates.begin();
+    m_components_begin = 0;
     update_subordinates_ranges();
 
     m_align.on_change([this]()
@@ -1106,7 +1234,8 @@ void Widget::serialize(Serializer& serializer) const
     {
         m_palette->serialize("color", serializer);
     }
-    m_backgrounds.serialize(serializer);
+    if (m_extra)
+        m_extra->backgrounds.serialize(serializer);
 }
 
 void Widget::deserialize_leaf(Serializer::Properties& props)
@@ -1134,8 +1263,13 @@ void Widget::deserialize(Serializer::Properties& props)
         auto name = std::get<0>(p);
         auto value = std::get<1>(p);
 
-        if (m_backgrounds.deserialize(name, value))
+        // only allocate the rarely used state for a background image
+        Palette::GroupId group;
+        if (ImageGroup::property_group(name, "bg", group))
+        {
+            extra().backgrounds.set(group, Image(value));
             return true;
+        }
 
         switch (detail::hash(name))
         {
@@ -1229,10 +1363,37 @@ void Widget::deserialize(Serializer::Properties& props)
     }), props.end());
 }
 
+/*
+ * Widgets with a layout request, in the order of the requests, and the
+ * widgets being laid out by flush_layout_requests().
+ */
+static std::vector<Widget*> layout_requests;
+static std::vector<std::pair<size_t, Widget*>> layout_pass;
+static bool layout_flushing = false;
+
+static void cancel_layout_request(Widget* widget)
+{
+    if (widget->layout_requested())
+    {
+        layout_requests.erase(std::remove(layout_requests.begin(),
+                                          layout_requests.end(), widget),
+                              layout_requests.end());
+    }
+
+    if (layout_flushing)
+    {
+        for (auto& w : layout_pass)
+        {
+            if (w.second == widget)
+                w.second = nullptr;
+        }
+    }
+}
+
 Widget::~Widget() noexcept
 {
-    for (auto& i : components())
-        remove_component(i.get());
+    while (!components().empty())
+        remove_component(components().rbegin()->get());
     detach();
 
     if (detail::mouse_grab() == this)
@@ -1243,6 +1404,13 @@ Widget::~Widget() noexcept
 
     if (detail::dragged() == this)
         detail::dragged(nullptr);
+
+    detail::forget_animation_target(this);
+
+    // the address of this widget may be reused
+    invalidate_hit_cache();
+
+    cancel_layout_request(this);
 }
 
 void Widget::set_parent(Widget* parent)
@@ -1256,6 +1424,8 @@ void Widget::set_parent(Widget* parent)
         throw std::runtime_error("cannot add a widget to itself");
 
     m_parent = parent;
+    // colors now come from the palettes of the new parents
+    reset_color_cache();
     damage();
 }
 
@@ -1276,7 +1446,64 @@ void Widget::parent_layout()
         return;
 
     if (parent())
-        parent()->layout();
+        parent()->request_layout();
+}
+
+void Widget::request_layout()
+{
+    if (m_layout_requested)
+        return;
+
+    m_layout_requested = true;
+    layout_requests.push_back(this);
+}
+
+void Widget::flush_layout_requests()
+{
+    if (layout_flushing)
+        return;
+
+    layout_flushing = true;
+    auto reset = detail::on_scope_exit([]() { layout_flushing = false; });
+
+    /*
+     * A layout can request more layouts, like a sizer that grows and needs
+     * its parent to make room for it, so this runs until there are no more
+     * requests, with a limit in case layouts keep requesting each other.
+     */
+    static constexpr auto MAX_LAYOUT_PASSES = 16;
+    for (auto pass = 0; pass < MAX_LAYOUT_PASSES && !layout_requests.empty(); ++pass)
+    {
+        layout_pass.clear();
+        for (auto widget : layout_requests)
+        {
+            size_t depth = 0;
+            for (auto p = widget->parent(); p; p = p->parent())
+                ++depth;
+
+            widget->m_layout_requested = false;
+            layout_pass.emplace_back(depth, widget);
+        }
+        layout_requests.clear();
+
+        // parents first, so children are laid out in their final box
+        std::stable_sort(layout_pass.begin(), layout_pass.end(),
+                         [](const auto & a, const auto & b)
+        {
+            return a.first < b.first;
+        });
+
+        for (const auto& w : layout_pass)
+        {
+            if (w.second)
+                w.second->layout();
+        }
+    }
+
+    layout_pass.clear();
+
+    if (!layout_requests.empty())
+        EGTLOG_DEBUG("{} layout requests left for the next frame", layout_requests.size());
 }
 
 DisplayPoint Widget::local_to_display(const Point& p) const
@@ -1387,6 +1614,49 @@ void Widget::draw(Painter& painter, const Rect& rect)
     // keep the crect inside our content area
     crect = Rect::intersection(crect, to_subordinate(content_area()));
 
+    if (auto index = spatial_index())
+    {
+        /*
+         * Only visit the children in the damaged rectangle. Draws of children
+         * nest, so each takes its own vector from a pool of the vectors used
+         * by previous draws, instead of allocating one.
+         */
+        static std::vector<std::vector<Widget*>> pool;
+        std::vector<Widget*> widgets;
+        if (!pool.empty())
+        {
+            widgets = std::move(pool.back());
+            pool.pop_back();
+        }
+
+        index->query(crect, widgets);
+        for (auto child : widgets)
+        {
+            if (!child->visible())
+                continue;
+
+            if (painter.filter_subordinate(*child))
+                continue;
+
+            draw_subordinate(painter, crect, child);
+        }
+
+        pool.push_back(std::move(widgets));
+
+        for (auto& component : components())
+        {
+            if (!component->visible())
+                continue;
+
+            if (painter.filter_subordinate(*component))
+                continue;
+
+            draw_subordinate(painter, crect, component.get());
+        }
+
+        return;
+    }
+
     for (auto& subordinate : m_subordinates)
     {
         if (!subordinate->visible())
@@ -1399,6 +1669,156 @@ void Widget::draw(Painter& painter, const Rect& rect)
     }
 }
 
+detail::SpatialIndex* Widget::spatial_index()
+{
+    if (m_subordinates.size() < detail::SpatialIndex::threshold() || children().empty())
+    {
+        m_spatial_index.reset();
+        return nullptr;
+    }
+
+    if (!m_spatial_index)
+        m_spatial_index = std::make_unique<detail::SpatialIndex>();
+
+    if (!m_spatial_index->valid())
+        m_spatial_index->build(children().begin(), children().end());
+
+    return m_spatial_index.get();
+}
+
+void Widget::invalidate_spatial_index()
+{
+    invalidate_hit_cache();
+
+    if (m_spatial_index)
+        m_spatial_index->clear();
+}
+
+void Widget::update_parent_spatial_index()
+{
+    if (!m_parent)
+        return;
+
+    if (m_parent->m_spatial_index)
+        m_parent->m_spatial_index->update(*this);
+
+    /*
+     * Only the target cached in the parent may be affected: it may be this
+     * widget, which may now be overlapped, or be overlapped by this widget.
+     * Dropping just that entry keeps a drag from missing the cache at every
+     * move.
+     */
+    for (auto& entry : hit_cache.entries)
+    {
+        if (entry.parent != m_parent || entry.generation != hit_cache.generation)
+            continue;
+
+        if (entry.target == this)
+            entry.exclusive = !m_parent->overlapped(*this);
+        else if (!entry.exclusive ||
+                 (box() + m_parent->point_from_subordinate(*this)).intersect(
+                     entry.target->box() + entry.offset))
+            entry.generation = 0;
+
+        break;
+    }
+}
+
+Widget* Widget::cached_target(const Point& point) const
+{
+    for (const auto& entry : hit_cache.entries)
+    {
+        if (entry.parent != this)
+            continue;
+
+        if (entry.generation != hit_cache.generation || !entry.exclusive)
+            return nullptr;
+
+        // the target itself may have been hidden or disabled
+        auto target = entry.target;
+        if (!target->can_handle_event())
+            return nullptr;
+
+        const auto offset = point_from_subordinate(*target);
+        if (offset != entry.offset || !target->box().intersect(point - offset))
+            return nullptr;
+
+        return target;
+    }
+
+    return nullptr;
+}
+
+void Widget::cache_target(Widget* target)
+{
+    auto entry = std::find_if(hit_cache.entries.begin(), hit_cache.entries.end(),
+                              [this](const HitCache::Entry & entry)
+    {
+        return entry.parent == this;
+    });
+
+    const auto offset = point_from_subordinate(*target);
+    if (entry != hit_cache.entries.end() &&
+        entry->generation == hit_cache.generation &&
+        entry->target == target &&
+        entry->offset == offset)
+        return;
+
+    if (entry == hit_cache.entries.end())
+    {
+        entry = hit_cache.entries.begin() + hit_cache.next;
+        hit_cache.next = (hit_cache.next + 1) % hit_cache.entries.size();
+    }
+
+    entry->parent = this;
+    entry->target = target;
+    entry->offset = offset;
+    entry->generation = hit_cache.generation;
+    entry->exclusive = !overlapped(*target);
+}
+
+bool Widget::overlapped(const Widget& target)
+{
+    /*
+     * Any subordinate above the target counts, even one that cannot handle
+     * events, because it may be shown or enabled without the generation of
+     * the hit cache changing.
+     */
+    const auto box = target.box() + point_from_subordinate(target);
+
+    auto i = std::find_if(m_subordinates.begin(), m_subordinates.end(),
+                          [&target](const std::shared_ptr<Widget>& subordinate)
+    {
+        return subordinate.get() == &target;
+    });
+    if (i == m_subordinates.end())
+        return true;
+
+    auto first = std::next(i);
+    if (!target.component())
+    {
+        if (auto index = spatial_index())
+        {
+            // found children are in zorder, so any after the target is above it
+            static std::vector<Widget*> found;
+            index->query(box - point_from_subordinate(target), found);
+            auto j = std::find(found.begin(), found.end(), &target);
+            if (j != found.end() && std::next(j) != found.end())
+                return true;
+
+            first = std::next(m_subordinates.begin(), m_components_begin);
+        }
+    }
+
+    for (auto k = first; k != m_subordinates.end(); ++k)
+    {
+        if ((*k)->box().intersect(box - point_from_subordinate(**k)))
+            return true;
+    }
+
+    return false;
+}
+
 static inline bool time_subordinate_draw_enabled()
 {
     static int value = 0;
@@ -1421,6 +1841,10 @@ void Widget::draw_subordinate(Painter& painter, const Rect& crect, Widget* subor
         if (r.empty())
             return;
 
+        // only build the name of the subordinate when it is printed
+        const auto timed = time_subordinate_draw_enabled();
+        const auto prefix = timed ? subordinate->name() + " draw: " : std::string();
+
         if (detail::float_equal(subordinate->alpha(), 1.f))
         {
             Painter::AutoSaveRestore sr2(painter);
@@ -1433,7 +1857,7 @@ void Widget::draw_subordinate(Painter& painter, const Rect& crect, Widget* subor
                 painter.clip();
             }
 
-            detail::code_timer(time_subordinate_draw_enabled(), subordinate->name() + " draw: ", [subordinate, &painter, &r]()
+            detail::code_timer(timed, prefix, [subordinate, &painter, &r]()
             {
                 subordinate->draw(painter, r);
             });
@@ -1451,7 +1875,7 @@ void Widget::draw_subordinate(Painter& painter, const Rect& crect, Widget* subor
                     painter.clip();
                 }
 
-                detail::code_timer(time_subordinate_draw_enabled(), subordinate->name() + " draw: ", [subordinate, &painter, &r]()
+                detail::code_timer(timed, prefix, [subordinate, &painter, &r]()
                 {
                     subordinate->draw(painter, r);
                 });
@@ -1482,25 +1906,26 @@ void Widget::remove_component(Widget* widget)
     if (!widget)
         return;
 
-    auto i = std::find_if(components().begin(), components().end(),
+    auto i = std::find_if(std::next(m_subordinates.begin(), m_components_begin),
+                          m_subordinates.end(),
                           [widget](const auto & ptr)
     {
         return ptr.get() == widget;
     });
-    if (i != components().end())
+    if (i != m_subordinates.end())
     {
         // note order here - damage and then unset parent
         (*i)->damage();
         (*i)->m_parent = nullptr;
         (*i)->component(false);
-        if (i == m_components_begin)
-            m_components_begin = std::next(m_components_begin);
+        (*i)->reset_color_cache();
         m_subordinates.erase(i);
         update_subordinates_ranges();
     }
     else if (widget->m_parent == this)
     {
         widget->m_parent = nullptr;
+        widget->reset_color_cache();
     }
 }
 
@@ -1511,17 +1936,12 @@ void Widget::add_component(Widget& widget)
     // will not delete it.
     auto w = std::shared_ptr<Widget>(&widget, [](Widget*) {});
 
-    bool first_component = components().empty();
-
     w->set_parent(this);
     w->component(true);
     m_subordinates.emplace_back(w);
-
-    if (first_component)
-        m_components_begin = std::prev(m_subordinates.end());
     update_subordinates_ranges();
 
-    layout();
+    request_layout();
 }
 
 void Widget::component(bool value)
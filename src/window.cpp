@@ -39,7 +39,7 @@ Window::Window(const Rect& rect,
 // by default, windows are hidden
     : Frame(rect, {Widget::Flag::window, Widget::Flag::invisible})
 {
-    name("Window" + std::to_string(m_widgetid));
+    name_prefix("Window");
 
     // windows are not transparent by default
     fill_flags(Theme::FillFlag::solid);
@@ -235,6 +235,9 @@ void Window::create_impl(const Rect& rect,
                          PixelFormat format_hint,
                          WindowHint hint)
 {
+    // only widgets with a screen, windows, collect damage
+    m_damage.reserve(10);
+
     m_format_hint = format_hint;
     m_hint = hint;
     if (Application::instance().is_composer())
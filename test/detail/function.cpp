@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <array>
+#include <egt/detail/function.h>
+#include <functional>
+#include <gtest/gtest.h>
+#include <memory>
+
+using Function = egt::detail::InplaceFunction<int(int)>;
+
+static int twice(int value)
+{
+    return value * 2;
+}
+
+TEST(InplaceFunction, Empty)
+{
+    Function f;
+    EXPECT_FALSE(f);
+    EXPECT_THROW(f(1), std::bad_function_call);
+
+    Function null(nullptr);
+    EXPECT_FALSE(null);
+
+    int (*pointer)(int) = nullptr;
+    EXPECT_FALSE(Function(pointer));
+
+    std::function<int(int)> function;
+    EXPECT_FALSE(Function(function));
+}
+
+TEST(InplaceFunction, Call)
+{
+    EXPECT_EQ(Function(twice)(21), 42);
+
+    const int offset = 2;
+    EXPECT_EQ(Function([offset](int value) { return value + offset; })(40), 42);
+
+    EXPECT_EQ(Function(std::function<int(int)>(twice))(21), 42);
+}
+
+TEST(InplaceFunction, DiscardResult)
+{
+    // like std::function, a void function ignores the result of the callable
+    int calls = 0;
+    egt::detail::InplaceFunction<void(int)> f([&calls](int value)
+    {
+        calls += value;
+        return 0;
+    });
+    f(2);
+    f(3);
+    EXPECT_EQ(calls, 5);
+
+    egt::detail::InplaceFunction<void(int)> g(twice);
+    g(1);
+}
+
+TEST(InplaceFunction, Heap)
+{
+    // too large to be stored inline
+    std::array<int, 64> values{};
+    values[10] = 42;
+    Function f([values](int index) { return values[index]; });
+    EXPECT_EQ(f(10), 42);
+
+    auto copy = f;
+    EXPECT_EQ(copy(10), 42);
+
+    auto moved = std::move(f);
+    EXPECT_EQ(moved(10), 42);
+    EXPECT_FALSE(f); // NOLINT(bugprone-use-after-move)
+}
+
+TEST(InplaceFunction, Lifetime)
+{
+    auto counter = std::make_shared<int>(0);
+    {
+        Function f([counter](int value) { return *counter + value; });
+        EXPECT_EQ(counter.use_count(), 2);
+
+        Function copy(f);
+        EXPECT_EQ(counter.use_count(), 3);
+
+        Function moved(std::move(copy));
+        EXPECT_EQ(counter.use_count(), 3);
+
+        moved = nullptr;
+        EXPECT_EQ(counter.use_count(), 2);
+
+        f = Function(twice);
+        EXPECT_EQ(counter.use_count(), 1);
+        EXPECT_EQ(f(2), 4);
+    }
+    EXPECT_EQ(counter.use_count(), 1);
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <cstring>
+#include <egt/detail/image.h>
+#include <egt/detail/imagecache.h>
+#include <egt/ui>
+#include <gtest/gtest.h>
+#include <vector>
+
+static egt::Surface pattern(const egt::Size& size)
+{
+    egt::Surface surface(size);
+    surface.sync_for_cpu();
+    for (auto y = 0; y < size.height(); y++)
+    {
+        auto row = reinterpret_cast<uint32_t*>(static_cast<unsigned char*>(surface.data()) +
+                                               y * surface.stride());
+        for (auto x = 0; x < size.width(); x++)
+        {
+            // runs of the same color, and colors exact in RGB565
+            const uint32_t value = (x / 5 + y) % 8;
+            row[x] = 0xff000000 | (value << 21) | (value << 13) | (value << 5);
+        }
+    }
+    surface.mark_dirty();
+    return surface;
+}
+
+static bool same_pixels(const egt::Surface& a, const egt::Surface& b)
+{
+    if (a.size() != b.size() || a.format() != b.format())
+        return false;
+
+    a.sync_for_cpu();
+    b.sync_for_cpu();
+    const auto bytes = egt::Surface::stride(a.format(), a.width());
+    for (auto y = 0; y < a.height(); y++)
+    {
+        if (memcmp(static_cast<const unsigned char*>(a.data()) + y * a.stride(),
+                   static_cast<const unsigned char*>(b.data()) + y * b.stride(),
+                   bytes))
+            return false;
+    }
+    return true;
+}
+
+TEST(TiledImage, PartialDecode)
+{
+    egt::Application app;
+
+    const auto source = pattern(egt::Size(150, 90));
+    const auto path = testing::TempDir() + "tiled.eraw";
+    egt::detail::TiledImage::save(path, source);
+
+    egt::detail::TiledImage image("file:" + path);
+    EXPECT_TRUE(image.partial());
+    EXPECT_EQ(image.size(), source.size());
+
+    // 3 x 2 tiles of 64 x 64, clipped on the right and the bottom
+    EXPECT_EQ(image.decode(egt::Rect(0, 0, 10, 10)), 1U);
+    EXPECT_EQ(image.decode(egt::Rect(0, 0, 10, 10)), 0U);
+    EXPECT_FALSE(same_pixels(*image.surface(), source));
+    EXPECT_EQ(image.decode(egt::Rect(60, 60, 10, 10)), 3U);
+    EXPECT_EQ(image.decode(egt::Rect(-10, -10, 500, 500)), 2U);
+    EXPECT_TRUE(same_pixels(*image.surface(), source));
+
+    // the usual loading path decodes all of it
+    EXPECT_TRUE(same_pixels(egt::detail::load_image_from_filesystem(path), source));
+}
+
+TEST(TiledImage, Formats)
+{
+    egt::Application app;
+
+    const auto source = pattern(egt::Size(100, 70));
+    const auto path = testing::TempDir() + "tiled.eraw";
+
+    egt::detail::TiledImage::save(path, source, egt::PixelFormat::argb8888,
+                                  egt::detail::TiledImage::Compression::zlib, 32);
+    EXPECT_TRUE(same_pixels(egt::detail::load_image_from_filesystem(path), source));
+
+    egt::detail::TiledImage::save(path, source, egt::PixelFormat::rgb565);
+    auto image = egt::detail::load_image_from_filesystem(path);
+    EXPECT_EQ(image.format(), egt::PixelFormat::rgb565);
+    EXPECT_EQ(image.size(), source.size());
+    image.sync_for_cpu();
+    for (const auto& point : {egt::Point(0, 0), egt::Point(12, 3), egt::Point(99, 69)})
+    {
+        const auto pixel = reinterpret_cast<const uint16_t*>(
+                               static_cast<const unsigned char*>(image.data()) +
+                               point.y() * image.stride())[point.x()];
+        EXPECT_EQ(pixel, source.color_at(point).pixel16());
+    }
+
+    EXPECT_THROW(egt::detail::TiledImage::save(path, image), std::runtime_error);
+}
+
+TEST(TiledImage, CraftedHeader)
+{
+    egt::Application app;
+
+    const auto header = [](uint32_t width, uint32_t height, uint32_t tile_size)
+    {
+        // magic, size, tile size, flags, origin, and room for a few entries
+        const uint32_t values[8] = {0x50502AA3, width, height, tile_size, 0, 0, 0, 0};
+        std::vector<unsigned char> buf(sizeof(values) + 4 * 12);
+        memcpy(buf.data(), values, sizeof(values));
+        return buf;
+    };
+
+    // the number of tiles, or the number of tiles along a dimension, would
+    // wrap around in 32 bits and pass for a small image
+    for (const auto& buf : {header(65536, 65536, 1),
+                            header(0xfffffff0, 10, 0x20),
+                            header(0x80000000, 1, 0x80000000)
+                           })
+    {
+        EXPECT_TRUE(egt::detail::load_image_from_memory(buf.data(), buf.size()).empty());
+    }
+}
+
+class TestImageCache : public egt::detail::ImageCache
+{
+public:
+    using ImageCache::m_sources;
+};
+
+TEST(ImageCache, SourceBudget)
+{
+    egt::Application app;
+
+    const auto path = testing::TempDir() + "cache.png";
+    pattern(egt::Size(256, 128)).write_to_png(path);
+    const auto uri = "file:" + path;
+
+    TestImageCache cache;
+    auto image = cache.get(uri, 0.3, 0.3, true);
+    EXPECT_EQ(image->size(), egt::Size(77, 39));
+    EXPECT_EQ(cache.m_sources.size(), 1U);
+
+    // the source is used again for smaller sizes
+    EXPECT_EQ(cache.get(uri, 0.1, 0.1, true)->size(), egt::Size(26, 13));
+    EXPECT_EQ(cache.m_sources.size(), 1U);
+
+    // a source over the budget is not kept, even the last one used
+    cache.source_budget(1);
+    EXPECT_TRUE(cache.m_sources.empty());
+    EXPECT_EQ(cache.get(uri, 0.3, 0.3, true)->size(), egt::Size(77, 39));
+    EXPECT_TRUE(cache.m_sources.empty());
+}
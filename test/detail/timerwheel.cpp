@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <chrono>
+#include <egt/detail/timerwheel.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using egt::detail::TimerWheel;
+using std::chrono::milliseconds;
+
+/// Run the io_context until the wheel has no timers left.
+static void run(egt::asio::io_context& io, TimerWheel& wheel)
+{
+    // the io_context stops whenever it runs out of work
+    io.restart();
+    const auto timeout = TimerWheel::Clock::now() + std::chrono::seconds(10);
+    while (wheel.size() && TimerWheel::Clock::now() < timeout)
+        io.run_one_for(milliseconds(100));
+    ASSERT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheel, Order)
+{
+    egt::asio::io_context io;
+    TimerWheel wheel(io, milliseconds(1));
+
+    std::vector<int> order;
+    TimerWheel::Entry entries[3];
+    const milliseconds durations[3] = {milliseconds(30), milliseconds(10), milliseconds(20)};
+    const auto start = TimerWheel::Clock::now();
+    for (auto i = 0; i < 3; i++)
+    {
+        entries[i].callback = [&order, &start, i, durations]()
+        {
+            // never early
+            EXPECT_GE(TimerWheel::Clock::now() - start, durations[i]);
+            order.push_back(i);
+        };
+        wheel.schedule(entries[i], durations[i]);
+    }
+    EXPECT_EQ(wheel.size(), 3u);
+
+    run(io, wheel);
+    EXPECT_EQ(order, std::vector<int>({1, 2, 0}));
+}
+
+TEST(TimerWheel, RescheduleFromCallback)
+{
+    egt::asio::io_context io;
+    TimerWheel wheel(io, milliseconds(1));
+
+    auto calls = 0;
+    TimerWheel::Entry entry;
+    entry.callback = [&]()
+    {
+        EXPECT_FALSE(entry.scheduled());
+        if (++calls < 5)
+            wheel.schedule(entry, milliseconds(2));
+    };
+    wheel.schedule(entry, milliseconds(2));
+
+    run(io, wheel);
+    EXPECT_EQ(calls, 5);
+}
+
+TEST(TimerWheel, CancelExpired)
+{
+    egt::asio::io_context io;
+    // long ticks, so that both timers expire in the same one
+    TimerWheel wheel(io, milliseconds(200));
+
+    auto first = 0;
+    auto second = 0;
+    TimerWheel::Entry entries[2];
+    entries[0].callback = [&]()
+    {
+        first++;
+        // the second timer has expired too, but has not run yet
+        entries[1].cancel();
+    };
+    entries[1].callback = [&]()
+    {
+        second++;
+    };
+    wheel.schedule(entries[0], milliseconds(0));
+    wheel.schedule(entries[1], milliseconds(0));
+
+    run(io, wheel);
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(second, 0);
+    EXPECT_FALSE(entries[1].scheduled());
+}
+
+TEST(TimerWheel, SecondLevel)
+{
+    egt::asio::io_context io;
+    TimerWheel wheel(io, milliseconds(1));
+
+    // a block of the first level is 64 ticks, so these cascade from the second
+    std::vector<int> order;
+    TimerWheel::Entry entries[3];
+    const milliseconds durations[3] = {milliseconds(1200), milliseconds(600), milliseconds(5)};
+    const auto start = TimerWheel::Clock::now();
+    for (auto i = 0; i < 3; i++)
+    {
+        entries[i].callback = [&order, &start, i, durations]()
+        {
+            EXPECT_GE(TimerWheel::Clock::now() - start, durations[i]);
+            order.push_back(i);
+        };
+        wheel.schedule(entries[i], durations[i]);
+    }
+
+    // cancelled timers of the second level are forgotten
+    TimerWheel::Entry cancelled;
+    cancelled.callback = []()
+    {
+        FAIL();
+    };
+    wheel.schedule(cancelled, milliseconds(550));
+    cancelled.cancel();
+
+    run(io, wheel);
+    EXPECT_EQ(order, std::vector<int>({2, 1, 0}));
+}
+
+TEST(TimerWheel, Stall)
+{
+    egt::asio::io_context io;
+    TimerWheel wheel(io, milliseconds(1));
+
+    std::vector<int> order;
+    TimerWheel::Entry entries[4];
+    const milliseconds durations[4] = {milliseconds(900), milliseconds(5), milliseconds(700), milliseconds(300)};
+    for (auto i = 0; i < 4; i++)
+    {
+        entries[i].callback = [&order, i]()
+        {
+            order.push_back(i);
+        };
+        wheel.schedule(entries[i], durations[i]);
+    }
+
+    // the event loop does not run for many blocks of the wheel
+    std::this_thread::sleep_for(milliseconds(1000));
+
+    // all the timers run late, in the order of their deadlines
+    const auto start = TimerWheel::Clock::now();
+    run(io, wheel);
+    EXPECT_LT(TimerWheel::Clock::now() - start, milliseconds(100));
+    EXPECT_EQ(order, std::vector<int>({1, 3, 2, 0}));
+
+    // and the wheel still works after that
+    auto calls = 0;
+    TimerWheel::Entry entry;
+    entry.callback = [&calls]()
+    {
+        calls++;
+    };
+    wheel.schedule(entry, milliseconds(2));
+    run(io, wheel);
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(TimerWheel, BeyondSecondLevel)
+{
+    egt::asio::io_context io;
+    TimerWheel wheel(io, milliseconds(1));
+
+    // the second level reaches 64 blocks of 64 ticks, so these wait in its
+    // last slot until it cascades
+    std::vector<int> order;
+    TimerWheel::Entry entries[4];
+    const milliseconds durations[4] = {milliseconds(4300), milliseconds(4150),
+                                       milliseconds(3000), milliseconds(10)
+                                      };
+    const auto start = TimerWheel::Clock::now();
+    for (auto i = 0; i < 4; i++)
+    {
+        entries[i].callback = [&order, &start, i, durations]()
+        {
+            EXPECT_GE(TimerWheel::Clock::now() - start, durations[i]);
+            EXPECT_LT(TimerWheel::Clock::now() - start, durations[i] + milliseconds(100));
+            order.push_back(i);
+        };
+        wheel.schedule(entries[i], durations[i]);
+    }
+
+    TimerWheel::Entry cancelled;
+    cancelled.callback = []()
+    {
+        FAIL();
+    };
+    wheel.schedule(cancelled, milliseconds(4200));
+    EXPECT_EQ(wheel.size(), 5u);
+    cancelled.cancel();
+    EXPECT_EQ(wheel.size(), 4u);
+
+    run(io, wheel);
+    EXPECT_EQ(order, std::vector<int>({3, 2, 1, 0}));
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <egt/ui>
+#include <gtest/gtest.h>
+#include <memory>
+
+TEST(AutoAnimation, ForgetTarget)
+{
+    egt::Application app;
+
+    egt::PropertyAnimator a;
+    egt::PropertyAnimator b;
+    egt::PropertyAnimator c;
+    egt::Label other("other");
+    {
+        egt::Label label("label");
+        a.target(&label);
+        b.target(&label);
+        c.target(&other);
+        EXPECT_EQ(a.target(), &label);
+    }
+
+    // the destroyed widget is no longer the target of any animation
+    EXPECT_EQ(a.target(), nullptr);
+    EXPECT_EQ(b.target(), nullptr);
+    EXPECT_EQ(c.target(), &other);
+}
+
+TEST(AutoAnimation, Clock)
+{
+    egt::Application app;
+
+    egt::PropertyAnimator animation(0, 100, std::chrono::milliseconds(50));
+    egt::PropertyAnimator::Value last = 0;
+    animation.on_change([&last](egt::PropertyAnimator::Value value) { last = value; });
+
+    animation.start();
+    EXPECT_TRUE(animation.running());
+
+    egt::PeriodicTimer timeout(std::chrono::milliseconds(10));
+    timeout.on_timeout([&]()
+    {
+        if (!animation.running())
+            app.event().quit();
+    });
+    timeout.start();
+    app.run();
+
+    EXPECT_FALSE(animation.running());
+    EXPECT_EQ(last, 100);
+
+    // the clock starts again after it went idle
+    animation.start();
+    EXPECT_TRUE(animation.running());
+    app.run();
+    EXPECT_EQ(last, 100);
+}
+
+TEST(AutoAnimation, PauseHiddenTarget)
+{
+    egt::Application app;
+
+    egt::Label label("label");
+    egt::PropertyAnimator animation(0, 100, std::chrono::milliseconds(100));
+    animation.on_change([&label](egt::PropertyAnimator::Value value) { label.x(value); });
+
+    // the widget the animation moves becomes its target
+    animation.start();
+    EXPECT_EQ(animation.target(), nullptr);
+
+    egt::PropertyAnimator::Value hidden_at = -1;
+    auto ticks = 0;
+    egt::PeriodicTimer timeout(std::chrono::milliseconds(10));
+    timeout.on_timeout([&]()
+    {
+        if (hidden_at < 0)
+        {
+            if (animation.target() == &label)
+            {
+                label.hide();
+                hidden_at = label.x();
+            }
+        }
+        else if (!label.visible())
+        {
+            // no time passes for the animation while its target is hidden
+            EXPECT_EQ(label.x(), hidden_at);
+            if (++ticks == 20)
+                label.show();
+        }
+        else if (!animation.running())
+        {
+            app.event().quit();
+        }
+    });
+    timeout.start();
+    app.run();
+
+    EXPECT_EQ(animation.target(), &label);
+    EXPECT_EQ(label.x(), 100);
+}
@@ -5,6 +5,8 @@
  */
 #include <egt/ui>
 #include <gtest/gtest.h>
+#include <memory>
+#include <vector>
 
 using ::testing::Combine;
 using ::testing::TestWithParam;
@@ -64,3 +66,291 @@ TEST_P(FrameTest, TestWidget)
 }
 
 INSTANTIATE_TEST_SUITE_P(FrameTestGroup, FrameTest, testing::Values(1, 2, 4));
+
+TEST(FrameHitTest, ManyChildren)
+{
+    egt::Application app;
+    egt::TopWindow win;
+    egt::Frame frame(egt::Rect(0, 0, 800, 480));
+    win.add(frame);
+
+    // enough children for the frame to index them
+    std::vector<std::shared_ptr<egt::Frame>> markers;
+    for (auto y = 0; y < 10; y++)
+    {
+        for (auto x = 0; x < 20; x++)
+        {
+            auto marker = std::make_shared<egt::Frame>(egt::Rect(x * 40, y * 48, 40, 48));
+            frame.add(marker);
+            markers.push_back(marker);
+        }
+    }
+    app.layout_now();
+
+    EXPECT_EQ(frame.hit_test(egt::DisplayPoint(0, 0)), markers[0].get());
+    EXPECT_EQ(frame.hit_test(egt::DisplayPoint(45, 50)), markers[21].get());
+    EXPECT_EQ(frame.hit_test(egt::DisplayPoint(799, 479)), markers[199].get());
+
+    // a moved child is found at its new position, on top of the others
+    markers[0]->move(egt::Point(400, 240));
+    EXPECT_EQ(frame.hit_test(egt::DisplayPoint(0, 0)), &frame);
+    EXPECT_EQ(frame.hit_test(egt::DisplayPoint(405, 245)), markers[110].get());
+    markers[0]->zorder_top();
+    EXPECT_EQ(frame.hit_test(egt::DisplayPoint(405, 245)), markers[0].get());
+
+    frame.remove(markers[0].get());
+    EXPECT_EQ(frame.hit_test(egt::DisplayPoint(405, 245)), markers[110].get());
+}
+
+TEST(FrameZorder, Ops)
+{
+    egt::Application app;
+    egt::TopWindow win;
+    egt::Frame frame(egt::Rect(0, 0, 800, 480));
+    win.add(frame);
+
+    std::vector<std::shared_ptr<egt::Frame>> children;
+    for (auto i = 0; i < 4; i++)
+    {
+        children.push_back(std::make_shared<egt::Frame>(egt::Rect(0, 0, 10, 10)));
+        frame.add(children.back());
+    }
+
+    const auto order = [&frame]()
+    {
+        std::vector<size_t> ranks;
+        for (size_t i = 0; i < frame.count_children(); i++)
+            ranks.push_back(frame.zorder(frame.child_at(i).get()));
+        return ranks;
+    };
+
+    children[0]->zorder_top();
+    EXPECT_EQ(frame.child_at(3), children[0]);
+    children[0]->zorder_bottom();
+    EXPECT_EQ(frame.child_at(0), children[0]);
+    children[1]->zorder_up();
+    EXPECT_EQ(frame.child_at(2), children[1]);
+    children[1]->zorder_down();
+    EXPECT_EQ(frame.child_at(1), children[1]);
+
+    children[3]->zorder(1);
+    EXPECT_EQ(frame.child_at(1), children[3]);
+    EXPECT_EQ(frame.child_at(2), children[1]);
+    EXPECT_EQ(order(), std::vector<size_t>({0, 1, 2, 3}));
+
+    auto extra = std::make_shared<egt::Frame>(egt::Rect(0, 0, 10, 10));
+    frame.add_at(extra, 2);
+    EXPECT_EQ(frame.child_at(2), extra);
+    EXPECT_EQ(frame.count_children(), 5u);
+
+    frame.remove_at(2);
+    frame.remove(children[0].get());
+    EXPECT_EQ(frame.count_children(), 3u);
+    EXPECT_EQ(frame.child_at(0), children[3]);
+}
+
+TEST(FramePalette, ColorCache)
+{
+    egt::Application app;
+    egt::Frame parent;
+    auto child = std::make_shared<egt::Frame>();
+    parent.add(child);
+
+    const auto bg = child->color(egt::Palette::ColorId::bg);
+    EXPECT_EQ(child->color(egt::Palette::ColorId::bg), bg);
+
+    parent.color(egt::Palette::ColorId::bg, egt::Palette::red);
+    EXPECT_EQ(child->color(egt::Palette::ColorId::bg), egt::Pattern(egt::Palette::red));
+
+    // colors resolved in another group do not replace the ones returned before
+    parent.color(egt::Palette::ColorId::bg, egt::Palette::blue, egt::Palette::GroupId::active);
+    const auto& normal = child->color(egt::Palette::ColorId::bg, egt::Palette::GroupId::normal);
+    const auto& active = child->color(egt::Palette::ColorId::bg, egt::Palette::GroupId::active);
+    EXPECT_EQ(normal, egt::Pattern(egt::Palette::red));
+    EXPECT_EQ(active, egt::Pattern(egt::Palette::blue));
+
+    parent.remove(child.get());
+    EXPECT_EQ(child->color(egt::Palette::ColorId::bg), bg);
+}
+
+TEST(FrameHandle, PointerTarget)
+{
+    egt::Application app;
+    egt::Frame frame(egt::Rect(0, 0, 200, 100));
+    auto bottom = std::make_shared<egt::Frame>(egt::Rect(0, 0, 50, 50));
+    auto top = std::make_shared<egt::Frame>(egt::Rect(25, 25, 50, 50));
+    auto alone = std::make_shared<egt::Frame>(egt::Rect(100, 0, 20, 20));
+    frame.add(bottom);
+    frame.add(top);
+    frame.add(alone);
+
+    egt::Widget* target = nullptr;
+    for (auto& child : {bottom, top, alone})
+    {
+        child->on_event([&target, child](egt::Event&)
+        {
+            target = child.get();
+        }, {egt::EventId::raw_pointer_move});
+    }
+
+    const auto move = [&frame, &target](int x, int y)
+    {
+        target = nullptr;
+        egt::Event event(egt::EventId::raw_pointer_move,
+                         egt::Pointer(egt::DisplayPoint(x, y)));
+        frame.handle(event);
+        return target;
+    };
+
+    EXPECT_EQ(move(10, 10), bottom.get());
+    EXPECT_EQ(move(30, 30), top.get());
+    EXPECT_EQ(move(31, 31), top.get());
+    EXPECT_EQ(move(105, 5), alone.get());
+    EXPECT_EQ(move(106, 6), alone.get());
+
+    top->hide();
+    EXPECT_EQ(move(30, 30), bottom.get());
+    top->show();
+    EXPECT_EQ(move(30, 30), top.get());
+
+    alone->move(egt::Point(150, 0));
+    EXPECT_EQ(move(106, 6), nullptr);
+    EXPECT_EQ(move(155, 5), alone.get());
+    alone->hide();
+    EXPECT_EQ(move(155, 5), nullptr);
+}
+
+TEST(FrameHandle, PointerTargetMoving)
+{
+    egt::Application app;
+    egt::Frame frame(egt::Rect(0, 0, 200, 100));
+    auto dragged = std::make_shared<egt::Frame>(egt::Rect(0, 0, 20, 20));
+    auto cover = std::make_shared<egt::Frame>(egt::Rect(150, 50, 20, 20));
+    frame.add(dragged);
+    frame.add(cover);
+
+    egt::Widget* target = nullptr;
+    for (auto& child : {dragged, cover})
+    {
+        child->on_event([&target, child](egt::Event&)
+        {
+            target = child.get();
+        }, {egt::EventId::raw_pointer_move});
+    }
+
+    const auto move = [&frame, &target](int x, int y)
+    {
+        target = nullptr;
+        egt::Event event(egt::EventId::raw_pointer_move,
+                         egt::Pointer(egt::DisplayPoint(x, y)));
+        frame.handle(event);
+        return target;
+    };
+
+    // the target follows the pointer, as when dragged
+    for (auto x = 10; x < 100; x += 10)
+    {
+        dragged->move(egt::Point(x - 10, 0));
+        EXPECT_EQ(move(x, 10), dragged.get());
+    }
+
+    // and is no longer the target where it goes under another child
+    dragged->move(egt::Point(145, 45));
+    EXPECT_EQ(move(155, 55), cover.get());
+    EXPECT_EQ(move(146, 46), dragged.get());
+
+    // nor where another child comes over it
+    dragged->move(egt::Point(0, 0));
+    EXPECT_EQ(move(10, 10), dragged.get());
+    cover->move(egt::Point(5, 5));
+    EXPECT_EQ(move(10, 10), cover.get());
+    cover->move(egt::Point(150, 50));
+    EXPECT_EQ(move(10, 10), dragged.get());
+}
+
+TEST(FrameZorder, WalkWhileAdding)
+{
+    egt::Application app;
+    egt::TopWindow win;
+    egt::Frame frame(egt::Rect(0, 0, 800, 480));
+    win.add(frame);
+
+    for (auto i = 0; i < 4; i++)
+        frame.add(std::make_shared<egt::Frame>(egt::Rect(0, 0, 10, 10)));
+
+    // adding children reallocates the subordinates while they are walked
+    auto visited = 0;
+    frame.walk([&frame, &visited](egt::Widget * widget, int level)
+    {
+        if (level == 1)
+        {
+            visited++;
+            if (frame.count_children() < 64)
+            {
+                for (auto i = 0; i < 16; i++)
+                    frame.add(std::make_shared<egt::Frame>(egt::Rect(0, 0, 10, 10)));
+            }
+        }
+        return widget == &frame || level == 0;
+    });
+
+    EXPECT_EQ(frame.count_children(), 68u);
+    EXPECT_EQ(visited, 68);
+}
+
+TEST(FrameZorder, ChildrenWhileChanging)
+{
+    egt::Frame frame;
+    std::vector<std::shared_ptr<egt::Frame>> children;
+    for (auto i = 0; i < 4; i++)
+    {
+        children.push_back(std::make_shared<egt::Frame>());
+        frame.add(children.back());
+    }
+
+    // iterators of children() survive the subordinates being reallocated
+    auto visited = 0;
+    for (auto& child : frame.children())
+    {
+        EXPECT_TRUE(child);
+        if (visited++ == 0)
+        {
+            for (auto i = 0; i < 16; i++)
+                frame.add(std::make_shared<egt::Frame>());
+        }
+    }
+    EXPECT_EQ(visited, 4);
+
+    // and a loop stops at the current end when children are removed
+    visited = 0;
+    for (auto& child : frame.children())
+    {
+        EXPECT_TRUE(child);
+        visited++;
+        frame.remove(frame.child_at(frame.count_children() - 1).get());
+        frame.remove(frame.child_at(frame.count_children() - 1).get());
+    }
+    EXPECT_EQ(visited, 7);
+    EXPECT_EQ(frame.count_children(), 6u);
+}
+
+TEST(FramePalette, ColorCacheReparent)
+{
+    egt::Frame parent;
+    parent.color(egt::Palette::ColorId::bg, egt::Palette::red);
+    auto child = std::make_shared<egt::Frame>();
+    auto grandchild = std::make_shared<egt::Frame>();
+    child->add(grandchild);
+    const auto bg = grandchild->color(egt::Palette::ColorId::bg);
+
+    // moving widgets only drops the colors cached in the moved subtree
+    const auto generation = egt::detail::palette_generation();
+
+    parent.add(child);
+    EXPECT_EQ(grandchild->color(egt::Palette::ColorId::bg), egt::Pattern(egt::Palette::red));
+
+    parent.remove(child.get());
+    EXPECT_EQ(grandchild->color(egt::Palette::ColorId::bg), bg);
+
+    EXPECT_EQ(egt::detail::palette_generation(), generation);
+}
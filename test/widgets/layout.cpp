@@ -27,6 +27,8 @@ TEST_F(Layout, VerticalSizerDefaultPosition)
 
     egt::Button b1(vsizer, "b1", egt::Size(100, 100));
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(0, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(100, 100));
 
@@ -41,6 +43,8 @@ TEST_F(Layout, ExpandedVerticalSizerDefaultPosition)
 
     egt::Button b1(vsizer, "b1", egt::Size(100, 100));
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(150, 150));
     EXPECT_EQ(b1.box().size(), egt::Size(100, 100));
 
@@ -59,6 +63,8 @@ TEST_F(Layout, VerticalSizerAutoGrowth)
     egt::Button b2(vsizer, "b2", egt::Rect(egt::Point(0, 0), egt::Size(400, 200)));
     egt::Button b3(vsizer, "b3", egt::Rect(egt::Point(0, 0), egt::Size(600, 200)));
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(200, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(200, 200));
 
@@ -82,6 +88,8 @@ TEST_F(Layout, VerticalSizerIgnoreUserPosition)
     egt::Button b2(vsizer, "b2", egt::Rect(egt::Point(300, 300), egt::Size(100, 100)));
     egt::Button b3(vsizer, "b3", egt::Rect(egt::Point(100, 100), egt::Size(100, 100)));
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(0, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(100, 100));
 
@@ -110,6 +118,8 @@ TEST_F(Layout, VerticalSizerHorizontalAlignment)
 
     egt::Button b3(vsizer, "b3", egt::Rect(egt::Point(0, 0), egt::Size(300, 100)));
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(0, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(100, 100));
 
@@ -137,6 +147,8 @@ TEST_F(Layout, VerticalSizerVerticalAlignment)
 
     egt::Button b3(vsizer, "b3", egt::Rect(egt::Point(0, 0), egt::Size(100, 100)));
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(0, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(100, 100));
 
@@ -165,6 +177,8 @@ TEST_F(Layout, VerticalSizerExpandedChildren)
     egt::Button b3(vsizer, "b3", egt::Rect(egt::Point(0, 0), egt::Size(100, 100)));
     egt::expand(b3);
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(0, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(100, 0));
 
@@ -194,6 +208,8 @@ TEST_F(Layout, ExpandedVerticalSizerExpandedChildren)
     egt::Button b3(vsizer, "b3", egt::Rect(egt::Point(0, 0), egt::Size(100, 100)));
     egt::expand(b3);
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(0, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(400, 150));
 
@@ -233,6 +249,8 @@ TEST_F(Layout, FlexSizerStepByStep)
     b3.width(300);
     b3.height(80);
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(50, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(100, 80));
 
@@ -270,6 +288,8 @@ TEST_F(Layout, FlexSizerAddOrder)
     b3.height(80);
     fsizer.add(b3);
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(50, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(100, 80));
 
@@ -289,6 +309,8 @@ TEST_F(Layout, FlexSizerConstructor)
     egt::Button b2(fsizer, "b2", egt::Rect(350, 0, 200, 80));
     egt::Button b3(fsizer, "b3", egt::Rect(200, 80, 300, 80));
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(50, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(100, 80));
 
@@ -308,6 +330,8 @@ TEST_F(Layout, FlexSizerDefaultPosition)
     egt::Button b2(fsizer, "b2", egt::Rect(0, 0, 200, 80));
     egt::Button b3(fsizer, "b3", egt::Rect(0, 0, 300, 80));
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(50, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(100, 80));
 
@@ -330,6 +354,8 @@ TEST_F(Layout, FlexSizerEmptyBox)
     egt::Button b4(fsizer, "b4", egt::Rect(0, 0, 100, 80));
     egt::Button b5(fsizer, "b5", egt::Rect(0, 0, 100, 300));
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(0, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(100, 80));
 
@@ -363,6 +389,8 @@ TEST_F(Layout, FlexSizerExpanded)
     egt::Button b4(fsizer, "b4", egt::Rect(0, 0, 100, 80));
     egt::Button b5(fsizer, "b5", egt::Rect(0, 0, 100, 300));
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(50, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(100, 80));
 
@@ -408,6 +436,8 @@ TEST_F(Layout, FlexSizerExpandedAndExpendedChild)
     egt::Button b6(fsizer, "b6");
     egt::expand(b6);
 
+    app.layout_now();
+
     EXPECT_EQ(b1.display_origin(), egt::DisplayPoint(0, 0));
     EXPECT_EQ(b1.box().size(), egt::Size(0, 100));
 
@@ -426,3 +456,22 @@ TEST_F(Layout, FlexSizerExpandedAndExpendedChild)
     EXPECT_EQ(fsizer.display_origin(), egt::DisplayPoint(0, 0));
     EXPECT_EQ(fsizer.box().size(), egt::Size(400, 400));
 }
+
+TEST_F(Layout, DeferredLayout)
+{
+    /// The goal of this test is to check that adding widgets only requests a
+    /// layout of the sizer, performed once by Application::layout_now().
+    egt::BoxSizer vsizer(window, egt::Orientation::vertical);
+
+    egt::Button b1(vsizer, "b1", egt::Size(100, 100));
+    egt::Button b2(vsizer, "b2", egt::Size(100, 100));
+
+    EXPECT_TRUE(vsizer.layout_requested());
+
+    app.layout_now();
+
+    EXPECT_FALSE(vsizer.layout_requested());
+
+    EXPECT_EQ(b2.display_origin(), egt::DisplayPoint(0, 100));
+    EXPECT_EQ(vsizer.box().size(), egt::Size(100, 200));
+}
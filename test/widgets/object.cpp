@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <egt/ui>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+TEST(ObjectHandlers, Buckets)
+{
+    egt::Button button("Button");
+
+    std::vector<int> calls;
+    button.on_event([&calls](egt::Event&) { calls.push_back(1); }, {egt::EventId::pointer_click});
+    button.on_event([&calls](egt::Event&) { calls.push_back(2); });
+    const auto handle = button.on_event([&calls](egt::Event&) { calls.push_back(3); },
+    {egt::EventId::pointer_click, egt::EventId::keyboard_down});
+
+    button.invoke_handlers(egt::EventId::keyboard_down);
+    EXPECT_EQ(calls, std::vector<int>({2, 3}));
+
+    calls.clear();
+    button.invoke_handlers(egt::EventId::pointer_click);
+    EXPECT_EQ(calls, std::vector<int>({1, 2, 3}));
+
+    calls.clear();
+    button.remove_handler(handle);
+    button.invoke_handlers(egt::EventId::pointer_click);
+    EXPECT_EQ(calls, std::vector<int>({1, 2}));
+}
+
+TEST(ObjectHandlers, RemoveWhileInvoking)
+{
+    egt::Button button("Button");
+
+    std::vector<int> calls;
+    egt::Object::RegisterHandle last = 0;
+    button.on_event([&](egt::Event&)
+    {
+        calls.push_back(1);
+        button.remove_handler(last);
+    });
+    button.on_event([&calls](egt::Event&) { calls.push_back(2); });
+    last = button.on_event([&calls](egt::Event&) { calls.push_back(3); });
+
+    button.invoke_handlers(egt::EventId::pointer_click);
+    EXPECT_EQ(calls, std::vector<int>({1, 2}));
+}
+
+TEST(ObjectHandlers, RemoveSelfWhileInvoking)
+{
+    egt::Button button("Button");
+
+    std::vector<int> calls;
+    egt::Object::RegisterHandle self = 0;
+    // destroyed if the callback is erased while it runs
+    const std::string tag(40, 'x');
+    self = button.on_event([&, tag](egt::Event&)
+    {
+        button.remove_handler(self);
+        calls.push_back(static_cast<int>(tag.size()));
+    });
+    button.on_event([&calls](egt::Event&) { calls.push_back(2); });
+
+    button.invoke_handlers(egt::EventId::pointer_click);
+    EXPECT_EQ(calls, std::vector<int>({40, 2}));
+
+    calls.clear();
+    button.invoke_handlers(egt::EventId::pointer_click);
+    EXPECT_EQ(calls, std::vector<int>({2}));
+}
+
+TEST(ObjectHandlers, AddWhileInvoking)
+{
+    egt::Button button("Button");
+
+    std::vector<int> calls;
+    button.on_event([&](egt::Event&)
+    {
+        calls.push_back(1);
+        // enough to make the callbacks grow
+        for (auto i = 0; i < 8; ++i)
+            button.on_event([&calls](egt::Event&) { calls.push_back(3); },
+        {egt::EventId::keyboard_down});
+        calls.push_back(1);
+    }, {egt::EventId::pointer_click});
+    button.on_event([&calls](egt::Event&) { calls.push_back(2); });
+
+    button.invoke_handlers(egt::EventId::pointer_click);
+    EXPECT_EQ(calls, std::vector<int>({1, 1, 2}));
+
+    calls.clear();
+    button.invoke_handlers(egt::EventId::keyboard_down);
+    EXPECT_EQ(calls, std::vector<int>({2, 3, 3, 3, 3, 3, 3, 3, 3}));
+}
+
+TEST(ObjectHandlers, ClearWhileInvoking)
+{
+    egt::Button button("Button");
+
+    std::vector<int> calls;
+    button.on_event([&](egt::Event&)
+    {
+        calls.push_back(1);
+        button.clear_handlers();
+        button.on_event([&calls](egt::Event&) { calls.push_back(3); });
+    });
+    button.on_event([&calls](egt::Event&) { calls.push_back(2); });
+
+    button.invoke_handlers(egt::EventId::pointer_click);
+    EXPECT_EQ(calls, std::vector<int>({1}));
+
+    calls.clear();
+    button.invoke_handlers(egt::EventId::pointer_click);
+    EXPECT_EQ(calls, std::vector<int>({3}));
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <egt/ui>
+#include <gtest/gtest.h>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using ::testing::TestWithParam;
+using ::testing::Values;
+
+class TestTextBox : public egt::TextBox
+{
+public:
+    using egt::TextBox::TextBox;
+
+    /// Laid out lines, as their text and rectangle.
+    std::vector<std::tuple<std::string, egt::Rect>> lines() const
+    {
+        std::vector<std::tuple<std::string, egt::Rect>> result;
+        for (const auto& r : m_rects)
+        {
+            if (result.empty() || std::get<1>(result.back()).y() != r.rect().y())
+            {
+                result.emplace_back(r.text(), r.rect());
+                continue;
+            }
+
+            std::get<0>(result.back()) += r.text();
+            auto& rect = std::get<1>(result.back());
+            rect.width(r.rect().right() - rect.x());
+        }
+        return result;
+    }
+};
+
+class TextBoxTest : public testing::TestWithParam<int> {};
+
+/*
+ * Editing the text only lays out again part of it: the result must be the
+ * same as laying out the whole text.
+ */
+TEST_P(TextBoxTest, IncrementalLayout)
+{
+    egt::Application app;
+
+    const auto flags = static_cast<egt::TextBox::TextFlag>(GetParam());
+    const egt::TextBox::TextFlags text_flags{egt::TextBox::TextFlag::multiline, flags};
+    const egt::Rect rect(0, 0, 200, 400);
+
+    std::string text;
+    for (auto i = 0; i < 50; i++)
+        text += "line " + std::to_string(i) + " with some words to wrap\n";
+
+    TestTextBox textbox(text, rect, egt::TextBox::default_text_align(), text_flags);
+
+    const std::vector<std::tuple<size_t, std::string>> inserts =
+    {
+        {0, "start "},
+        {300, "a few words in the middle"},
+        {301, "\n"},
+        {600, "\n\n"},
+        {1000, "endless"},
+    };
+
+    for (const auto& insert : inserts)
+    {
+        textbox.cursor_set(std::get<0>(insert));
+        textbox.insert(std::get<1>(insert));
+
+        TestTextBox expected(textbox.text(), rect, egt::TextBox::default_text_align(), text_flags);
+        EXPECT_EQ(textbox.lines(), expected.lines());
+    }
+
+    const std::vector<std::tuple<size_t, size_t>> deletes =
+    {
+        {0, 6},
+        {299, 3},
+        {400, 60},
+        {text.size() - 10, 10},
+    };
+
+    for (const auto& del : deletes)
+    {
+        textbox.selection(std::get<0>(del), std::get<1>(del));
+        textbox.selection_delete();
+
+        TestTextBox expected(textbox.text(), rect, egt::TextBox::default_text_align(), text_flags);
+        EXPECT_EQ(textbox.lines(), expected.lines());
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(TextBoxTestGroup, TextBoxTest,
+                         Values(static_cast<int>(egt::TextBox::TextFlag::multiline),
+                                static_cast<int>(egt::TextBox::TextFlag::word_wrap)));
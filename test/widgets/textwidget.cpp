@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <egt/ui>
+#include <gtest/gtest.h>
+
+TEST(TextSizeCache, Button)
+{
+    egt::Application app;
+
+    EXPECT_EQ(egt::Font(20).id(), egt::Font(20).id());
+    EXPECT_NE(egt::Font(20).id(), egt::Font(21).id());
+    EXPECT_NE(egt::Font(20).id(), egt::Font(20, egt::Font::Weight::bold).id());
+
+    egt::Button button1("one");
+    egt::Button button2("two");
+    egt::Button button3("three");
+
+    egt::detail::text_size_cache_capacity(2);
+    egt::detail::text_size_cache_clear();
+
+    const auto size = button1.min_size_hint();
+    EXPECT_EQ(button1.min_size_hint(), size);
+
+    auto stats = egt::detail::text_size_cache_stats();
+    EXPECT_EQ(stats.misses, 1U);
+    EXPECT_EQ(stats.hits, 1U);
+    EXPECT_EQ(stats.size, 1U);
+
+    EXPECT_NE(button2.min_size_hint(), button3.min_size_hint());
+
+    stats = egt::detail::text_size_cache_stats();
+    EXPECT_EQ(stats.size, 2U);
+    EXPECT_EQ(stats.evictions, 1U);
+
+    EXPECT_EQ(button1.min_size_hint(), size);
+    EXPECT_EQ(egt::detail::text_size_cache_stats().misses, 4U);
+
+    egt::detail::text_size_cache_capacity(256);
+}
+
+TEST(TextWidgetTest, ScaleFont)
+{
+    egt::Application app;
+
+    egt::Surface surface(egt::Size(1, 1), egt::PixelFormat::argb8888);
+    egt::Painter painter(surface);
+    auto fits = [&painter](const egt::Size & target, const std::string & text, const egt::Font & font)
+    {
+        painter.set(font);
+        const auto textext = painter.extents(text);
+        return textext.width - textext.x_bearing < target.width() &&
+               textext.height - textext.y_bearing < target.height();
+    };
+
+    const egt::Font font(120);
+    for (const auto& text : {"1", "42", "1234.5", "Temperature"})
+    {
+        for (const auto& target : {egt::Size(200, 100), egt::Size(60, 30), egt::Size(20, 20)})
+        {
+            // the slow way
+            auto expected = font;
+            while (!fits(target, text, expected) && expected.size() - 1 >= 1)
+                expected.size(expected.size() - 1);
+            if (!fits(target, text, expected))
+                expected = font;
+
+            // twice, the second one uses the remembered size
+            EXPECT_FLOAT_EQ(egt::TextWidget::scale_font(target, text, font).size(), expected.size());
+            EXPECT_FLOAT_EQ(egt::TextWidget::scale_font(target, text, font).size(), expected.size());
+        }
+    }
+
+    egt::Label label("1234.5", egt::Rect(0, 0, 60, 30));
+    label.font(font);
+    EXPECT_FLOAT_EQ(label.text_font().size(), font.size());
+    label.auto_fit(true);
+    EXPECT_LT(label.text_font().size(), font.size());
+    EXPECT_TRUE(fits(label.content_area().size(), label.text(), label.text_font()));
+}
+
+TEST(TextWidgetTest, MinSizeHint)
+{
+    egt::Application app;
+
+    egt::Label label("42");
+    const auto hint = label.min_size_hint();
+    EXPECT_EQ(label.min_size_hint(), hint);
+
+    // the size kept for the text follows its changes and font changes
+    label.text("Temperature");
+    EXPECT_GT(label.min_size_hint().width(), hint.width());
+
+    label.text("42");
+    EXPECT_EQ(label.min_size_hint(), hint);
+
+    label.font(egt::Font(label.font().size() * 2));
+    EXPECT_GT(label.min_size_hint().height(), hint.height());
+}
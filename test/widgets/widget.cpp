@@ -0,0 +1,27 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <egt/ui>
+#include <gtest/gtest.h>
+
+TEST(WidgetTest, DefaultName)
+{
+    egt::Application app;
+
+    // the default name is the one of the most derived widget
+    egt::Button button("OK");
+    EXPECT_EQ(button.name(), "Button" + std::to_string(button.widgetid()));
+
+    egt::ImageButton image_button(egt::Image(), "OK");
+    EXPECT_EQ(image_button.name(), "ImageButton" + std::to_string(image_button.widgetid()));
+
+    egt::Label label("42");
+    label.name("temperature");
+    EXPECT_EQ(label.name(), "temperature");
+
+    // clearing the name goes back to the default one
+    label.name("");
+    EXPECT_EQ(label.name(), "Label" + std::to_string(label.widgetid()));
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <cairo.h>
+#include <cxxopts.hpp>
+#include <erawimage.h>
+#include <erawtiled.h>
+#include <iostream>
+#include <memory>
+
+using egt::detail::ErawTiledImage;
+
+static bool parse_format(const std::string& name, ErawTiledImage::Format& format)
+{
+    if (name == "argb8888")
+        format = ErawTiledImage::Format::argb8888;
+    else if (name == "rgb565")
+        format = ErawTiledImage::Format::rgb565;
+    else
+        return false;
+    return true;
+}
+
+static bool parse_compression(const std::string& name, ErawTiledImage::Compression& compression)
+{
+    if (name == "none")
+        compression = ErawTiledImage::Compression::none;
+#ifdef HAVE_ZLIB
+    else if (name == "zlib")
+        compression = ErawTiledImage::Compression::zlib;
+#endif
+#ifdef HAVE_LZ4
+    else if (name == "lz4")
+        compression = ErawTiledImage::Compression::lz4;
+#endif
+    else
+        return false;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    cxxopts::Options options("eraw-convert", "eraw image format converter");
+    options.add_options()
+    ("h,help", "help")
+    ("i,input-format", "input format (png, eraw)",
+     cxxopts::value<std::string>()->default_value("png"))
+    ("o,output-format", "output format (eraw, eraw2, png, raw)",
+     cxxopts::value<std::string>()->default_value("eraw"))
+    ("t,tile-size", "eraw2 tile size in pixels",
+     cxxopts::value<uint32_t>()->default_value("64"))
+    ("p,pixel-format", "eraw2 pixel format (argb8888, rgb565)",
+     cxxopts::value<std::string>()->default_value("argb8888"))
+    ("c,compression", "eraw2 tile compression (none, zlib, lz4)",
+     cxxopts::value<std::string>()->default_value("none"))
+    ("positional", "SOURCE DEST", cxxopts::value<std::vector<std::string>>())
+    ;
+    options.positional_help("SOURCE DEST");
+
+    options.parse_positional({"positional"});
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help"))
+    {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    if (result.count("positional") != 2)
+    {
+        std::cerr << options.help() << std::endl;
+        return 1;
+    }
+
+    auto& positional = result["positional"].as<std::vector<std::string>>();
+
+    std::string in = positional[0];
+    std::string out = positional[1];
+
+    std::shared_ptr<cairo_surface_t> surface;
+    egt::Surface eraw;
+
+    if (result["input-format"].as<std::string>() == "png")
+    {
+        surface =
+            std::shared_ptr<cairo_surface_t>(cairo_image_surface_create_from_png(in.c_str()),
+                                             cairo_surface_destroy);
+    }
+    else if (result["input-format"].as<std::string>() == "eraw")
+    {
+        ErawTiledImage tiled;
+        if (tiled.open(in))
+            eraw = tiled.decode();
+        else
+            eraw = egt::detail::ErawImage::load(in);
+
+        if (eraw.format() != egt::PixelFormat::argb8888)
+        {
+            std::cerr << "error: only argb8888 eraw input is supported" << std::endl;
+            return 1;
+        }
+
+        surface =
+            std::shared_ptr<cairo_surface_t>(cairo_image_surface_create_for_data(
+                                                 static_cast<unsigned char*>(eraw.data()),
+                                                 CAIRO_FORMAT_ARGB32,
+                                                 eraw.width(), eraw.height(), eraw.stride()),
+                                             cairo_surface_destroy);
+    }
+    else
+    {
+        std::cerr << "error: unknown input-format " <<
+                  result["input-format"].as<std::string>() << std::endl;
+        return 1;
+    }
+
+    if (!surface ||
+        cairo_surface_status(surface.get()) != CAIRO_STATUS_SUCCESS)
+    {
+        std::cerr << "error: unable to open input " << in << std::endl;
+        return 1;
+    }
+
+    const auto data = cairo_image_surface_get_data(surface.get());
+    const auto width = cairo_image_surface_get_width(surface.get());
+    const auto height = cairo_image_surface_get_height(surface.get());
+    const auto stride = cairo_image_surface_get_stride(surface.get());
+
+    if (result["output-format"].as<std::string>() == "eraw")
+    {
+        egt::detail::ErawImage e;
+        e.save(out, data, width, height);
+    }
+    else if (result["output-format"].as<std::string>() == "eraw2")
+    {
+        auto format = ErawTiledImage::Format::argb8888;
+        if (!parse_format(result["pixel-format"].as<std::string>(), format))
+        {
+            std::cerr << "error: unknown pixel-format " <<
+                      result["pixel-format"].as<std::string>() << std::endl;
+            return 1;
+        }
+
+        auto compression = ErawTiledImage::Compression::none;
+        if (!parse_compression(result["compression"].as<std::string>(), compression))
+        {
+            std::cerr << "error: unsupported compression " <<
+                      result["compression"].as<std::string>() << std::endl;
+            return 1;
+        }
+
+        // the tiled writer appends, so start from an empty file
+        std::ofstream(out, std::ios_base::binary | std::ios_base::trunc);
+
+        if (!ErawTiledImage::save(out, data, width, height, stride, format,
+                                  compression, result["tile-size"].as<uint32_t>()))
+        {
+            std::cerr << "error: unable to write to file file " << out << std::endl;
+            return 1;
+        }
+    }
+    else if (result["output-format"].as<std::string>() == "raw")
+    {
+        auto size = width * height  * sizeof(uint32_t);
+        std::ofstream o(out, std::ios_base::binary);
+        if (!o.is_open())
+        {
+            std::cerr << "error: unable to write to file file " << out << std::endl;
+            return 1;
+        }
+
+        o.write(reinterpret_cast<const char*>(data), size);
+        o.close();
+    }
+    else if (result["output-format"].as<std::string>() == "png")
+    {
+        if (cairo_surface_write_to_png(surface.get(), out.c_str()) != CAIRO_STATUS_SUCCESS)
+        {
+            std::cerr << "error: unable to write to file file " << out << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::cerr << "error: unknown output-format " <<
+                  result["output-format"].as<std::string>() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -7,12 +7,17 @@
 
 #include <egt/ui>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <cmath>
 #include <cstring>
 #include <cxxopts.hpp>
 #include <rapidxml.hpp>
 #include <rapidxml_utils.hpp>
+#include <bitmapfont.h>
+#include <cairoabstraction.h>
 #include <erawimage.h>
+#include <erawtiled.h>
 
 
 using namespace std;
@@ -36,6 +41,8 @@ private:
 };
 
 static void SerializePNG(const char* png_src);
+static int SerializeFont(const string& font_src, const vector<int>& sizes,
+                         const vector<uint32_t>& code_points, uint32_t bpp);
 static void InitErawHFile(void);
 static void EndErawHFile(void);
 static void WriteTableIndexFile(void);
@@ -59,6 +66,28 @@ typedef struct
 #define ERAW_NAME "eraw.bin"
 unsigned int offset = 0;
 unsigned int table_index = 0;
+bool tiled = false;
+detail::ErawTiledImage::Compression compression = detail::ErawTiledImage::Compression::none;
+
+static unsigned int SaveEraw(unsigned char* data, int x, int y,
+                             int width, int height, int stride)
+{
+    unsigned int len = 0;
+
+    if (tiled)
+    {
+        len = detail::ErawTiledImage::save(ERAW_NAME, data, x, y, width, height,
+                                           stride, detail::ErawTiledImage::Format::argb8888,
+                                           compression);
+    }
+    else
+    {
+        detail::ErawImage e;
+        e.save(ERAW_NAME, data, x, y, width, height, &len);
+    }
+
+    return len;
+}
 
 void SVG_CVT::saveErawById(const string& filename, const string& id)
 {
@@ -66,11 +95,11 @@ void SVG_CVT::saveErawById(const string& filename, const string& id)
     auto box = m_svg.id_box(id);
     auto layer = make_shared<Image>(m_svg.render(id, box));
 
-    detail::ErawImage e;
     const auto data = cairo_image_surface_get_data(layer->surface().get());
     const auto width = cairo_image_surface_get_width(layer->surface().get());
     const auto height = cairo_image_surface_get_height(layer->surface().get());
-    e.save(ERAW_NAME, data, box.x(), box.y(), width, height, &len);
+    const auto stride = cairo_image_surface_get_stride(layer->surface().get());
+    len = SaveEraw(data, box.x(), box.y(), width, height, stride);
 
     ofstream erawmap("eraw.h", ios_base::app);
     if (!erawmap.is_open())
@@ -202,14 +231,14 @@ static void SerializePNG(const char* png_src)
     unsigned int len = 0;
 
     shared_cairo_surface_t surface;
-    detail::ErawImage e;
     surface =
         shared_cairo_surface_t(cairo_image_surface_create_from_png(png_src),
                                cairo_surface_destroy);
     const auto data = cairo_image_surface_get_data(surface.get());
     const auto width = cairo_image_surface_get_width(surface.get());
     const auto height = cairo_image_surface_get_height(surface.get());
-    e.save(ERAW_NAME, data, 0, 0, width, height, &len);
+    const auto stride = cairo_image_surface_get_stride(surface.get());
+    len = SaveEraw(data, 0, 0, width, height, stride);
 
     string s(png_src);
     string png = s.substr(0, s.length() - 4);
@@ -236,6 +265,159 @@ static void SerializePNG(const char* png_src)
     WriteTableIndexFile();
 }
 
+static string Utf8Encode(uint32_t cp)
+{
+    string out;
+    if (cp < 0x80)
+        out += static_cast<char>(cp);
+    else if (cp < 0x800)
+    {
+        out += static_cast<char>(0xc0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    else if (cp < 0x10000)
+    {
+        out += static_cast<char>(0xe0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    else
+    {
+        out += static_cast<char>(0xf0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    return out;
+}
+
+/*
+ * Parse code points like "0x20-0x7e,0xb0".
+ */
+static bool ParseCodePoints(const string& ranges, vector<uint32_t>& code_points)
+{
+    stringstream ss(ranges);
+    string range;
+    while (getline(ss, range, ','))
+    {
+        char* end = nullptr;
+        const auto first = strtoul(range.c_str(), &end, 0);
+        auto last = first;
+        if (*end == '-')
+            last = strtoul(end + 1, &end, 0);
+        if (*end || last < first || last > 0x10ffff)
+            return false;
+
+        for (auto cp = first; cp <= last; ++cp)
+            code_points.push_back(cp);
+    }
+
+    return !code_points.empty();
+}
+
+/*
+ * Render the glyphs of a font file at each size to a bitmap font, named after
+ * the font file and the size.
+ */
+static int SerializeFont(const string& font_src, const vector<int>& sizes,
+                         const vector<uint32_t>& code_points, uint32_t bpp)
+{
+    string name = font_src.substr(font_src.find_last_of('/') + 1);
+    name = name.substr(0, name.find_last_of('.'));
+
+    for (auto size : sizes)
+    {
+        Font font("file:" + font_src, size, Font::Weight::normal, Font::Slant::normal);
+
+        Surface surface(Size(1, 1), PixelFormat::argb8888);
+        Painter painter(surface);
+        painter.set(font);
+        auto scaled_font = cairo_get_scaled_font(painter.context().get());
+
+        cairo_font_extents_t fe;
+        cairo_scaled_font_extents(scaled_font, &fe);
+
+        detail::BitmapFont::Metrics metrics;
+        metrics.size = detail::BitmapFont::to_fixed(size);
+        metrics.ascent = detail::BitmapFont::to_fixed(fe.ascent);
+        metrics.descent = detail::BitmapFont::to_fixed(fe.descent);
+        metrics.height = detail::BitmapFont::to_fixed(fe.height);
+
+        vector<detail::BitmapFont::SourceGlyph> glyphs;
+        for (auto cp : code_points)
+        {
+            const auto text = Utf8Encode(cp);
+            cairo_glyph_t* buffer = nullptr;
+            int count = 0;
+            if (cairo_scaled_font_text_to_glyphs(scaled_font, 0, 0,
+                                                 text.data(), text.size(),
+                                                 &buffer, &count,
+                                                 nullptr, nullptr, nullptr) != CAIRO_STATUS_SUCCESS ||
+                count != 1)
+            {
+                cairo_glyph_free(buffer);
+                continue;
+            }
+
+            cairo_glyph_t glyph = buffer[0];
+            cairo_glyph_free(buffer);
+
+            // skip code points the font has no glyph for, except the space
+            if (!glyph.index && cp != ' ')
+                continue;
+
+            cairo_text_extents_t te;
+            cairo_scaled_font_glyph_extents(scaled_font, &glyph, 1, &te);
+
+            detail::BitmapFont::SourceGlyph source;
+            source.glyph.code_point = cp;
+            source.glyph.advance = detail::BitmapFont::to_fixed(te.x_advance);
+
+            if (te.width > 0 && te.height > 0)
+            {
+                // one pixel of margin for antialiasing
+                const auto left = static_cast<int>(floor(te.x_bearing)) - 1;
+                const auto top = static_cast<int>(floor(te.y_bearing)) - 1;
+                const auto width = static_cast<int>(ceil(te.x_bearing + te.width)) - left + 1;
+                const auto height = static_cast<int>(ceil(te.y_bearing + te.height)) - top + 1;
+
+                unique_cairo_surface_t mask(cairo_image_surface_create(CAIRO_FORMAT_A8, width, height));
+                unique_cairo_t cr(cairo_create(mask.get()));
+                cairo_set_scaled_font(cr.get(), scaled_font);
+                glyph.x = -left;
+                glyph.y = -top;
+                cairo_show_glyphs(cr.get(), &glyph, 1);
+                cr.reset();
+                cairo_surface_flush(mask.get());
+
+                source.glyph.left = left;
+                source.glyph.top = top;
+                source.glyph.width = width;
+                source.glyph.height = height;
+                source.coverage.resize(width * height);
+
+                const auto data = cairo_image_surface_get_data(mask.get());
+                const auto stride = cairo_image_surface_get_stride(mask.get());
+                for (int y = 0; y < height; ++y)
+                    memcpy(source.coverage.data() + y * width, data + y * stride, width);
+            }
+
+            glyphs.push_back(move(source));
+        }
+
+        const auto filename = name + "-" + to_string(size) + ".ebf";
+        if (!detail::BitmapFont::save(filename, metrics, move(glyphs), bpp))
+        {
+            cerr << "unable to write " << filename << endl;
+            return 1;
+        }
+
+        cout << filename << endl;
+    }
+
+    return 0;
+}
+
 static void WriteTableIndexFile(void)
 {
     ofstream indexfile("index.txt");
@@ -309,8 +491,17 @@ int main(int argc, char** argv)
     ("h,help", "help")
     ("s,starttoken", "start token of eraw.h")
     ("e,endtoken", "end token of eraw.h")
-    ("i,input-format", "input format (svg, png)",
+    ("i,input-format", "input format (svg, png, font)",
      cxxopts::value<string>()->default_value("svg"))
+    ("t,tiled", "write tiled eraw v2 images")
+    ("c,compression", "tile compression of eraw v2 images (none, zlib, lz4)",
+     cxxopts::value<string>()->default_value("none"))
+    ("f,font-sizes", "pixel sizes of bitmap fonts",
+     cxxopts::value<vector<int>>()->default_value("16"))
+    ("b,font-bpp", "bits per pixel of bitmap fonts (4, 8)",
+     cxxopts::value<uint32_t>()->default_value("8"))
+    ("r,font-chars", "code points of bitmap fonts",
+     cxxopts::value<string>()->default_value("0x20-0x7e,0xa0-0xff"))
     ("positional", "SOURCE", cxxopts::value<vector<string>>())
     ;
     options.positional_help("SOURCE");
@@ -350,6 +541,38 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (result["input-format"].as<string>() == "font")
+    {
+        vector<uint32_t> code_points;
+        if (!ParseCodePoints(result["font-chars"].as<string>(), code_points))
+        {
+            cerr << "invalid code points " << result["font-chars"].as<string>() << endl;
+            return 1;
+        }
+
+        const auto bpp = result["font-bpp"].as<uint32_t>();
+        if (bpp != 4 && bpp != 8)
+        {
+            cerr << "invalid bits per pixel " << bpp << endl;
+            return 1;
+        }
+
+        return SerializeFont(result["positional"].as<vector<string>>()[0],
+                             result["font-sizes"].as<vector<int>>(),
+                             code_points, bpp);
+    }
+
+    tiled = result.count("tiled");
+    if (result["compression"].as<string>() == "zlib")
+        compression = detail::ErawTiledImage::Compression::zlib;
+    else if (result["compression"].as<string>() == "lz4")
+        compression = detail::ErawTiledImage::Compression::lz4;
+    else if (result["compression"].as<string>() != "none")
+    {
+        cerr << "unknown compression " << result["compression"].as<string>() << endl;
+        return 1;
+    }
+
     ReadTableIndexFile();
 
     auto& positional = result["positional"].as<vector<string>>();
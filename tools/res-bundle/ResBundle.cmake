@@ -0,0 +1,60 @@
+#
+# Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# egt_add_resource_bundle(<target> OUTPUT <file> FILES <file>...
+#                         [COMPRESS] [ALIGNMENT <bytes>])
+#
+# Add a target that packs the given files into the resource bundle <file>
+# with the res-bundle tool. The bundle is then registered at runtime with
+# egt::ResourceManager::add_bundle() or embedded with EGT_EMBED_BUNDLE().
+#
+# The tool is built from source. When cross compiling, set
+# RES_BUNDLE_EXECUTABLE to a res-bundle binary built for the build machine.
+#
+
+set(_RES_BUNDLE_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+function(egt_add_resource_bundle target)
+    cmake_parse_arguments(ARG "COMPRESS" "OUTPUT;ALIGNMENT" "FILES" ${ARGN})
+    if(NOT ARG_OUTPUT OR NOT ARG_FILES)
+        message(FATAL_ERROR "egt_add_resource_bundle: OUTPUT and FILES are required")
+    endif()
+
+    if(RES_BUNDLE_EXECUTABLE)
+        set(tool ${RES_BUNDLE_EXECUTABLE})
+        set(tool_target)
+    elseif(CMAKE_CROSSCOMPILING)
+        message(FATAL_ERROR "egt_add_resource_bundle: set RES_BUNDLE_EXECUTABLE when cross compiling")
+    else()
+        if(NOT TARGET res-bundle)
+            add_executable(res-bundle ${_RES_BUNDLE_DIR}/res-bundle.cpp)
+            target_include_directories(res-bundle PRIVATE
+                ${_RES_BUNDLE_DIR}/../../src/detail
+                ${_RES_BUNDLE_DIR}/../../external/cxxopts/include)
+            find_package(ZLIB)
+            if(ZLIB_FOUND)
+                target_compile_definitions(res-bundle PRIVATE HAVE_ZLIB)
+                target_link_libraries(res-bundle PRIVATE ZLIB::ZLIB)
+            endif()
+        endif()
+        set(tool $<TARGET_FILE:res-bundle>)
+        set(tool_target res-bundle)
+    endif()
+
+    set(args)
+    if(ARG_COMPRESS)
+        list(APPEND args -c)
+    endif()
+    if(ARG_ALIGNMENT)
+        list(APPEND args -a ${ARG_ALIGNMENT})
+    endif()
+
+    add_custom_command(
+        OUTPUT ${ARG_OUTPUT}
+        COMMAND ${tool} ${args} -o ${ARG_OUTPUT} ${ARG_FILES}
+        DEPENDS ${ARG_FILES} ${tool_target}
+        VERBATIM)
+    add_custom_target(${target} ALL DEPENDS ${ARG_OUTPUT})
+endfunction()
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2018 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include <cxxopts.hpp>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <resourcebundle.h>
+#include <set>
+
+using egt::detail::ResourceBundle;
+
+/*
+ * Same naming as mresg: the file name with periods replaced by underscores.
+ */
+static std::string resource_name(const std::string& path)
+{
+    auto name = path.substr(path.find_last_of('/') + 1);
+    std::replace(name.begin(), name.end(), '.', '_');
+    return name;
+}
+
+int main(int argc, char** argv)
+{
+    cxxopts::Options options("res-bundle", "EGT resource bundle generator");
+    options.add_options()
+    ("h,help", "help")
+    ("o,output", "output bundle file", cxxopts::value<std::string>())
+    ("a,alignment", "alignment of uncompressed resources in bytes",
+     cxxopts::value<uint32_t>()->default_value(std::to_string(ResourceBundle::default_alignment())))
+#ifdef HAVE_ZLIB
+    ("c,compress", "compress resources with zlib when it makes them smaller")
+#endif
+    ("positional", "INPUT...", cxxopts::value<std::vector<std::string>>())
+    ;
+    options.positional_help("INPUT...");
+
+    options.parse_positional({"positional"});
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help"))
+    {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    if (!result.count("output") || !result.count("positional"))
+    {
+        std::cerr << options.help() << std::endl;
+        return 1;
+    }
+
+    const auto alignment = result["alignment"].as<uint32_t>();
+    if (!alignment || (alignment & (alignment - 1)))
+    {
+        std::cerr << "error: alignment must be a power of two" << std::endl;
+        return 1;
+    }
+
+    bool compress = false;
+#ifdef HAVE_ZLIB
+    compress = result.count("compress");
+#endif
+
+    std::vector<ResourceBundle::Input> inputs;
+    std::set<std::string> names;
+    for (const auto& path : result["positional"].as<std::vector<std::string>>())
+    {
+        std::ifstream in(path, std::ios_base::binary);
+        if (!in.is_open())
+        {
+            std::cerr << "error: unable to open input " << path << std::endl;
+            return 1;
+        }
+
+        ResourceBundle::Input input;
+        input.name = resource_name(path);
+        input.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        input.compress = compress;
+
+        if (!names.insert(input.name).second)
+        {
+            std::cerr << "error: duplicate resource name " << input.name << std::endl;
+            return 1;
+        }
+
+        inputs.emplace_back(std::move(input));
+    }
+
+    const auto bundle = ResourceBundle::build(inputs, alignment);
+
+    const auto out = result["output"].as<std::string>();
+    std::ofstream o(out, std::ios_base::binary | std::ios_base::trunc);
+    if (!o.is_open())
+    {
+        std::cerr << "error: unable to write to file " << out << std::endl;
+        return 1;
+    }
+
+    o.write(reinterpret_cast<const char*>(bundle.data()), bundle.size());
+    if (!o)
+    {
+        std::cerr << "error: unable to write to file " << out << std::endl;
+        return 1;
+    }
+
+    return 0;
+}